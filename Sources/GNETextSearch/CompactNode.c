@@ -0,0 +1,486 @@
+//
+//  CompactNode.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include "CompactNode.h"
+#include "StringBuffer.h"
+#include "GNETextSearchPrivate.h"
+#include <string.h>
+
+// ------------------------------------------------------------------------------------------
+
+typedef struct _tsearch_compact_search_item
+{
+    uint32_t index;
+    size_t value; // The match index for partial and subsequence searches, otherwise the depth.
+    bool isWord;  // Set for items that emit the node's word while copying the tree's contents.
+} _tsearch_compact_search_item;
+
+typedef struct _tsearch_compact_search_stack
+{
+    _tsearch_compact_search_item *items;
+    size_t count;
+    size_t capacity;
+} _tsearch_compact_search_stack;
+
+// ------------------------------------------------------------------------------------------
+
+static bool _tsearch_compact_is_valid_index(const _tsearch_compact_view *view, const uint32_t index);
+static uint32_t _tsearch_compact_get_child(const _tsearch_compact_view *view, const uint32_t parent,
+                                           const uint32_t child);
+static bool _tsearch_compact_has_postings(const _tsearch_compact_view *view, const uint32_t index);
+static result _tsearch_compact_union_postings(const _tsearch_compact_view *view, const uint32_t index,
+                                              tsearch_countedset_ptr results);
+static result _tsearch_compact_copy_words_from_node(const _tsearch_compact_view *view, const uint32_t index,
+                                                    tsearch_countedset_ptr results);
+static tsearch_countedset_ptr _tsearch_compact_nonempty_results(tsearch_countedset_ptr results);
+static result _tsearch_compact_stack_push(_tsearch_compact_search_stack *stack, const uint32_t index,
+                                          const size_t value, const bool isWord);
+static result _tsearch_compact_stack_push_child(_tsearch_compact_search_stack *stack,
+                                                const _tsearch_compact_view *view, const uint32_t parent,
+                                                const uint32_t child, const size_t value);
+static result _tsearch_compact_word_set_char(char **word, size_t *capacity, const size_t index,
+                                             const char character);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Search
+// ------------------------------------------------------------------------------------------
+uint32_t _tsearch_compact_search(const _tsearch_compact_view *view, const char *target)
+{
+    if (view == NULL || view->nodes == NULL || target == NULL || target[0] == '\0') {
+        return TSEARCH_COMPACT_NONE;
+    }
+
+    const _tsearch_compact_node *nodes = view->nodes;
+    const char *cursor = target;
+    uint32_t index = (view->nodeCount > 0) ? 0 : TSEARCH_COMPACT_NONE;
+    while (_tsearch_compact_is_valid_index(view, index)) {
+        const _tsearch_compact_node *node = &(nodes[index]);
+        char targetCharacter = *cursor;
+
+        if (targetCharacter < node->character) {
+            index = _tsearch_compact_get_child(view, index, node->lower);
+        } else if (targetCharacter > node->character) {
+            index = _tsearch_compact_get_child(view, index, node->higher);
+        } else {
+            if (cursor[1] == '\0') { return index; }
+            cursor += 1;
+            index = _tsearch_compact_get_child(view, index, node->same);
+        }
+    }
+
+    return TSEARCH_COMPACT_NONE;
+}
+
+
+tsearch_countedset_ptr _tsearch_compact_copy_search_results(const _tsearch_compact_view *view, const char *target)
+{
+    uint32_t index = _tsearch_compact_search(view, target);
+    if (_tsearch_compact_has_postings(view, index) == false) { return NULL; }
+
+    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
+    if (resultsPtr == NULL) { return NULL; }
+
+    if (_tsearch_compact_union_postings(view, index, resultsPtr) == failure) {
+        tsearch_countedset_free(resultsPtr);
+        return NULL;
+    }
+
+    return _tsearch_compact_nonempty_results(resultsPtr);
+}
+
+
+tsearch_countedset_ptr _tsearch_compact_copy_prefix_search_results(const _tsearch_compact_view *view,
+                                                                   const char *prefix)
+{
+    uint32_t index = _tsearch_compact_search(view, prefix);
+    if (index == TSEARCH_COMPACT_NONE) { return NULL; }
+
+    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
+    if (resultsPtr == NULL) { return NULL; }
+
+    uint32_t same = _tsearch_compact_get_child(view, index, view->nodes[index].same);
+    if (_tsearch_compact_union_postings(view, index, resultsPtr) == failure ||
+        _tsearch_compact_copy_words_from_node(view, same, resultsPtr) == failure) {
+        tsearch_countedset_free(resultsPtr);
+        return NULL;
+    }
+
+    return _tsearch_compact_nonempty_results(resultsPtr);
+}
+
+
+tsearch_countedset_ptr _tsearch_compact_copy_partial_search_results(const _tsearch_compact_view *view,
+                                                                    const char *target,
+                                                                    const size_t length)
+{
+    if (view == NULL || view->nodeCount == 0 || target == NULL || length == 0) { return NULL; }
+
+    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
+    if (resultsPtr == NULL) { return NULL; }
+
+    size_t *prefixTable = NULL;
+    if (_tsearch_build_prefix_table(target, length, &prefixTable) == failure) {
+        tsearch_countedset_free(resultsPtr);
+        return NULL;
+    }
+
+    _tsearch_compact_search_stack stack = {NULL, 0, 0};
+    result ret = _tsearch_compact_stack_push(&stack, 0, 0, false);
+    while (ret == success && stack.count > 0) {
+        _tsearch_compact_search_item item = stack.items[--stack.count];
+        if (_tsearch_compact_is_valid_index(view, item.index) == false) { continue; }
+        const _tsearch_compact_node *node = &(view->nodes[item.index]);
+
+        size_t nextIndex = _tsearch_kmp_next_index(target, prefixTable, item.value, node->character);
+        bool shouldSearchSame = true;
+        if (nextIndex == length) {
+            if (_tsearch_compact_union_postings(view, item.index, resultsPtr) == failure ||
+                _tsearch_compact_copy_words_from_node(view, _tsearch_compact_get_child(view, item.index, node->same),
+                                                      resultsPtr) == failure) {
+                ret = failure;
+                break;
+            }
+
+            nextIndex = prefixTable[length - 1];
+            shouldSearchSame = false;
+        }
+
+        if (_tsearch_compact_stack_push_child(&stack, view, item.index, node->higher, item.value) == failure ||
+            _tsearch_compact_stack_push_child(&stack, view, item.index, node->lower, item.value) == failure ||
+            (shouldSearchSame == true &&
+             _tsearch_compact_stack_push_child(&stack, view, item.index, node->same, nextIndex) == failure)) {
+            ret = failure;
+        }
+    }
+
+    free(stack.items);
+    free(prefixTable);
+
+    if (ret == failure) {
+        tsearch_countedset_free(resultsPtr);
+        return NULL;
+    }
+
+    return _tsearch_compact_nonempty_results(resultsPtr);
+}
+
+
+tsearch_countedset_ptr _tsearch_compact_copy_subsequence_search_results(const _tsearch_compact_view *view,
+                                                                        const char *target,
+                                                                        const size_t length)
+{
+    if (view == NULL || view->nodeCount == 0 || target == NULL || length == 0) { return NULL; }
+
+    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
+    if (resultsPtr == NULL) { return NULL; }
+
+    _tsearch_compact_search_stack stack = {NULL, 0, 0};
+    result ret = _tsearch_compact_stack_push(&stack, 0, 0, false);
+    while (ret == success && stack.count > 0) {
+        _tsearch_compact_search_item item = stack.items[--stack.count];
+        if (_tsearch_compact_is_valid_index(view, item.index) == false) { continue; }
+        const _tsearch_compact_node *node = &(view->nodes[item.index]);
+
+        size_t nextIndex = item.value;
+        if (nextIndex < length && node->character == target[nextIndex]) {
+            nextIndex += 1;
+        }
+
+        if (nextIndex == length) {
+            if (_tsearch_compact_union_postings(view, item.index, resultsPtr) == failure ||
+                _tsearch_compact_copy_words_from_node(view, _tsearch_compact_get_child(view, item.index, node->same),
+                                                      resultsPtr) == failure) {
+                ret = failure;
+                break;
+            }
+        } else if (_tsearch_compact_stack_push_child(&stack, view, item.index, node->same, nextIndex) == failure) {
+            ret = failure;
+            break;
+        }
+
+        if (_tsearch_compact_stack_push_child(&stack, view, item.index, node->higher, item.value) == failure ||
+            _tsearch_compact_stack_push_child(&stack, view, item.index, node->lower, item.value) == failure) {
+            ret = failure;
+        }
+    }
+
+    free(stack.items);
+
+    if (ret == failure) {
+        tsearch_countedset_free(resultsPtr);
+        return NULL;
+    }
+
+    return _tsearch_compact_nonempty_results(resultsPtr);
+}
+
+
+tsearch_countedset_ptr _tsearch_compact_copy_suffix_search_results(const _tsearch_compact_view *view,
+                                                                   const char *suffix,
+                                                                   const size_t length)
+{
+    if (view == NULL || view->nodeCount == 0 || suffix == NULL || length == 0) { return NULL; }
+
+    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
+    if (resultsPtr == NULL) { return NULL; }
+
+    // Compact nodes don't point to their parents, so the words are rebuilt on the way down
+    // instead of being read back up from the end of each word.
+    char *word = NULL;
+    size_t wordCapacity = 0;
+
+    _tsearch_compact_search_stack stack = {NULL, 0, 0};
+    result ret = _tsearch_compact_stack_push(&stack, 0, 0, false);
+    while (ret == success && stack.count > 0) {
+        _tsearch_compact_search_item item = stack.items[--stack.count];
+        if (_tsearch_compact_is_valid_index(view, item.index) == false) { continue; }
+        const _tsearch_compact_node *node = &(view->nodes[item.index]);
+        size_t depth = item.value;
+
+        if (_tsearch_compact_word_set_char(&word, &wordCapacity, depth, node->character) == failure) {
+            ret = failure;
+            break;
+        }
+
+        size_t wordLength = depth + 1;
+        if (wordLength >= length &&
+            node->character == suffix[length - 1] &&
+            _tsearch_compact_has_postings(view, item.index) == true &&
+            memcmp(word + wordLength - length, suffix, length) == 0 &&
+            _tsearch_compact_union_postings(view, item.index, resultsPtr) == failure) {
+            ret = failure;
+            break;
+        }
+
+        if (_tsearch_compact_stack_push_child(&stack, view, item.index, node->higher, depth) == failure ||
+            _tsearch_compact_stack_push_child(&stack, view, item.index, node->lower, depth) == failure ||
+            _tsearch_compact_stack_push_child(&stack, view, item.index, node->same, wordLength) == failure) {
+            ret = failure;
+        }
+    }
+
+    free(stack.items);
+    free(word);
+
+    if (ret == failure) {
+        tsearch_countedset_free(resultsPtr);
+        return NULL;
+    }
+
+    return _tsearch_compact_nonempty_results(resultsPtr);
+}
+
+
+result _tsearch_compact_copy_contents(const _tsearch_compact_view *view, char **outResults, size_t *outLength)
+{
+    if (outResults == NULL || outLength == NULL) { return failure; }
+    *outResults = NULL;
+    *outLength = 0;
+
+    if (view == NULL) { return failure; }
+
+    tsearch_stringbuf_ptr contentsPtr = tsearch_stringbuf_init();
+    if (contentsPtr == NULL) { return failure; }
+
+    char *word = NULL;
+    size_t wordCapacity = 0;
+
+    // Each node is pushed twice: once to visit its lower branch and once to append its word
+    // before visiting its same and higher branches. That keeps the words in sorted order.
+    _tsearch_compact_search_stack stack = {NULL, 0, 0};
+    result ret = (view->nodeCount > 0) ? _tsearch_compact_stack_push(&stack, 0, 0, false) : success;
+    while (ret == success && stack.count > 0) {
+        _tsearch_compact_search_item item = stack.items[--stack.count];
+        if (_tsearch_compact_is_valid_index(view, item.index) == false) { continue; }
+        const _tsearch_compact_node *node = &(view->nodes[item.index]);
+        size_t depth = item.value;
+
+        if (item.isWord == false) {
+            if (_tsearch_compact_stack_push_child(&stack, view, item.index, node->higher, depth) == failure ||
+                _tsearch_compact_stack_push_child(&stack, view, item.index, node->same, depth + 1) == failure ||
+                _tsearch_compact_stack_push(&stack, item.index, depth, true) == failure ||
+                _tsearch_compact_stack_push_child(&stack, view, item.index, node->lower, depth) == failure) {
+                ret = failure;
+            }
+            continue;
+        }
+
+        if (_tsearch_compact_word_set_char(&word, &wordCapacity, depth, node->character) == failure ||
+            _tsearch_compact_word_set_char(&word, &wordCapacity, depth + 1, '\n') == failure) {
+            ret = failure;
+            break;
+        }
+
+        if (_tsearch_compact_has_postings(view, item.index) == true &&
+            tsearch_stringbuf_append_cstring(contentsPtr, word, depth + 2) == failure) {
+            ret = failure;
+        }
+    }
+
+    free(stack.items);
+    free(word);
+
+    if (ret == success) {
+        *outResults = (char *)tsearch_stringbuf_copy_cstring(contentsPtr);
+        if (*outResults == NULL) {
+            ret = failure;
+        } else {
+            *outLength = tsearch_stringbuf_get_len(contentsPtr);
+        }
+    }
+
+    tsearch_stringbuf_free(contentsPtr);
+    return ret;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+static bool _tsearch_compact_is_valid_index(const _tsearch_compact_view *view, const uint32_t index)
+{
+    return (view != NULL && view->nodes != NULL && index != TSEARCH_COMPACT_NONE && index < view->nodeCount);
+}
+
+
+/// Returns the child's index, or TSEARCH_COMPACT_NONE if the link can't be followed. Every node comes
+/// before its children in the node array, because frozen trees are laid out in preorder and compact
+/// trees append new nodes. A link to the parent or an earlier node can only come from a corrupt
+/// file, and following it could make a search loop forever, so it's treated as missing.
+static uint32_t _tsearch_compact_get_child(const _tsearch_compact_view *view, const uint32_t parent,
+                                           const uint32_t child)
+{
+    if (_tsearch_compact_is_valid_index(view, child) == false || child <= parent) { return TSEARCH_COMPACT_NONE; }
+    return child;
+}
+
+
+static bool _tsearch_compact_has_postings(const _tsearch_compact_view *view, const uint32_t index)
+{
+    if (_tsearch_compact_is_valid_index(view, index) == false || view->hasPostings == NULL) { return false; }
+    uint32_t postingsID = view->nodes[index].postingsID;
+    if (postingsID == TSEARCH_COMPACT_NONE) { return false; }
+    return view->hasPostings(view->postings, postingsID);
+}
+
+
+static result _tsearch_compact_union_postings(const _tsearch_compact_view *view, const uint32_t index,
+                                              tsearch_countedset_ptr results)
+{
+    if (_tsearch_compact_has_postings(view, index) == false) { return success; }
+    if (view->unionPostings == NULL) { return failure; }
+    return view->unionPostings(view->postings, view->nodes[index].postingsID, results);
+}
+
+
+/// Adds the document IDs of every word in the subtree beginning at the specified index, including
+/// the words in the node's lower and higher branches.
+static result _tsearch_compact_copy_words_from_node(const _tsearch_compact_view *view, const uint32_t index,
+                                                    tsearch_countedset_ptr results)
+{
+    if (_tsearch_compact_is_valid_index(view, index) == false) { return success; }
+    if (results == NULL) { return failure; }
+
+    _tsearch_compact_search_stack stack = {NULL, 0, 0};
+    result ret = _tsearch_compact_stack_push(&stack, index, 0, false);
+    while (ret == success && stack.count > 0) {
+        uint32_t current = stack.items[--stack.count].index;
+        if (_tsearch_compact_is_valid_index(view, current) == false) { continue; }
+        const _tsearch_compact_node *node = &(view->nodes[current]);
+
+        if (_tsearch_compact_union_postings(view, current, results) == failure ||
+            _tsearch_compact_stack_push_child(&stack, view, current, node->higher, 0) == failure ||
+            _tsearch_compact_stack_push_child(&stack, view, current, node->same, 0) == failure ||
+            _tsearch_compact_stack_push_child(&stack, view, current, node->lower, 0) == failure) {
+            ret = failure;
+        }
+    }
+
+    free(stack.items);
+    return ret;
+}
+
+
+static tsearch_countedset_ptr _tsearch_compact_nonempty_results(tsearch_countedset_ptr results)
+{
+    if (tsearch_countedset_get_count(results) == 0) {
+        tsearch_countedset_free(results);
+        return NULL;
+    }
+    return results;
+}
+
+
+static result _tsearch_compact_stack_push(_tsearch_compact_search_stack *stack, const uint32_t index,
+                                          const size_t value, const bool isWord)
+{
+    if (stack == NULL) { return failure; }
+    if (index == TSEARCH_COMPACT_NONE) { return success; }
+
+    if (stack->count >= stack->capacity) {
+        size_t newCapacity = 0;
+        size_t byteLength = 0;
+
+        if (stack->capacity == 0) {
+            newCapacity = 64;
+            if (_tsearch_size_mul_overflows(newCapacity, sizeof(_tsearch_compact_search_item), &byteLength)) {
+                return failure;
+            }
+        } else {
+            newCapacity = stack->capacity;
+            if (_tsearch_next_buf_len(&newCapacity, sizeof(_tsearch_compact_search_item), &byteLength) == failure) {
+                return failure;
+            }
+        }
+
+        _tsearch_compact_search_item *newItems = realloc(stack->items, byteLength);
+        if (newItems == NULL) { return failure; }
+
+        stack->items = newItems;
+        stack->capacity = newCapacity;
+    }
+
+    stack->items[stack->count] = (_tsearch_compact_search_item){index, value, isWord};
+    stack->count += 1;
+    return success;
+}
+
+
+/// Pushes the child if its link can be followed. Children are never pushed to emit their words.
+static result _tsearch_compact_stack_push_child(_tsearch_compact_search_stack *stack,
+                                                const _tsearch_compact_view *view, const uint32_t parent,
+                                                const uint32_t child, const size_t value)
+{
+    return _tsearch_compact_stack_push(stack, _tsearch_compact_get_child(view, parent, child), value, false);
+}
+
+
+static result _tsearch_compact_word_set_char(char **word, size_t *capacity, const size_t index,
+                                             const char character)
+{
+    if (word == NULL || capacity == NULL) { return failure; }
+
+    if (index >= *capacity) {
+        size_t newCapacity = (*capacity == 0) ? 32 : *capacity;
+        size_t byteLength = newCapacity;
+        while (index >= newCapacity) {
+            if (_tsearch_next_buf_len(&newCapacity, sizeof(char), &byteLength) == failure) {
+                return failure;
+            }
+        }
+
+        char *newWord = realloc(*word, byteLength);
+        if (newWord == NULL) { return failure; }
+
+        *word = newWord;
+        *capacity = newCapacity;
+    }
+
+    (*word)[index] = character;
+    return success;
+}
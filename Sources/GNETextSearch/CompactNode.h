@@ -0,0 +1,69 @@
+//
+//  CompactNode.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_compactnode_h
+#define tsearch_compactnode_h
+
+#include <GNETextSearch/CountedSet.h>
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TSEARCH_COMPACT_NONE UINT32_MAX
+
+/// A ternary tree node that refers to its children by their 32-bit indices in a contiguous node
+/// array and to its document IDs by a 32-bit postings ID. Words ending at the node have a
+/// postings ID other than TSEARCH_COMPACT_NONE. The root is always the node at index 0.
+typedef struct _tsearch_compact_node
+{
+    uint32_t lower, same, higher;
+    uint32_t postingsID;
+    char character;
+} _tsearch_compact_node;
+
+typedef bool(*_tsearch_compact_has_postings_func)(const void *postings, const uint32_t postingsID);
+typedef result(*_tsearch_compact_union_postings_func)(const void *postings, const uint32_t postingsID,
+                                                      tsearch_countedset_ptr results);
+
+/// Describes a compact node array and where its postings live. The searches below only read
+/// through the view, so they work the same for mutable and frozen trees. Every node must come
+/// before its children in the array. Links that don't are ignored, so that a corrupt file can't
+/// make a search loop.
+typedef struct _tsearch_compact_view
+{
+    const _tsearch_compact_node *nodes;
+    uint32_t nodeCount;
+    const void *postings;
+    _tsearch_compact_has_postings_func hasPostings;
+    _tsearch_compact_union_postings_func unionPostings;
+} _tsearch_compact_view;
+
+/// Returns the index of the node at the end of the target or TSEARCH_COMPACT_NONE.
+uint32_t _tsearch_compact_search(const _tsearch_compact_view *view, const char *target);
+
+tsearch_countedset_ptr _tsearch_compact_copy_search_results(const _tsearch_compact_view *view, const char *target);
+tsearch_countedset_ptr _tsearch_compact_copy_prefix_search_results(const _tsearch_compact_view *view,
+                                                                   const char *prefix);
+tsearch_countedset_ptr _tsearch_compact_copy_partial_search_results(const _tsearch_compact_view *view,
+                                                                    const char *target,
+                                                                    const size_t length);
+tsearch_countedset_ptr _tsearch_compact_copy_subsequence_search_results(const _tsearch_compact_view *view,
+                                                                        const char *target,
+                                                                        const size_t length);
+tsearch_countedset_ptr _tsearch_compact_copy_suffix_search_results(const _tsearch_compact_view *view,
+                                                                   const char *suffix,
+                                                                   const size_t length);
+result _tsearch_compact_copy_contents(const _tsearch_compact_view *view, char **outResults, size_t *outLength);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_compactnode_h */
@@ -0,0 +1,359 @@
+//
+//  CompactTree.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include <GNETextSearch/CompactTree.h>
+#include "CompactNode.h"
+#include "GNETextSearchPrivate.h"
+#include <stdio.h>
+
+// ------------------------------------------------------------------------------------------
+
+typedef struct tsearch_compacttree
+{
+    _tsearch_compact_node *nodes;
+    uint32_t nodeCount;
+    uint32_t nodeCapacity;
+    tsearch_countedset_ptr *postings;
+    uint32_t postingsCount;
+    uint32_t postingsCapacity;
+} tsearch_compacttree;
+
+// ------------------------------------------------------------------------------------------
+
+static bool _tsearch_cstring_is_nonempty(const char *string);
+static _tsearch_compact_view _tsearch_compacttree_view(const tsearch_compacttree_ptr ptr);
+static bool _tsearch_compacttree_has_postings(const void *postings, const uint32_t postingsID);
+static result _tsearch_compacttree_union_postings(const void *postings, const uint32_t postingsID,
+                                                  tsearch_countedset_ptr results);
+static uint32_t _tsearch_compacttree_node_init(const tsearch_compacttree_ptr ptr, const char character);
+static uint32_t _tsearch_compacttree_postings_init(const tsearch_compacttree_ptr ptr);
+static result _tsearch_compacttree_increase_capacity(void **buffer, uint32_t *capacity, const uint32_t count,
+                                                     const size_t elementSize);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Compact Tree
+// ------------------------------------------------------------------------------------------
+tsearch_compacttree_ptr tsearch_compacttree_init(void)
+{
+    tsearch_compacttree_ptr ptr = calloc(1, sizeof(tsearch_compacttree));
+    if (ptr == NULL) { return NULL; }
+
+    ptr->nodes = NULL;
+    ptr->nodeCount = 0;
+    ptr->nodeCapacity = 0;
+    ptr->postings = NULL;
+    ptr->postingsCount = 0;
+    ptr->postingsCapacity = 0;
+    return ptr;
+}
+
+
+void tsearch_compacttree_free(const tsearch_compacttree_ptr ptr)
+{
+    if (ptr == NULL) { return; }
+
+    for (uint32_t i = 0; i < ptr->postingsCount; i++) {
+        tsearch_countedset_free(ptr->postings[i]);
+    }
+    free(ptr->postings);
+    free(ptr->nodes);
+    ptr->postings = NULL;
+    ptr->nodes = NULL;
+    ptr->nodeCount = 0;
+    ptr->nodeCapacity = 0;
+    ptr->postingsCount = 0;
+    ptr->postingsCapacity = 0;
+    free(ptr);
+}
+
+
+tsearch_compacttree_ptr tsearch_compacttree_insert(tsearch_compacttree_ptr ptr,
+                                                   const char *newCharacter,
+                                                   const GNEInteger documentID)
+{
+    if (!_tsearch_cstring_is_nonempty(newCharacter)) { return ptr; }
+
+    if (ptr == NULL) {
+        ptr = tsearch_compacttree_init();
+        if (ptr == NULL) { return ptr; }
+    }
+
+    const char *cursor = newCharacter;
+    if (ptr->nodeCount == 0 && _tsearch_compacttree_node_init(ptr, *cursor) == TSEARCH_COMPACT_NONE) {
+        return ptr;
+    }
+
+    // Nodes are addressed by index because adding a node may move the node array.
+    uint32_t index = 0;
+    while (true) {
+        char character = ptr->nodes[index].character;
+
+        if (*cursor < character) {
+            uint32_t lower = ptr->nodes[index].lower;
+            if (lower == TSEARCH_COMPACT_NONE) {
+                lower = _tsearch_compacttree_node_init(ptr, *cursor);
+                if (lower == TSEARCH_COMPACT_NONE) { return ptr; }
+                ptr->nodes[index].lower = lower;
+            }
+            index = lower;
+            continue;
+        }
+
+        if (*cursor > character) {
+            uint32_t higher = ptr->nodes[index].higher;
+            if (higher == TSEARCH_COMPACT_NONE) {
+                higher = _tsearch_compacttree_node_init(ptr, *cursor);
+                if (higher == TSEARCH_COMPACT_NONE) { return ptr; }
+                ptr->nodes[index].higher = higher;
+            }
+            index = higher;
+            continue;
+        }
+
+        if (cursor[1] == '\0') {
+            uint32_t postingsID = ptr->nodes[index].postingsID;
+            if (postingsID == TSEARCH_COMPACT_NONE) {
+                postingsID = _tsearch_compacttree_postings_init(ptr);
+                if (postingsID == TSEARCH_COMPACT_NONE) { return ptr; }
+                ptr->nodes[index].postingsID = postingsID;
+            }
+
+            (void)tsearch_countedset_add_int(ptr->postings[postingsID], documentID);
+            return ptr;
+        }
+
+        cursor += 1;
+        uint32_t same = ptr->nodes[index].same;
+        if (same == TSEARCH_COMPACT_NONE) {
+            same = _tsearch_compacttree_node_init(ptr, *cursor);
+            if (same == TSEARCH_COMPACT_NONE) { return ptr; }
+            ptr->nodes[index].same = same;
+        }
+        index = same;
+    }
+}
+
+
+result tsearch_compacttree_remove(const tsearch_compacttree_ptr ptr, const GNEInteger documentID)
+{
+    if (ptr == NULL) { return success; }
+
+    for (uint32_t i = 0; i < ptr->postingsCount; i++) {
+        if (tsearch_countedset_get_count(ptr->postings[i]) == 0) { continue; }
+        if (tsearch_countedset_remove_int(ptr->postings[i], documentID) == failure) { return failure; }
+    }
+
+    return success;
+}
+
+
+size_t tsearch_compacttree_get_node_count(const tsearch_compacttree_ptr ptr)
+{
+    return (ptr == NULL) ? 0 : (size_t)ptr->nodeCount;
+}
+
+
+tsearch_countedset_ptr tsearch_compacttree_copy_search_results(const tsearch_compacttree_ptr ptr, const char *target)
+{
+    if (ptr == NULL || !_tsearch_cstring_is_nonempty(target)) { return NULL; }
+
+    _tsearch_compact_view view = _tsearch_compacttree_view(ptr);
+    uint32_t index = _tsearch_compact_search(&view, target);
+    if (index == TSEARCH_COMPACT_NONE) { return NULL; }
+
+    uint32_t postingsID = ptr->nodes[index].postingsID;
+    if (_tsearch_compacttree_has_postings(ptr, postingsID) == false) { return NULL; }
+    return tsearch_countedset_copy(ptr->postings[postingsID]);
+}
+
+
+tsearch_countedset_ptr tsearch_compacttree_copy_prefix_search_results(const tsearch_compacttree_ptr ptr,
+                                                                      const char *prefix)
+{
+    if (ptr == NULL || !_tsearch_cstring_is_nonempty(prefix)) { return NULL; }
+    _tsearch_compact_view view = _tsearch_compacttree_view(ptr);
+    return _tsearch_compact_copy_prefix_search_results(&view, prefix);
+}
+
+
+tsearch_countedset_ptr tsearch_compacttree_copy_partial_search_results(const tsearch_compacttree_ptr ptr,
+                                                                       const char *target,
+                                                                       const size_t length)
+{
+    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    _tsearch_compact_view view = _tsearch_compacttree_view(ptr);
+    return _tsearch_compact_copy_partial_search_results(&view, target, length);
+}
+
+
+tsearch_countedset_ptr tsearch_compacttree_copy_subsequence_search_results(const tsearch_compacttree_ptr ptr,
+                                                                           const char *target,
+                                                                           const size_t length)
+{
+    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    _tsearch_compact_view view = _tsearch_compacttree_view(ptr);
+    return _tsearch_compact_copy_subsequence_search_results(&view, target, length);
+}
+
+
+tsearch_countedset_ptr tsearch_compacttree_copy_suffix_search_results(const tsearch_compacttree_ptr ptr,
+                                                                      const char *suffix,
+                                                                      const size_t length)
+{
+    if (ptr == NULL || suffix == NULL || length == 0) { return NULL; }
+    _tsearch_compact_view view = _tsearch_compacttree_view(ptr);
+    return _tsearch_compact_copy_suffix_search_results(&view, suffix, length);
+}
+
+
+result tsearch_compacttree_copy_contents(const tsearch_compacttree_ptr ptr, char **outResults, size_t *outLength)
+{
+    if (outResults == NULL || outLength == NULL) { return failure; }
+    *outResults = NULL;
+    *outLength = 0;
+
+    if (ptr == NULL) { return failure; }
+
+    _tsearch_compact_view view = _tsearch_compacttree_view(ptr);
+    return _tsearch_compact_copy_contents(&view, outResults, outLength);
+}
+
+
+void tsearch_compacttree_print(const tsearch_compacttree_ptr ptr)
+{
+    char *results = NULL;
+    size_t length = 0;
+
+    printf("<GNECompactTree, %p>\n", (void *)ptr);
+    if (tsearch_compacttree_copy_contents(ptr, &results, &length) == success && results != NULL) {
+        printf("%s\n", results);
+    } else {
+        printf("\n");
+    }
+
+    free(results);
+    results = NULL;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+static bool _tsearch_cstring_is_nonempty(const char *string)
+{
+    return (string != NULL && string[0] != '\0');
+}
+
+
+static _tsearch_compact_view _tsearch_compacttree_view(const tsearch_compacttree_ptr ptr)
+{
+    return (_tsearch_compact_view){
+        ptr->nodes,
+        ptr->nodeCount,
+        ptr,
+        _tsearch_compacttree_has_postings,
+        _tsearch_compacttree_union_postings,
+    };
+}
+
+
+static bool _tsearch_compacttree_has_postings(const void *postings, const uint32_t postingsID)
+{
+    const tsearch_compacttree *ptr = postings;
+    if (ptr == NULL || postingsID >= ptr->postingsCount) { return false; }
+    return (tsearch_countedset_get_count(ptr->postings[postingsID]) > 0) ? true : false;
+}
+
+
+static result _tsearch_compacttree_union_postings(const void *postings, const uint32_t postingsID,
+                                                  tsearch_countedset_ptr results)
+{
+    const tsearch_compacttree *ptr = postings;
+    if (ptr == NULL || postingsID >= ptr->postingsCount) { return failure; }
+    return tsearch_countedset_union(results, ptr->postings[postingsID]);
+}
+
+
+/// Appends a node for the specified character and returns its index. Returns TSEARCH_COMPACT_NONE
+/// on failure or if the tree already holds the maximum number of nodes.
+static uint32_t _tsearch_compacttree_node_init(const tsearch_compacttree_ptr ptr, const char character)
+{
+    if (ptr == NULL) { return TSEARCH_COMPACT_NONE; }
+
+    void *nodes = ptr->nodes;
+    if (_tsearch_compacttree_increase_capacity(&nodes, &(ptr->nodeCapacity), ptr->nodeCount,
+                                               sizeof(_tsearch_compact_node)) == failure) {
+        return TSEARCH_COMPACT_NONE;
+    }
+    ptr->nodes = nodes;
+
+    uint32_t index = ptr->nodeCount;
+    ptr->nodes[index] = (_tsearch_compact_node){
+        TSEARCH_COMPACT_NONE,
+        TSEARCH_COMPACT_NONE,
+        TSEARCH_COMPACT_NONE,
+        TSEARCH_COMPACT_NONE,
+        character,
+    };
+    ptr->nodeCount += 1;
+    return index;
+}
+
+
+/// Appends an empty counted set to the postings and returns its ID. Returns TSEARCH_COMPACT_NONE
+/// on failure.
+static uint32_t _tsearch_compacttree_postings_init(const tsearch_compacttree_ptr ptr)
+{
+    if (ptr == NULL) { return TSEARCH_COMPACT_NONE; }
+
+    void *postings = ptr->postings;
+    if (_tsearch_compacttree_increase_capacity(&postings, &(ptr->postingsCapacity), ptr->postingsCount,
+                                               sizeof(tsearch_countedset_ptr)) == failure) {
+        return TSEARCH_COMPACT_NONE;
+    }
+    ptr->postings = postings;
+
+    tsearch_countedset_ptr documentIDs = tsearch_countedset_init();
+    if (documentIDs == NULL) { return TSEARCH_COMPACT_NONE; }
+
+    uint32_t postingsID = ptr->postingsCount;
+    ptr->postings[postingsID] = documentIDs;
+    ptr->postingsCount += 1;
+    return postingsID;
+}
+
+
+/// Makes room for one more element in a buffer addressed by 32-bit indices. TSEARCH_COMPACT_NONE
+/// is reserved, so a buffer never holds more than UINT32_MAX - 1 elements.
+static result _tsearch_compacttree_increase_capacity(void **buffer, uint32_t *capacity, const uint32_t count,
+                                                     const size_t elementSize)
+{
+    if (buffer == NULL || capacity == NULL) { return failure; }
+    if (count < *capacity) { return success; }
+    if (count >= TSEARCH_COMPACT_NONE - 1) { return failure; }
+
+    size_t newCapacity = (*capacity == 0) ? 64 : (size_t)*capacity;
+    size_t byteLength = 0;
+    if (*capacity == 0) {
+        if (_tsearch_size_mul_overflows(newCapacity, elementSize, &byteLength)) { return failure; }
+    } else if (_tsearch_next_buf_len(&newCapacity, elementSize, &byteLength) == failure) {
+        return failure;
+    }
+
+    if (newCapacity > (size_t)(TSEARCH_COMPACT_NONE - 1)) {
+        newCapacity = (size_t)(TSEARCH_COMPACT_NONE - 1);
+        if (_tsearch_size_mul_overflows(newCapacity, elementSize, &byteLength)) { return failure; }
+    }
+
+    void *newBuffer = realloc(*buffer, byteLength);
+    if (newBuffer == NULL) { return failure; }
+
+    *buffer = newBuffer;
+    *capacity = (uint32_t)newCapacity;
+    return success;
+}
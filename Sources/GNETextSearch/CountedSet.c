@@ -7,12 +7,48 @@
 //
 
 #include <GNETextSearch/CountedSet.h>
+#include "CountedSetPrivate.h"
 #include "GNETextSearchPrivate.h"
 #include <limits.h>
 #include <string.h>
 
 // ------------------------------------------------------------------------------------------
 
+/// Sets with fewer nodes than this are never compacted automatically, because their free nodes
+/// take less memory than rebuilding would allocate.
+#define TSEARCH_COUNTEDSET_MIN_COMPACTION_COUNT 64
+
+/// Intersections of sets whose sizes differ by at least this factor seek the smaller set's
+/// integers in the larger set instead of merging the two sets.
+#define TSEARCH_COUNTEDSET_SKEWED_RATIO 8
+
+/// Unions of many sets whose integers span at most this many times the number of integers being
+/// combined add up their counts in an array indexed by integer instead of merging the sets.
+#define TSEARCH_COUNTEDSET_DENSE_UNION_RATIO 4
+
+// Defining TSEARCH_COUNTEDSET_COMPACT_NODES shrinks each node from 40 to 24 bytes by storing
+// counts and child indexes in 32 bits, which fits far more nodes in the cache during set
+// operations. Counted sets then hold at most UINT32_MAX - 1 integers, each with a count of at
+// most UINT32_MAX, and operations that would exceed either limit fail.
+#ifdef TSEARCH_COUNTEDSET_COMPACT_NODES
+
+#define TSEARCH_COUNTEDSET_NO_INDEX ((size_t)UINT32_MAX)
+#define TSEARCH_COUNTEDSET_MAX_COUNT ((size_t)UINT32_MAX)
+
+typedef struct _tsearch_countedset_node
+{
+    GNEInteger integer;
+    uint32_t count;
+    uint32_t left;
+    uint32_t right;
+    int8_t balance;
+} _tsearch_countedset_node;
+
+#else
+
+#define TSEARCH_COUNTEDSET_NO_INDEX SIZE_MAX
+#define TSEARCH_COUNTEDSET_MAX_COUNT SIZE_MAX
+
 typedef struct _tsearch_countedset_node
 {
     GNEInteger integer;
@@ -22,6 +58,8 @@ typedef struct _tsearch_countedset_node
     size_t right;
 } _tsearch_countedset_node;
 
+#endif
+
 
 typedef struct tsearch_countedset
 {
@@ -29,25 +67,48 @@ typedef struct tsearch_countedset
     size_t count; // The number of nodes whose count > 0.
     size_t nodesCapacity;
     size_t insertIndex;
+    size_t freeIndex; // The first node freed by a removal. Each free node's left index links the next.
+    unsigned int compactionPercent; // 0 if the set is only compacted by tsearch_countedset_compact().
 } tsearch_countedset;
 
+
+typedef struct _tsearch_countedset_range
+{
+    size_t location;
+    size_t length;
+    size_t index; // The index of the node for the range's middle integer.
+} _tsearch_countedset_range;
+
+
+typedef struct _tsearch_countedset_merge_run
+{
+    GNEInteger integer; // The run's next integer, which orders the runs in the merge's heap.
+    size_t position;
+    size_t end;
+} _tsearch_countedset_merge_run;
+
+
+typedef enum _tsearch_countedset_operation
+{
+    _tsearch_countedset_operation_union,
+    _tsearch_countedset_operation_intersection,
+    _tsearch_countedset_operation_minus,
+} _tsearch_countedset_operation;
+
 // ------------------------------------------------------------------------------------------
 
 _tsearch_countedset_node * _tsearch_countedset_copy_nodes(const tsearch_countedset_ptr ptr);
 result _tsearch_countedset_copy_ints(const tsearch_countedset_ptr ptr, GNEInteger *integers,
                                   const size_t integersCount);
 int _tsearch_countedset_compare(const void *valuePtr1, const void *valuePtr2);
-result _tsearch_countedset_add_int(const tsearch_countedset_ptr ptr,
-                                   const GNEInteger newInteger, const size_t countToAdd);
 _tsearch_countedset_node * _tsearch_countedset_get_node_for_int(const tsearch_countedset_ptr ptr,
                                                                 const GNEInteger integer);
 size_t _tsearch_countedset_get_node_idx_for_int_insert(const tsearch_countedset_ptr ptr, const GNEInteger integer);
 size_t _tsearch_countedset_get_node_and_parent_idx_for_int_insert_with_path(const tsearch_countedset_ptr ptr,
                                                                             const GNEInteger integer,
                                                                             size_t *outParentIndex,
-                                                                            size_t **path,
-                                                                            size_t *pathCount,
-                                                                            size_t *pathCapacity);
+                                                                            size_t *path,
+                                                                            size_t *pathCount);
 size_t _tsearch_countedset_get_node_and_parent_idx_for_int_insert(const tsearch_countedset_ptr ptr,
                                                                   const GNEInteger integer,
                                                                   size_t *outParentIndex);
@@ -55,6 +116,8 @@ int _tsearch_countedset_balance_node_at_idx(_tsearch_countedset_node *nodes, con
 static result _tsearch_countedset_rebalance_path(_tsearch_countedset_node *nodes,
                                                  const size_t *path,
                                                  const size_t pathCount);
+static result _tsearch_countedset_remove_node_at_end_of_path(const tsearch_countedset_ptr ptr, size_t *path,
+                                                             size_t pathCount);
 static int _tsearch_countedset_node_height(_tsearch_countedset_node *nodes, const size_t index);
 static void _tsearch_countedset_update_node_height(_tsearch_countedset_node *nodes, const size_t index);
 static int _tsearch_countedset_node_balance_factor(_tsearch_countedset_node *nodes, const size_t index);
@@ -65,10 +128,30 @@ result _tsearch_countedset_node_init(const tsearch_countedset_ptr ptr, const GNE
 result _tsearch_countedset_increase_values_buf(const tsearch_countedset_ptr ptr);
 static void _tsearch_countedset_swap_contents(tsearch_countedset_ptr a, tsearch_countedset_ptr b);
 static result _tsearch_countedset_compact_if_needed(tsearch_countedset_ptr ptr);
-static result _tsearch_countedset_index_stack_push(size_t **stack,
-                                                   size_t *count,
-                                                   size_t *capacity,
-                                                   size_t index);
+static result _tsearch_countedset_rebuild(const tsearch_countedset_ptr ptr);
+static bool _tsearch_countedset_should_merge(const size_t lookupCount, const size_t searchedCount,
+                                             const size_t mergeCount);
+static result _tsearch_countedset_merge(const tsearch_countedset_ptr ptr, const tsearch_countedset_ptr otherPtr,
+                                        const _tsearch_countedset_operation operation);
+static result _tsearch_countedset_intersect_skewed(const tsearch_countedset_ptr ptr,
+                                                   const tsearch_countedset_ptr otherPtr);
+static tsearch_countedset_ptr _tsearch_countedset_init_with_dense_union(const tsearch_countedset_ptr *sets,
+                                                                       const size_t setsCount,
+                                                                       const GNEInteger minimum,
+                                                                       const size_t span);
+static tsearch_countedset_ptr _tsearch_countedset_init_with_merged_union(const tsearch_countedset_ptr *sets,
+                                                                        const size_t setsCount,
+                                                                        const size_t totalCount);
+static void _tsearch_countedset_merge_run_sift_down(_tsearch_countedset_merge_run *heap, const size_t count,
+                                                    size_t index);
+static void _tsearch_countedset_build_balanced_nodes(_tsearch_countedset_node *nodes, const GNEInteger *integers,
+                                                     const size_t *counts, const size_t count);
+static int _tsearch_countedset_height_for_count(size_t count);
+static bool _tsearch_countedset_count_fits(const size_t count);
+static void _tsearch_countedset_radix_sort(GNEInteger *integers, GNEInteger *buffer, const size_t count);
+static bool _tsearch_countedset_node_ranks_before(const _tsearch_countedset_node *node,
+                                                  const _tsearch_countedset_node *otherNode);
+static void _tsearch_countedset_heap_sift_down(_tsearch_countedset_node *heap, const size_t count, size_t index);
 
 // ------------------------------------------------------------------------------------------
 #pragma mark - Counted Set
@@ -87,6 +170,50 @@ tsearch_countedset_ptr tsearch_countedset_init(void)
     ptr->count = 0;
     ptr->nodesCapacity = (count * size);
     ptr->insertIndex = 0;
+    ptr->freeIndex = TSEARCH_COUNTEDSET_NO_INDEX;
+    ptr->compactionPercent = TSEARCH_COUNTEDSET_DEFAULT_COMPACTION_PERCENT;
+    return ptr;
+}
+
+
+tsearch_countedset_ptr tsearch_countedset_init_with_ints(const GNEInteger *integers, const size_t count)
+{
+    if (count == 0) { return tsearch_countedset_init(); }
+    if (integers == NULL) { return NULL; }
+
+    size_t byteLength = 0;
+    if (_tsearch_size_mul_overflows(count, sizeof(GNEInteger), &byteLength)) { return NULL; }
+
+    GNEInteger *sortedIntegers = malloc(byteLength);
+    GNEInteger *buffer = malloc(byteLength);
+    if (sortedIntegers == NULL || buffer == NULL) {
+        free(sortedIntegers);
+        free(buffer);
+        return NULL;
+    }
+
+    memcpy(sortedIntegers, integers, byteLength);
+    _tsearch_countedset_radix_sort(sortedIntegers, buffer, count);
+    free(buffer);
+
+    size_t *counts = calloc(count, sizeof(size_t));
+    if (counts == NULL) { free(sortedIntegers); return NULL; }
+
+    // Collapses each run of equal integers into a single integer and its count.
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (uniqueCount > 0 && sortedIntegers[uniqueCount - 1] == sortedIntegers[i]) {
+            counts[uniqueCount - 1] += 1;
+        } else {
+            sortedIntegers[uniqueCount] = sortedIntegers[i];
+            counts[uniqueCount] = 1;
+            uniqueCount += 1;
+        }
+    }
+
+    tsearch_countedset_ptr ptr = _tsearch_countedset_init_with_sorted_ints(sortedIntegers, counts, uniqueCount);
+    free(sortedIntegers);
+    free(counts);
     return ptr;
 }
 
@@ -107,6 +234,8 @@ tsearch_countedset_ptr tsearch_countedset_copy(const tsearch_countedset_ptr ptr)
     copyPtr->count = ptr->count;
     copyPtr->nodesCapacity = ptr->nodesCapacity;
     copyPtr->insertIndex = ptr->insertIndex;
+    copyPtr->freeIndex = ptr->freeIndex;
+    copyPtr->compactionPercent = ptr->compactionPercent;
     return copyPtr;
 }
 
@@ -119,6 +248,7 @@ void tsearch_countedset_free(const tsearch_countedset_ptr ptr)
         ptr->count = 0;
         ptr->nodesCapacity = 0;
         ptr->insertIndex = 0;
+        ptr->freeIndex = TSEARCH_COUNTEDSET_NO_INDEX;
         free(ptr);
     }
 }
@@ -130,6 +260,12 @@ size_t tsearch_countedset_get_count(const tsearch_countedset_ptr ptr)
 }
 
 
+size_t tsearch_countedset_get_byte_length(const tsearch_countedset_ptr ptr)
+{
+    return (ptr == NULL) ? 0 : sizeof(tsearch_countedset) + ptr->nodesCapacity;
+}
+
+
 bool tsearch_countedset_contains_int(const tsearch_countedset_ptr ptr, const GNEInteger integer)
 {
     _tsearch_countedset_node *nodePtr = _tsearch_countedset_get_node_for_int(ptr, integer);
@@ -176,6 +312,66 @@ result tsearch_countedset_copy_ints(const tsearch_countedset_ptr ptr, GNEInteger
 }
 
 
+result tsearch_countedset_copy_top_ints(const tsearch_countedset_ptr ptr, const size_t maxCount,
+                                        GNEInteger **outIntegers, size_t *outCount)
+{
+    if (outIntegers == NULL || outCount == NULL) { return failure; }
+    *outIntegers = NULL;
+    *outCount = 0;
+
+    if (ptr == NULL || ptr->nodes == NULL) { return failure; }
+
+    size_t heapCount = (maxCount < ptr->count) ? maxCount : ptr->count;
+    if (heapCount == 0) { return success; }
+
+    size_t heapByteLength = 0;
+    size_t integersByteLength = 0;
+    if (_tsearch_size_mul_overflows(heapCount, sizeof(_tsearch_countedset_node), &heapByteLength) ||
+        _tsearch_size_mul_overflows(heapCount, sizeof(GNEInteger), &integersByteLength)) {
+        return failure;
+    }
+
+    // The heap's root is the lowest ranked of the best integers found so far, so each
+    // remaining integer only has to be compared with it.
+    _tsearch_countedset_node *heap = malloc(heapByteLength);
+    if (heap == NULL) { return failure; }
+
+    size_t count = 0;
+    for (size_t i = 0; i < ptr->insertIndex; i++) {
+        _tsearch_countedset_node *nodePtr = &(ptr->nodes[i]);
+        if (nodePtr->count == 0) { continue; }
+
+        if (count < heapCount) {
+            heap[count] = *nodePtr;
+            count += 1;
+            if (count == heapCount) {
+                for (size_t j = heapCount / 2; j > 0; j--) {
+                    _tsearch_countedset_heap_sift_down(heap, heapCount, j - 1);
+                }
+            }
+        } else if (_tsearch_countedset_node_ranks_before(nodePtr, &(heap[0]))) {
+            heap[0] = *nodePtr;
+            _tsearch_countedset_heap_sift_down(heap, heapCount, 0);
+        }
+    }
+
+    GNEInteger *integers = malloc(integersByteLength);
+    if (integers == NULL) { free(heap); return failure; }
+
+    // Repeatedly removing the root yields the integers from the lowest ranked to the highest.
+    for (size_t i = heapCount; i > 0; i--) {
+        integers[i - 1] = heap[0].integer;
+        heap[0] = heap[i - 1];
+        _tsearch_countedset_heap_sift_down(heap, i - 1, 0);
+    }
+    free(heap);
+
+    *outIntegers = integers;
+    *outCount = heapCount;
+    return success;
+}
+
+
 result tsearch_countedset_add_int(const tsearch_countedset_ptr ptr, const GNEInteger integer)
 {
     return _tsearch_countedset_add_int(ptr, integer, 1);
@@ -185,10 +381,20 @@ result tsearch_countedset_add_int(const tsearch_countedset_ptr ptr, const GNEInt
 result tsearch_countedset_remove_int(const tsearch_countedset_ptr ptr, const GNEInteger integer)
 {
     if (ptr == NULL || ptr->nodes == NULL) { return failure; }
-    _tsearch_countedset_node *nodePtr = _tsearch_countedset_get_node_for_int(ptr, integer);
-    if (nodePtr == NULL || nodePtr->count == 0) { return success; }
-    nodePtr->count = 0;
-    ptr->count -= 1;
+    if (ptr->count == 0) { return success; }
+
+    // The path is extended down to the removed node's successor, which is never below the tree's height.
+    size_t path[TSEARCH_COUNTEDSET_MAX_HEIGHT];
+    size_t pathCount = 0;
+    size_t index = _tsearch_countedset_get_node_and_parent_idx_for_int_insert_with_path(ptr,
+                                                                                        integer,
+                                                                                        NULL,
+                                                                                        path,
+                                                                                        &pathCount);
+    if (index == SIZE_MAX) { return failure; }
+    if (ptr->nodes[index].integer != integer) { return success; }
+
+    if (_tsearch_countedset_remove_node_at_end_of_path(ptr, path, pathCount) == failure) { return failure; }
     (void)_tsearch_countedset_compact_if_needed(ptr);
     return success;
 }
@@ -197,12 +403,25 @@ result tsearch_countedset_remove_int(const tsearch_countedset_ptr ptr, const GNE
 result tsearch_countedset_remove_all_ints(const tsearch_countedset_ptr ptr)
 {
     if (ptr == NULL || ptr->nodes == NULL) { return failure; }
-    size_t count = ptr->insertIndex;
-    for (size_t i = 0; i < count; i++) {
-        ptr->nodes[i].count = 0;
-    }
     ptr->count = 0;
-    (void)_tsearch_countedset_compact_if_needed(ptr);
+    ptr->insertIndex = 0;
+    ptr->freeIndex = TSEARCH_COUNTEDSET_NO_INDEX;
+    return success;
+}
+
+
+result tsearch_countedset_compact(const tsearch_countedset_ptr ptr)
+{
+    if (ptr == NULL || ptr->nodes == NULL) { return failure; }
+    if (ptr->count == ptr->insertIndex) { return success; }
+    return _tsearch_countedset_rebuild(ptr);
+}
+
+
+result tsearch_countedset_set_compaction_percent(const tsearch_countedset_ptr ptr, const unsigned int percent)
+{
+    if (ptr == NULL || percent > 100) { return failure; }
+    ptr->compactionPercent = percent;
     return success;
 }
 
@@ -212,6 +431,14 @@ result tsearch_countedset_union(const tsearch_countedset_ptr ptr, const tsearch_
     if (ptr == NULL || ptr->nodes == NULL) { return failure; }
     if (otherPtr == NULL || otherPtr->nodes == NULL) { return success; }
 
+    size_t mergeCount = 0;
+    if (_tsearch_size_add_overflows(ptr->insertIndex, otherPtr->insertIndex, &mergeCount)) {
+        mergeCount = SIZE_MAX;
+    }
+    if (_tsearch_countedset_should_merge(otherPtr->count, mergeCount, mergeCount)) {
+        return _tsearch_countedset_merge(ptr, otherPtr, _tsearch_countedset_operation_union);
+    }
+
     size_t otherCount = otherPtr->insertIndex;
     _tsearch_countedset_node *otherNodes = otherPtr->nodes;
     for (size_t i = 0; i < otherCount; i++) {
@@ -236,6 +463,20 @@ result tsearch_countedset_intersect(const tsearch_countedset_ptr ptr, const tsea
     size_t actualCount = ptr->insertIndex;
     if (actualCount == 0) { return success; }
 
+    size_t smallerCount = (ptr->count < otherPtr->count) ? ptr->count : otherPtr->count;
+    size_t largerCount = (ptr->count < otherPtr->count) ? otherPtr->count : ptr->count;
+    if (smallerCount == 0 || largerCount / smallerCount >= TSEARCH_COUNTEDSET_SKEWED_RATIO) {
+        return _tsearch_countedset_intersect_skewed(ptr, otherPtr);
+    }
+
+    size_t mergeCount = 0;
+    if (_tsearch_size_add_overflows(ptr->insertIndex, otherPtr->insertIndex, &mergeCount)) {
+        mergeCount = SIZE_MAX;
+    }
+    if (_tsearch_countedset_should_merge(ptr->count, otherPtr->insertIndex, mergeCount)) {
+        return _tsearch_countedset_merge(ptr, otherPtr, _tsearch_countedset_operation_intersection);
+    }
+
     // Copy all of the counted set's values so that we can iterate over them
     // while modifying the set.
     _tsearch_countedset_node *nodesCopy = _tsearch_countedset_copy_nodes(ptr);
@@ -270,6 +511,15 @@ result tsearch_countedset_minus(const tsearch_countedset_ptr ptr, const tsearch_
 {
     if (ptr == NULL || ptr->nodes == NULL) { return failure; }
     if (otherPtr == NULL || otherPtr->nodes == NULL) { return success; }
+    if (ptr == otherPtr) { return tsearch_countedset_remove_all_ints(ptr); }
+
+    size_t mergeCount = 0;
+    if (_tsearch_size_add_overflows(ptr->insertIndex, otherPtr->insertIndex, &mergeCount)) {
+        mergeCount = SIZE_MAX;
+    }
+    if (_tsearch_countedset_should_merge(otherPtr->count, ptr->insertIndex, mergeCount)) {
+        return _tsearch_countedset_merge(ptr, otherPtr, _tsearch_countedset_operation_minus);
+    }
 
     size_t otherUsedCount = otherPtr->insertIndex;
     _tsearch_countedset_node *otherNodes = otherPtr->nodes;
@@ -292,6 +542,206 @@ result tsearch_countedset_minus(const tsearch_countedset_ptr ptr, const tsearch_
 }
 
 
+result _tsearch_countedset_remove_ints_in_set(const tsearch_countedset_ptr ptr, const tsearch_countedset_ptr otherPtr)
+{
+    if (ptr == NULL || ptr->nodes == NULL) { return failure; }
+    if (otherPtr == NULL || otherPtr->nodes == NULL || ptr->count == 0) { return success; }
+    if (ptr == otherPtr) { return tsearch_countedset_remove_all_ints(ptr); }
+
+    // Each lookup is a search of the other set, so the loop runs over whichever set is smaller.
+    if (ptr->insertIndex <= otherPtr->insertIndex) {
+        // Removing nodes moves other nodes around, so the set's own nodes are copied first.
+        size_t nodesCount = ptr->insertIndex;
+        _tsearch_countedset_node *nodesCopy = _tsearch_countedset_copy_nodes(ptr);
+        if (nodesCopy == NULL) { return failure; }
+
+        for (size_t i = 0; i < nodesCount; i++) {
+            if (nodesCopy[i].count == 0) { continue; }
+            if (tsearch_countedset_contains_int(otherPtr, nodesCopy[i].integer) == false) { continue; }
+            if (tsearch_countedset_remove_int(ptr, nodesCopy[i].integer) == failure) {
+                free(nodesCopy);
+                return failure;
+            }
+        }
+        free(nodesCopy);
+    } else {
+        for (size_t i = 0; i < otherPtr->insertIndex; i++) {
+            _tsearch_countedset_node otherValue = otherPtr->nodes[i];
+            if (otherValue.count == 0) { continue; }
+            if (tsearch_countedset_remove_int(ptr, otherValue.integer) == failure) { return failure; }
+        }
+    }
+
+    return success;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Iterator
+// ------------------------------------------------------------------------------------------
+result tsearch_countedset_iterator_init(tsearch_countedset_iterator *iterator, const tsearch_countedset_ptr ptr)
+{
+    if (iterator == NULL) { return failure; }
+    iterator->set = NULL;
+    iterator->stackCount = 0;
+    iterator->nextIndex = TSEARCH_COUNTEDSET_NO_INDEX;
+    if (ptr == NULL || ptr->nodes == NULL) { return failure; }
+
+    // The root's balance holds the height of the whole tree.
+    if (ptr->insertIndex > 0 && ptr->nodes[0].balance > TSEARCH_COUNTEDSET_MAX_HEIGHT) { return failure; }
+
+    iterator->set = ptr;
+    iterator->nextIndex = (ptr->insertIndex > 0) ? 0 : TSEARCH_COUNTEDSET_NO_INDEX;
+    return success;
+}
+
+
+bool tsearch_countedset_iterator_next(tsearch_countedset_iterator *iterator,
+                                      GNEInteger *outInteger, size_t *outCount)
+{
+    if (iterator == NULL || iterator->set == NULL) { return false; }
+
+    _tsearch_countedset_node *nodes = iterator->set->nodes;
+    while (true) {
+        while (iterator->nextIndex != TSEARCH_COUNTEDSET_NO_INDEX) {
+            iterator->stack[iterator->stackCount] = iterator->nextIndex;
+            iterator->stackCount += 1;
+            iterator->nextIndex = nodes[iterator->nextIndex].left;
+        }
+        if (iterator->stackCount == 0) { return false; }
+
+        iterator->stackCount -= 1;
+        size_t index = iterator->stack[iterator->stackCount];
+        iterator->nextIndex = nodes[index].right;
+        if (nodes[index].count == 0) { continue; }
+
+        if (outInteger != NULL) { *outInteger = nodes[index].integer; }
+        if (outCount != NULL) { *outCount = nodes[index].count; }
+        return true;
+    }
+}
+
+
+result tsearch_countedset_foreach(const tsearch_countedset_ptr ptr, const tsearch_countedset_foreach_func func,
+                                  void *context)
+{
+    if (func == NULL) { return failure; }
+
+    tsearch_countedset_iterator iterator;
+    if (tsearch_countedset_iterator_init(&iterator, ptr) == failure) { return failure; }
+
+    GNEInteger integer = 0;
+    size_t count = 0;
+    while (tsearch_countedset_iterator_next(&iterator, &integer, &count)) {
+        if (func(integer, count, context) == false) { break; }
+    }
+    return success;
+}
+
+
+bool _tsearch_countedset_iterator_seek(tsearch_countedset_iterator *iterator, const GNEInteger integer,
+                                       GNEInteger *outInteger, size_t *outCount)
+{
+    if (iterator == NULL || iterator->set == NULL) { return false; }
+
+    // Everything still to be visited before a stacked node is smaller than it, so once a stacked
+    // node is smaller than the integer, only its right subtree can hold the next integer.
+    _tsearch_countedset_node *nodes = iterator->set->nodes;
+    while (iterator->stackCount > 0 && nodes[iterator->stack[iterator->stackCount - 1]].integer < integer) {
+        iterator->stackCount -= 1;
+        iterator->nextIndex = nodes[iterator->stack[iterator->stackCount]].right;
+    }
+
+    // Only the nodes that aren't smaller than the integer need to be visited later.
+    size_t index = iterator->nextIndex;
+    while (index != TSEARCH_COUNTEDSET_NO_INDEX) {
+        if (nodes[index].integer < integer) {
+            index = nodes[index].right;
+        } else {
+            iterator->stack[iterator->stackCount] = index;
+            iterator->stackCount += 1;
+            index = nodes[index].left;
+        }
+    }
+    iterator->nextIndex = TSEARCH_COUNTEDSET_NO_INDEX;
+
+    return tsearch_countedset_iterator_next(iterator, outInteger, outCount);
+}
+
+
+tsearch_countedset_ptr _tsearch_countedset_init_with_sorted_ints(const GNEInteger *integers,
+                                                                 const size_t *counts,
+                                                                 const size_t count)
+{
+    if (count == 0) { return tsearch_countedset_init(); }
+    if (integers == NULL || count >= TSEARCH_COUNTEDSET_NO_INDEX) { return NULL; }
+    for (size_t i = 0; counts != NULL && i < count; i++) {
+        if (_tsearch_countedset_count_fits(counts[i]) == false) { return NULL; }
+    }
+
+    // Leaves room for a few insertions before the nodes need to be reallocated.
+    size_t nodeCount = 0;
+    size_t byteLength = 0;
+    if (_tsearch_size_add_overflows(count, 5, &nodeCount) ||
+        _tsearch_size_mul_overflows(nodeCount, sizeof(_tsearch_countedset_node), &byteLength)) {
+        return NULL;
+    }
+
+    tsearch_countedset_ptr ptr = calloc(1, sizeof(tsearch_countedset));
+    if (ptr == NULL) { return NULL; }
+
+    _tsearch_countedset_node *nodes = malloc(byteLength);
+    if (nodes == NULL) { free(ptr); return NULL; }
+
+    _tsearch_countedset_build_balanced_nodes(nodes, integers, counts, count);
+
+    ptr->nodes = nodes;
+    ptr->count = count;
+    ptr->nodesCapacity = byteLength;
+    ptr->insertIndex = count;
+    ptr->freeIndex = TSEARCH_COUNTEDSET_NO_INDEX;
+    ptr->compactionPercent = TSEARCH_COUNTEDSET_DEFAULT_COMPACTION_PERCENT;
+    return ptr;
+}
+
+
+tsearch_countedset_ptr _tsearch_countedset_init_with_union_of_sets(const tsearch_countedset_ptr *sets,
+                                                                   const size_t setsCount)
+{
+    if (sets == NULL && setsCount > 0) { return NULL; }
+
+    size_t totalCount = 0;
+    GNEInteger minimum = INT64_MAX;
+    GNEInteger maximum = INT64_MIN;
+    for (size_t i = 0; i < setsCount; i++) {
+        tsearch_countedset_ptr ptr = sets[i];
+        if (ptr == NULL || ptr->nodes == NULL || ptr->count == 0) { continue; }
+        if (_tsearch_size_add_overflows(totalCount, ptr->count, &totalCount)) { return NULL; }
+
+        size_t index = 0;
+        while (ptr->nodes[index].left != TSEARCH_COUNTEDSET_NO_INDEX) { index = ptr->nodes[index].left; }
+        if (ptr->nodes[index].integer < minimum) { minimum = ptr->nodes[index].integer; }
+
+        index = 0;
+        while (ptr->nodes[index].right != TSEARCH_COUNTEDSET_NO_INDEX) { index = ptr->nodes[index].right; }
+        if (ptr->nodes[index].integer > maximum) { maximum = ptr->nodes[index].integer; }
+    }
+    if (totalCount == 0) { return tsearch_countedset_init(); }
+
+    // Unsigned subtraction gives the span even when it's too large for a GNEInteger.
+    uint64_t span = (uint64_t)maximum - (uint64_t)minimum;
+    size_t denseLimit = 0;
+    if (_tsearch_size_mul_overflows(totalCount, TSEARCH_COUNTEDSET_DENSE_UNION_RATIO, &denseLimit)) {
+        denseLimit = SIZE_MAX;
+    }
+
+    if (span < denseLimit) {
+        return _tsearch_countedset_init_with_dense_union(sets, setsCount, minimum, (size_t)span + 1);
+    }
+    return _tsearch_countedset_init_with_merged_union(sets, setsCount, totalCount);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Private
 // ------------------------------------------------------------------------------------------
@@ -350,6 +800,8 @@ int _tsearch_countedset_compare(const void *valuePtr1, const void *valuePtr2)
 
     if (value1.count > value2.count) { return -1; }
     if (value1.count < value2.count) { return 1; }
+    if (value1.integer < value2.integer) { return -1; }
+    if (value1.integer > value2.integer) { return 1; }
     return 0;
 }
 
@@ -368,63 +820,39 @@ result _tsearch_countedset_add_int(const tsearch_countedset_ptr ptr,
         return success;
     }
 
-    size_t *path = NULL;
+    // The path to the insertion point can't be taller than the tree, so it fits on the stack.
+    size_t path[TSEARCH_COUNTEDSET_MAX_HEIGHT];
     size_t pathCount = 0;
-    size_t pathCapacity = 0;
     size_t insertIndex = _tsearch_countedset_get_node_and_parent_idx_for_int_insert_with_path(ptr,
                                                                                               newInteger,
                                                                                               NULL,
-                                                                                              &path,
-                                                                                              &pathCount,
-                                                                                              &pathCapacity);
-    if (insertIndex == SIZE_MAX) {
-        free(path);
-        return failure;
-    }
+                                                                                              path,
+                                                                                              &pathCount);
+    if (insertIndex == SIZE_MAX) { return failure; }
 
     _tsearch_countedset_node *nodePtr = &(ptr->nodes[insertIndex]);
     GNEInteger nodeInteger = nodePtr->integer;
 
     if (nodeInteger == newInteger) {
         size_t newCount = 0;
-        if (_tsearch_size_add_overflows(nodePtr->count, countToAdd, &newCount)) {
-            free(path);
+        if (_tsearch_size_add_overflows(nodePtr->count, countToAdd, &newCount) ||
+            _tsearch_countedset_count_fits(newCount) == false) {
             return failure;
         }
 
-        if (nodePtr->count == 0 && newCount > 0) {
-            size_t activeCount = 0;
-            if (_tsearch_size_add_overflows(ptr->count, 1, &activeCount)) {
-                free(path);
-                return failure;
-            }
-            ptr->count = activeCount;
-        }
-
         nodePtr->count = newCount;
-        free(path);
         return success;
     }
 
     size_t index = SIZE_MAX;
     int result = _tsearch_countedset_node_init(ptr, newInteger, countToAdd, &index);
-    if (result == failure || index == SIZE_MAX) {
-        free(path);
-        return failure;
-    }
+    if (result == failure || index == SIZE_MAX) { return failure; }
     nodePtr = &(ptr->nodes[insertIndex]); // If ptr->nodes was realloced, we need to refresh the pointer.
 
     if (newInteger < nodeInteger) { nodePtr->left = index; }
     else { nodePtr->right = index; }
 
-    if (_tsearch_countedset_rebalance_path(ptr->nodes, path, pathCount) == failure) {
-        free(path);
-        return failure;
-    }
-
-    free(path);
-
-    return success;
+    return _tsearch_countedset_rebalance_path(ptr->nodes, path, pathCount);
 }
 
 
@@ -457,17 +885,17 @@ size_t _tsearch_countedset_get_node_and_parent_idx_for_int_insert(const tsearch_
                                                                                 integer,
                                                                                 outParentIndex,
                                                                                 NULL,
-                                                                                NULL,
                                                                                 NULL);
 }
 
 
+/// If path isn't NULL, it must have room for TSEARCH_COUNTEDSET_MAX_HEIGHT indexes. The index of
+/// each node visited is written to it, and the number of nodes visited is written to pathCount.
 size_t _tsearch_countedset_get_node_and_parent_idx_for_int_insert_with_path(const tsearch_countedset_ptr ptr,
                                                                             const GNEInteger integer,
                                                                             size_t *outParentIndex,
-                                                                            size_t **path,
-                                                                            size_t *pathCount,
-                                                                            size_t *pathCapacity)
+                                                                            size_t *path,
+                                                                            size_t *pathCount)
 {
     if (ptr == NULL || ptr->nodes == NULL || ptr->insertIndex == 0) { return SIZE_MAX; }
 
@@ -477,17 +905,16 @@ size_t _tsearch_countedset_get_node_and_parent_idx_for_int_insert_with_path(cons
     do {
         if (outParentIndex != NULL) { *outParentIndex = parentIndex; }
         parentIndex = nextIndex;
-        if (path != NULL &&
-            pathCount != NULL &&
-            pathCapacity != NULL &&
-            _tsearch_countedset_index_stack_push(path, pathCount, pathCapacity, parentIndex) == failure) {
-            return SIZE_MAX;
+        if (path != NULL && pathCount != NULL) {
+            if (*pathCount >= TSEARCH_COUNTEDSET_MAX_HEIGHT) { return SIZE_MAX; }
+            path[*pathCount] = parentIndex;
+            *pathCount += 1;
         }
 
         if (integer < nodes[parentIndex].integer) { nextIndex = nodes[parentIndex].left; }
         else if (integer > nodes[parentIndex].integer) { nextIndex = nodes[parentIndex].right; }
         else { return parentIndex; }
-    } while (nextIndex != SIZE_MAX);
+    } while (nextIndex != TSEARCH_COUNTEDSET_NO_INDEX);
 
     return parentIndex;
 }
@@ -495,7 +922,7 @@ size_t _tsearch_countedset_get_node_and_parent_idx_for_int_insert_with_path(cons
 
 int _tsearch_countedset_balance_node_at_idx(_tsearch_countedset_node *nodes, const size_t index)
 {
-    if (nodes == NULL || index == SIZE_MAX) { return 0; }
+    if (nodes == NULL || index == TSEARCH_COUNTEDSET_NO_INDEX) { return 0; }
     _tsearch_countedset_update_node_height(nodes, index);
     return _tsearch_countedset_node_height(nodes, index);
 }
@@ -511,40 +938,93 @@ static result _tsearch_countedset_rebalance_path(_tsearch_countedset_node *nodes
         size_t index = path[i - 1];
         if (index == SIZE_MAX) { return failure; }
 
+        int previousHeight = _tsearch_countedset_node_height(nodes, index);
         _tsearch_countedset_update_node_height(nodes, index);
         int balance = _tsearch_countedset_node_balance_factor(nodes, index);
 
         if (balance > 1) {
             size_t leftIndex = nodes[index].left;
-            if (leftIndex == SIZE_MAX) { return failure; }
+            if (leftIndex == TSEARCH_COUNTEDSET_NO_INDEX) { return failure; }
             if (_tsearch_countedset_node_balance_factor(nodes, leftIndex) < 0) {
                 _tsearch_countedset_rotate_right(nodes, leftIndex);
             }
             _tsearch_countedset_rotate_left(nodes, index);
         } else if (balance < -1) {
             size_t rightIndex = nodes[index].right;
-            if (rightIndex == SIZE_MAX) { return failure; }
+            if (rightIndex == TSEARCH_COUNTEDSET_NO_INDEX) { return failure; }
             if (_tsearch_countedset_node_balance_factor(nodes, rightIndex) > 0) {
                 _tsearch_countedset_rotate_left(nodes, rightIndex);
             }
             _tsearch_countedset_rotate_right(nodes, index);
         }
+
+        // Once a subtree is as tall as it was before, none of its ancestors can have changed.
+        if (_tsearch_countedset_node_height(nodes, index) == previousHeight) { break; }
     }
 
     return success;
 }
 
 
+/// Removes the node at the end of the path, which must have room for TSEARCH_COUNTEDSET_MAX_HEIGHT
+/// indexes, and rebalances the tree. A node with two children takes its successor's integer and
+/// count, and the successor is removed instead. The removed node's index is added to the free list.
+static result _tsearch_countedset_remove_node_at_end_of_path(const tsearch_countedset_ptr ptr, size_t *path,
+                                                             size_t pathCount)
+{
+    if (ptr == NULL || ptr->nodes == NULL || path == NULL || pathCount == 0) { return failure; }
+
+    _tsearch_countedset_node *nodes = ptr->nodes;
+    size_t index = path[pathCount - 1];
+    if (nodes[index].left != TSEARCH_COUNTEDSET_NO_INDEX && nodes[index].right != TSEARCH_COUNTEDSET_NO_INDEX) {
+        size_t successorIndex = nodes[index].right;
+        while (true) {
+            if (pathCount >= TSEARCH_COUNTEDSET_MAX_HEIGHT) { return failure; }
+            path[pathCount] = successorIndex;
+            pathCount += 1;
+            if (nodes[successorIndex].left == TSEARCH_COUNTEDSET_NO_INDEX) { break; }
+            successorIndex = nodes[successorIndex].left;
+        }
+        nodes[index].integer = nodes[successorIndex].integer;
+        nodes[index].count = nodes[successorIndex].count;
+        index = successorIndex;
+    }
+
+    size_t childIndex = (nodes[index].left != TSEARCH_COUNTEDSET_NO_INDEX) ? nodes[index].left : nodes[index].right;
+    pathCount -= 1;
+
+    if (pathCount == 0) {
+        if (childIndex == TSEARCH_COUNTEDSET_NO_INDEX) { return tsearch_countedset_remove_all_ints(ptr); }
+
+        // The root has to stay at index 0, so its only child, which is a leaf, moves up into it.
+        nodes[0] = nodes[childIndex];
+        index = childIndex;
+    } else {
+        size_t parentIndex = path[pathCount - 1];
+        if (nodes[parentIndex].left == index) { nodes[parentIndex].left = childIndex; }
+        else { nodes[parentIndex].right = childIndex; }
+    }
+
+    nodes[index].count = 0;
+    nodes[index].left = ptr->freeIndex;
+    nodes[index].right = TSEARCH_COUNTEDSET_NO_INDEX;
+    ptr->freeIndex = index;
+    ptr->count -= 1;
+
+    return _tsearch_countedset_rebalance_path(nodes, path, pathCount);
+}
+
+
 static int _tsearch_countedset_node_height(_tsearch_countedset_node *nodes, const size_t index)
 {
-    if (nodes == NULL || index == SIZE_MAX) { return 0; }
+    if (nodes == NULL || index == TSEARCH_COUNTEDSET_NO_INDEX) { return 0; }
     return nodes[index].balance;
 }
 
 
 static void _tsearch_countedset_update_node_height(_tsearch_countedset_node *nodes, const size_t index)
 {
-    if (nodes == NULL || index == SIZE_MAX) { return; }
+    if (nodes == NULL || index == TSEARCH_COUNTEDSET_NO_INDEX) { return; }
 
     int leftHeight = _tsearch_countedset_node_height(nodes, nodes[index].left);
     int rightHeight = _tsearch_countedset_node_height(nodes, nodes[index].right);
@@ -555,7 +1035,7 @@ static void _tsearch_countedset_update_node_height(_tsearch_countedset_node *nod
 
 static int _tsearch_countedset_node_balance_factor(_tsearch_countedset_node *nodes, const size_t index)
 {
-    if (nodes == NULL || index == SIZE_MAX) { return 0; }
+    if (nodes == NULL || index == TSEARCH_COUNTEDSET_NO_INDEX) { return 0; }
 
     int leftHeight = _tsearch_countedset_node_height(nodes, nodes[index].left);
     int rightHeight = _tsearch_countedset_node_height(nodes, nodes[index].right);
@@ -565,11 +1045,11 @@ static int _tsearch_countedset_node_balance_factor(_tsearch_countedset_node *nod
 
 void _tsearch_countedset_rotate_left(_tsearch_countedset_node *nodes, const size_t index)
 {
-    if (nodes == NULL || index == SIZE_MAX) { return; }
+    if (nodes == NULL || index == TSEARCH_COUNTEDSET_NO_INDEX) { return; }
 
     _tsearch_countedset_node node = nodes[index];
     size_t childIndex = node.left;
-    if (childIndex == SIZE_MAX) { return; }
+    if (childIndex == TSEARCH_COUNTEDSET_NO_INDEX) { return; }
 
     _tsearch_countedset_node childNode = nodes[childIndex];
     size_t grandchildIndex = childNode.right;
@@ -587,11 +1067,11 @@ void _tsearch_countedset_rotate_left(_tsearch_countedset_node *nodes, const size
 
 void _tsearch_countedset_rotate_right(_tsearch_countedset_node *nodes, const size_t index)
 {
-    if (nodes == NULL || index == SIZE_MAX) { return; }
+    if (nodes == NULL || index == TSEARCH_COUNTEDSET_NO_INDEX) { return; }
 
     _tsearch_countedset_node node = nodes[index];
     size_t childIndex = node.right;
-    if (childIndex == SIZE_MAX) { return; }
+    if (childIndex == TSEARCH_COUNTEDSET_NO_INDEX) { return; }
 
     _tsearch_countedset_node childNode = nodes[childIndex];
     size_t grandchildIndex = childNode.left;
@@ -608,6 +1088,7 @@ void _tsearch_countedset_rotate_right(_tsearch_countedset_node *nodes, const siz
 
 
 /// Returns a pointer to a new counted set node and increments the GNEIntegerCountedSet's count.
+/// Nodes freed by removals are reused before the set grows.
 result _tsearch_countedset_node_init(const tsearch_countedset_ptr ptr, const GNEInteger integer,
                                      const size_t count, size_t *outIndex)
 {
@@ -615,27 +1096,32 @@ result _tsearch_countedset_node_init(const tsearch_countedset_ptr ptr, const GNE
     if (ptr == NULL || ptr->nodes == NULL) { *outIndex = SIZE_MAX; return failure; }
     if (count == 0) { *outIndex = SIZE_MAX; return success; }
 
-    if (_tsearch_countedset_increase_values_buf(ptr) == failure) {
-        *outIndex = SIZE_MAX;
-        return failure;
-    }
-
-    size_t index = ptr->insertIndex;
-    size_t nextInsertIndex = 0;
     size_t activeCount = 0;
-    if (_tsearch_size_add_overflows(ptr->insertIndex, 1, &nextInsertIndex) ||
+    if (_tsearch_countedset_count_fits(count) == false ||
         _tsearch_size_add_overflows(ptr->count, 1, &activeCount)) {
         *outIndex = SIZE_MAX;
         return failure;
     }
 
-    ptr->insertIndex = nextInsertIndex;
+    size_t index = ptr->freeIndex;
+    if (index != TSEARCH_COUNTEDSET_NO_INDEX) {
+        ptr->freeIndex = ptr->nodes[index].left;
+    } else {
+        if (ptr->insertIndex >= TSEARCH_COUNTEDSET_NO_INDEX ||
+            _tsearch_countedset_increase_values_buf(ptr) == failure) {
+            *outIndex = SIZE_MAX;
+            return failure;
+        }
+        index = ptr->insertIndex;
+        ptr->insertIndex += 1;
+    }
+
     ptr->count = activeCount;
     ptr->nodes[index].integer = integer;
     ptr->nodes[index].count = count;
     ptr->nodes[index].balance = 1;
-    ptr->nodes[index].left = SIZE_MAX;
-    ptr->nodes[index].right = SIZE_MAX;
+    ptr->nodes[index].left = TSEARCH_COUNTEDSET_NO_INDEX;
+    ptr->nodes[index].right = TSEARCH_COUNTEDSET_NO_INDEX;
     *outIndex = index;
     return success;
 }
@@ -672,66 +1158,560 @@ static void _tsearch_countedset_swap_contents(tsearch_countedset_ptr a, tsearch_
     tsearch_countedset tmp = *a;
     *a = *b;
     *b = tmp;
+
+    // The compaction policy belongs to the set, not to its contents.
+    unsigned int compactionPercent = a->compactionPercent;
+    a->compactionPercent = b->compactionPercent;
+    b->compactionPercent = compactionPercent;
 }
 
 
 static result _tsearch_countedset_compact_if_needed(tsearch_countedset_ptr ptr)
 {
     if (ptr == NULL || ptr->nodes == NULL) { return failure; }
-    if (ptr->insertIndex < 64) { return success; }
+    if (ptr->compactionPercent == 0 || ptr->insertIndex < TSEARCH_COUNTEDSET_MIN_COMPACTION_COUNT) { return success; }
 
-    size_t tombstones = ptr->insertIndex - ptr->count;
-    if (tombstones < (ptr->insertIndex / 2)) { return success; }
+    // Splitting the percentage keeps it from overflowing for any node count.
+    size_t insertIndex = ptr->insertIndex;
+    size_t threshold = (insertIndex / 100) * ptr->compactionPercent +
+                       ((insertIndex % 100) * ptr->compactionPercent) / 100;
+    size_t freeCount = insertIndex - ptr->count;
+    if (freeCount == 0 || freeCount < threshold) { return success; }
 
-    tsearch_countedset_ptr rebuilt = tsearch_countedset_init();
-    if (rebuilt == NULL) { return failure; }
+    return _tsearch_countedset_rebuild(ptr);
+}
 
-    for (size_t i = 0; i < ptr->insertIndex; i++) {
-        _tsearch_countedset_node node = ptr->nodes[i];
-        if (node.count == 0) { continue; }
-        if (_tsearch_countedset_add_int(rebuilt, node.integer, node.count) == failure) {
-            tsearch_countedset_free(rebuilt);
-            return failure;
-        }
+
+/// Replaces the counted set's tree with a balanced one without any free nodes. The live
+/// integers are copied in order and the tree is built from them directly, so rebuilding takes O(n)
+/// instead of the O(n log n) of adding each integer to a new set. Leaves the set unchanged on failure.
+static result _tsearch_countedset_rebuild(const tsearch_countedset_ptr ptr)
+{
+    size_t count = ptr->count;
+    size_t integersByteLength = 0;
+    size_t countsByteLength = 0;
+    if (_tsearch_size_mul_overflows(count, sizeof(GNEInteger), &integersByteLength) ||
+        _tsearch_size_mul_overflows(count, sizeof(size_t), &countsByteLength)) {
+        return failure;
     }
 
+    GNEInteger *integers = malloc((integersByteLength > 0) ? integersByteLength : 1);
+    size_t *counts = malloc((countsByteLength > 0) ? countsByteLength : 1);
+    if (integers == NULL || counts == NULL) {
+        free(integers);
+        free(counts);
+        return failure;
+    }
+
+    tsearch_countedset_iterator iterator;
+    (void)tsearch_countedset_iterator_init(&iterator, ptr);
+    for (size_t i = 0; i < count; i++) {
+        (void)tsearch_countedset_iterator_next(&iterator, &(integers[i]), &(counts[i]));
+    }
+
+    tsearch_countedset_ptr rebuilt = _tsearch_countedset_init_with_sorted_ints(integers, counts, count);
+    free(integers);
+    free(counts);
+    if (rebuilt == NULL) { return failure; }
+
     _tsearch_countedset_swap_contents(ptr, rebuilt);
     tsearch_countedset_free(rebuilt);
     return success;
 }
 
 
-static result _tsearch_countedset_index_stack_push(size_t **stack,
-                                                   size_t *count,
-                                                   size_t *capacity,
-                                                   size_t index)
+/// Merging visits every node in both sets and then builds a new tree, so it only pays off when it
+/// replaces enough lookups. Each lookup walks about log2(searchedCount) nodes. Measured against the
+/// random-integers-100000 fixtures, merging costs about four node visits per integer.
+static bool _tsearch_countedset_should_merge(const size_t lookupCount, const size_t searchedCount,
+                                             const size_t mergeCount)
 {
-    if (stack == NULL || count == NULL || capacity == NULL) { return failure; }
+    size_t depth = 0;
+    for (size_t count = searchedCount; count > 0; count >>= 1) { depth += 1; }
+
+    size_t lookupCost = 0;
+    size_t mergeCost = 0;
+    if (_tsearch_size_mul_overflows(lookupCount, depth, &lookupCost)) { return true; }
+    if (_tsearch_size_mul_overflows(mergeCount, 4, &mergeCost)) { return false; }
+    return lookupCost >= mergeCost;
+}
 
-    if (*count >= *capacity) {
-        size_t newCapacity = 0;
-        size_t byteLength = 0;
 
-        if (*capacity == 0) {
-            newCapacity = 64;
-            if (_tsearch_size_mul_overflows(newCapacity, sizeof(size_t), &byteLength)) {
-                return failure;
+/// Replaces the counted set's contents with the result of merging it with the other set in a
+/// single in-order pass over both. The result is built as a new, balanced tree without any
+/// free nodes. Leaves the counted set unchanged on failure.
+static result _tsearch_countedset_merge(const tsearch_countedset_ptr ptr, const tsearch_countedset_ptr otherPtr,
+                                        const _tsearch_countedset_operation operation)
+{
+    size_t capacity = ptr->count;
+    if (operation == _tsearch_countedset_operation_union &&
+        _tsearch_size_add_overflows(ptr->count, otherPtr->count, &capacity)) {
+        return failure;
+    }
+    if (capacity == 0) { return success; }
+
+    size_t integersByteLength = 0;
+    size_t countsByteLength = 0;
+    if (_tsearch_size_mul_overflows(capacity, sizeof(GNEInteger), &integersByteLength) ||
+        _tsearch_size_mul_overflows(capacity, sizeof(size_t), &countsByteLength)) {
+        return failure;
+    }
+
+    tsearch_countedset_iterator iterator;
+    tsearch_countedset_iterator otherIterator;
+    if (tsearch_countedset_iterator_init(&iterator, ptr) == failure ||
+        tsearch_countedset_iterator_init(&otherIterator, otherPtr) == failure) {
+        return failure;
+    }
+
+    GNEInteger *integers = malloc(integersByteLength);
+    size_t *counts = malloc(countsByteLength);
+    if (integers == NULL || counts == NULL) {
+        free(integers);
+        free(counts);
+        return failure;
+    }
+
+    GNEInteger integer = 0, otherInteger = 0;
+    size_t count = 0, otherCount = 0;
+    bool hasValue = tsearch_countedset_iterator_next(&iterator, &integer, &count);
+    bool hasOtherValue = tsearch_countedset_iterator_next(&otherIterator, &otherInteger, &otherCount);
+    size_t mergedCount = 0;
+    result status = success;
+
+    while (hasValue || hasOtherValue) {
+        // Only unions need the integers left over once one of the sets runs out.
+        if (hasValue == false && operation != _tsearch_countedset_operation_union) { break; }
+        if (hasOtherValue == false && operation == _tsearch_countedset_operation_intersection) { break; }
+
+        if (hasOtherValue == false || (hasValue && integer < otherInteger)) {
+            if (operation != _tsearch_countedset_operation_intersection) {
+                integers[mergedCount] = integer;
+                counts[mergedCount] = count;
+                mergedCount += 1;
+            }
+            hasValue = tsearch_countedset_iterator_next(&iterator, &integer, &count);
+        } else if (hasValue == false || otherInteger < integer) {
+            if (operation == _tsearch_countedset_operation_union) {
+                integers[mergedCount] = otherInteger;
+                counts[mergedCount] = otherCount;
+                mergedCount += 1;
             }
+            hasOtherValue = tsearch_countedset_iterator_next(&otherIterator, &otherInteger, &otherCount);
         } else {
-            newCapacity = *capacity;
-            if (_tsearch_next_buf_len(&newCapacity, sizeof(size_t), &byteLength) == failure) {
-                return failure;
+            if (operation == _tsearch_countedset_operation_minus) {
+                if (count > otherCount) {
+                    integers[mergedCount] = integer;
+                    counts[mergedCount] = count - otherCount;
+                    mergedCount += 1;
+                }
+            } else {
+                size_t mergedValueCount = 0;
+                if (_tsearch_size_add_overflows(count, otherCount, &mergedValueCount) ||
+                    _tsearch_countedset_count_fits(mergedValueCount) == false) {
+                    status = failure;
+                    break;
+                }
+                integers[mergedCount] = integer;
+                counts[mergedCount] = mergedValueCount;
+                mergedCount += 1;
             }
+            hasValue = tsearch_countedset_iterator_next(&iterator, &integer, &count);
+            hasOtherValue = tsearch_countedset_iterator_next(&otherIterator, &otherInteger, &otherCount);
         }
+    }
 
-        size_t *newStack = realloc(*stack, byteLength);
-        if (newStack == NULL) { return failure; }
+    tsearch_countedset_ptr merged = NULL;
+    if (status == success) {
+        merged = _tsearch_countedset_init_with_sorted_ints(integers, counts, mergedCount);
+    }
+    free(integers);
+    free(counts);
+    if (merged == NULL) { return failure; }
+
+    _tsearch_countedset_swap_contents(ptr, merged);
+    tsearch_countedset_free(merged);
+    return success;
+}
+
+
+/// Intersects sets of very different sizes by walking the smaller set in order and seeking each of
+/// its integers in the larger set, which skips over most of the larger set. This takes about
+/// O(n log(m / n)) time for sets of n and m integers instead of O(n + m). Leaves the counted set
+/// unchanged on failure.
+static result _tsearch_countedset_intersect_skewed(const tsearch_countedset_ptr ptr,
+                                                   const tsearch_countedset_ptr otherPtr)
+{
+    bool isSmaller = (ptr->count <= otherPtr->count);
+    tsearch_countedset_ptr smallerPtr = (isSmaller) ? ptr : otherPtr;
+    tsearch_countedset_ptr largerPtr = (isSmaller) ? otherPtr : ptr;
+
+    size_t capacity = smallerPtr->count;
+    if (capacity == 0) { return tsearch_countedset_remove_all_ints(ptr); }
+
+    size_t integersByteLength = 0;
+    size_t countsByteLength = 0;
+    if (_tsearch_size_mul_overflows(capacity, sizeof(GNEInteger), &integersByteLength) ||
+        _tsearch_size_mul_overflows(capacity, sizeof(size_t), &countsByteLength)) {
+        return failure;
+    }
+
+    tsearch_countedset_iterator iterator;
+    tsearch_countedset_iterator largerIterator;
+    if (tsearch_countedset_iterator_init(&iterator, smallerPtr) == failure ||
+        tsearch_countedset_iterator_init(&largerIterator, largerPtr) == failure) {
+        return failure;
+    }
+
+    GNEInteger *integers = malloc(integersByteLength);
+    size_t *counts = malloc(countsByteLength);
+    if (integers == NULL || counts == NULL) {
+        free(integers);
+        free(counts);
+        return failure;
+    }
+
+    GNEInteger integer = 0, largerInteger = 0;
+    size_t count = 0, largerCount = 0;
+    bool hasValue = tsearch_countedset_iterator_next(&iterator, &integer, &count);
+    bool hasLargerValue = tsearch_countedset_iterator_next(&largerIterator, &largerInteger, &largerCount);
+    size_t intersectedCount = 0;
+    result status = success;
+
+    while (hasValue && hasLargerValue) {
+        if (integer < largerInteger) {
+            hasValue = tsearch_countedset_iterator_next(&iterator, &integer, &count);
+        } else if (integer > largerInteger) {
+            hasLargerValue = _tsearch_countedset_iterator_seek(&largerIterator, integer,
+                                                               &largerInteger, &largerCount);
+        } else {
+            size_t intersectedValueCount = 0;
+            if (_tsearch_size_add_overflows(count, largerCount, &intersectedValueCount) ||
+                _tsearch_countedset_count_fits(intersectedValueCount) == false) {
+                status = failure;
+                break;
+            }
+            integers[intersectedCount] = integer;
+            counts[intersectedCount] = intersectedValueCount;
+            intersectedCount += 1;
+            hasValue = tsearch_countedset_iterator_next(&iterator, &integer, &count);
+        }
+    }
 
-        *stack = newStack;
-        *capacity = newCapacity;
+    tsearch_countedset_ptr intersected = NULL;
+    if (status == success) {
+        intersected = _tsearch_countedset_init_with_sorted_ints(integers, counts, intersectedCount);
     }
+    free(integers);
+    free(counts);
+    if (intersected == NULL) { return failure; }
 
-    (*stack)[*count] = index;
-    *count += 1;
+    _tsearch_countedset_swap_contents(ptr, intersected);
+    tsearch_countedset_free(intersected);
     return success;
 }
+
+
+/// Adds up the counts of the sets' integers, which all lie within span integers of the minimum, in
+/// an array indexed by integer. The order the nodes are visited in doesn't matter, so each set's
+/// nodes are read straight through. Scanning the array then yields the integers in order.
+static tsearch_countedset_ptr _tsearch_countedset_init_with_dense_union(const tsearch_countedset_ptr *sets,
+                                                                       const size_t setsCount,
+                                                                       const GNEInteger minimum,
+                                                                       const size_t span)
+{
+    size_t *counts = calloc(span, sizeof(size_t));
+    if (counts == NULL) { return NULL; }
+
+    size_t uniqueCount = 0;
+    for (size_t i = 0; i < setsCount; i++) {
+        tsearch_countedset_ptr ptr = sets[i];
+        if (ptr == NULL || ptr->nodes == NULL) { continue; }
+
+        for (size_t j = 0; j < ptr->insertIndex; j++) {
+            _tsearch_countedset_node *nodePtr = &(ptr->nodes[j]);
+            if (nodePtr->count == 0) { continue; }
+
+            size_t offset = (size_t)((uint64_t)nodePtr->integer - (uint64_t)minimum);
+            size_t sum = 0;
+            if (_tsearch_size_add_overflows(counts[offset], nodePtr->count, &sum) ||
+                _tsearch_countedset_count_fits(sum) == false) {
+                free(counts);
+                return NULL;
+            }
+            if (counts[offset] == 0) { uniqueCount += 1; }
+            counts[offset] = sum;
+        }
+    }
+
+    size_t byteLength = 0;
+    if (_tsearch_size_mul_overflows(uniqueCount, sizeof(GNEInteger), &byteLength)) {
+        free(counts);
+        return NULL;
+    }
+
+    GNEInteger *integers = malloc(byteLength);
+    if (integers == NULL) { free(counts); return NULL; }
+
+    // The counts are packed at the front of the array, which never overtakes the offset being read.
+    size_t index = 0;
+    for (size_t offset = 0; offset < span; offset++) {
+        if (counts[offset] == 0) { continue; }
+        integers[index] = (GNEInteger)((uint64_t)minimum + offset);
+        counts[index] = counts[offset];
+        index += 1;
+    }
+
+    tsearch_countedset_ptr ptr = _tsearch_countedset_init_with_sorted_ints(integers, counts, uniqueCount);
+    free(integers);
+    free(counts);
+    return ptr;
+}
+
+
+/// Copies each set's integers out in order as a sorted run and merges the runs with a heap holding
+/// the next integer of each run. Equal integers come out of the heap one after another, so their
+/// counts are added together as they're written. Takes O(n log k) time for n integers in k sets.
+static tsearch_countedset_ptr _tsearch_countedset_init_with_merged_union(const tsearch_countedset_ptr *sets,
+                                                                        const size_t setsCount,
+                                                                        const size_t totalCount)
+{
+    // The runs fill the first half of each array and the merged integers the second.
+    size_t bufferCount = 0;
+    size_t integersByteLength = 0;
+    size_t countsByteLength = 0;
+    size_t heapByteLength = 0;
+    if (_tsearch_size_mul_overflows(totalCount, 2, &bufferCount) ||
+        _tsearch_size_mul_overflows(bufferCount, sizeof(GNEInteger), &integersByteLength) ||
+        _tsearch_size_mul_overflows(bufferCount, sizeof(size_t), &countsByteLength) ||
+        _tsearch_size_mul_overflows(setsCount, sizeof(_tsearch_countedset_merge_run), &heapByteLength)) {
+        return NULL;
+    }
+
+    GNEInteger *integers = malloc(integersByteLength);
+    size_t *counts = malloc(countsByteLength);
+    _tsearch_countedset_merge_run *heap = malloc(heapByteLength);
+    if (integers == NULL || counts == NULL || heap == NULL) {
+        free(integers);
+        free(counts);
+        free(heap);
+        return NULL;
+    }
+
+    size_t heapCount = 0;
+    size_t position = 0;
+    for (size_t i = 0; i < setsCount; i++) {
+        if (sets[i] == NULL || sets[i]->nodes == NULL || sets[i]->count == 0) { continue; }
+
+        tsearch_countedset_iterator iterator;
+        if (tsearch_countedset_iterator_init(&iterator, sets[i]) == failure) {
+            free(integers);
+            free(counts);
+            free(heap);
+            return NULL;
+        }
+
+        size_t start = position;
+        while (position < totalCount &&
+               tsearch_countedset_iterator_next(&iterator, &(integers[position]), &(counts[position]))) {
+            position += 1;
+        }
+        heap[heapCount] = (_tsearch_countedset_merge_run){integers[start], start, position};
+        heapCount += 1;
+    }
+    for (size_t i = heapCount / 2; i > 0; i--) {
+        _tsearch_countedset_merge_run_sift_down(heap, heapCount, i - 1);
+    }
+
+    GNEInteger *mergedIntegers = &(integers[totalCount]);
+    size_t *mergedCounts = &(counts[totalCount]);
+    size_t mergedCount = 0;
+    result status = success;
+    while (heapCount > 0) {
+        _tsearch_countedset_merge_run *run = &(heap[0]);
+        size_t count = counts[run->position];
+        if (mergedCount > 0 && mergedIntegers[mergedCount - 1] == run->integer) {
+            size_t sum = 0;
+            if (_tsearch_size_add_overflows(mergedCounts[mergedCount - 1], count, &sum) ||
+                _tsearch_countedset_count_fits(sum) == false) {
+                status = failure;
+                break;
+            }
+            mergedCounts[mergedCount - 1] = sum;
+        } else {
+            mergedIntegers[mergedCount] = run->integer;
+            mergedCounts[mergedCount] = count;
+            mergedCount += 1;
+        }
+
+        run->position += 1;
+        if (run->position < run->end) {
+            run->integer = integers[run->position];
+        } else {
+            heapCount -= 1;
+            heap[0] = heap[heapCount];
+        }
+        _tsearch_countedset_merge_run_sift_down(heap, heapCount, 0);
+    }
+
+    tsearch_countedset_ptr ptr = NULL;
+    if (status == success) {
+        ptr = _tsearch_countedset_init_with_sorted_ints(mergedIntegers, mergedCounts, mergedCount);
+    }
+    free(integers);
+    free(counts);
+    free(heap);
+    return ptr;
+}
+
+
+static void _tsearch_countedset_merge_run_sift_down(_tsearch_countedset_merge_run *heap, const size_t count,
+                                                    size_t index)
+{
+    if (heap == NULL || index >= count) { return; }
+
+    _tsearch_countedset_merge_run run = heap[index];
+    while (true) {
+        size_t child = (index * 2) + 1;
+        if (child >= count) { break; }
+        if (child + 1 < count && heap[child + 1].integer < heap[child].integer) { child += 1; }
+        if (heap[child].integer >= run.integer) { break; }
+        heap[index] = heap[child];
+        index = child;
+    }
+    heap[index] = run;
+}
+
+
+/// Lays out the nodes of a balanced tree holding the sorted integers in pre-order, so that the
+/// root is at index 0 and each node's left subtree immediately follows it.
+static void _tsearch_countedset_build_balanced_nodes(_tsearch_countedset_node *nodes, const GNEInteger *integers,
+                                                     const size_t *counts, const size_t count)
+{
+    // At most one right subtree per level is waiting to be built.
+    _tsearch_countedset_range stack[TSEARCH_COUNTEDSET_MAX_HEIGHT];
+    size_t stackCount = 0;
+    stack[stackCount++] = (_tsearch_countedset_range){0, count, 0};
+
+    while (stackCount > 0) {
+        stackCount -= 1;
+        _tsearch_countedset_range range = stack[stackCount];
+        size_t leftLength = range.length / 2;
+        size_t rightLength = range.length - leftLength - 1;
+        size_t middle = range.location + leftLength;
+
+        _tsearch_countedset_node *nodePtr = &(nodes[range.index]);
+        nodePtr->integer = integers[middle];
+        nodePtr->count = (counts == NULL) ? 1 : counts[middle];
+        nodePtr->balance = _tsearch_countedset_height_for_count(range.length);
+        nodePtr->left = (leftLength > 0) ? range.index + 1 : TSEARCH_COUNTEDSET_NO_INDEX;
+        nodePtr->right = (rightLength > 0) ? range.index + 1 + leftLength : TSEARCH_COUNTEDSET_NO_INDEX;
+
+        if (rightLength > 0) {
+            stack[stackCount++] = (_tsearch_countedset_range){middle + 1, rightLength, range.index + 1 + leftLength};
+        }
+        if (leftLength > 0) {
+            stack[stackCount++] = (_tsearch_countedset_range){range.location, leftLength, range.index + 1};
+        }
+    }
+}
+
+
+static bool _tsearch_countedset_count_fits(const size_t count)
+{
+#ifdef TSEARCH_COUNTEDSET_COMPACT_NODES
+    return count <= TSEARCH_COUNTEDSET_MAX_COUNT;
+#else
+    (void)count;
+    return true;
+#endif
+}
+
+
+/// Sorts the integers in ascending order with a least significant digit radix sort, one byte at a
+/// time. The histograms for every byte are counted in a single pass, and bytes that are the same
+/// in every integer are skipped, so small integers only need a few passes.
+static void _tsearch_countedset_radix_sort(GNEInteger *integers, GNEInteger *buffer, const size_t count)
+{
+    // Flipping the sign bit orders negative integers before positive ones when compared unsigned.
+    const uint64_t signBit = UINT64_C(1) << 63;
+    size_t histograms[sizeof(GNEInteger)][256];
+    memset(histograms, 0, sizeof(histograms));
+
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = (uint64_t)integers[i] ^ signBit;
+        for (size_t byte = 0; byte < sizeof(GNEInteger); byte++) {
+            histograms[byte][(key >> (byte * 8)) & 0xFF] += 1;
+        }
+    }
+
+    GNEInteger *source = integers;
+    GNEInteger *destination = buffer;
+    for (size_t byte = 0; byte < sizeof(GNEInteger); byte++) {
+        size_t *histogram = histograms[byte];
+        uint64_t firstKey = (uint64_t)source[0] ^ signBit;
+        if (histogram[(firstKey >> (byte * 8)) & 0xFF] == count) { continue; }
+
+        size_t offset = 0;
+        for (size_t digit = 0; digit < 256; digit++) {
+            size_t digitCount = histogram[digit];
+            histogram[digit] = offset;
+            offset += digitCount;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            uint64_t key = (uint64_t)source[i] ^ signBit;
+            size_t digit = (key >> (byte * 8)) & 0xFF;
+            destination[histogram[digit]] = source[i];
+            histogram[digit] += 1;
+        }
+
+        GNEInteger *swap = source;
+        source = destination;
+        destination = swap;
+    }
+
+    if (source != integers) { memcpy(integers, source, count * sizeof(GNEInteger)); }
+}
+
+
+/// Splitting at the middle integer gives a tree of count nodes the height of a complete binary tree.
+static int _tsearch_countedset_height_for_count(size_t count)
+{
+    int height = 0;
+    for (; count > 0; count >>= 1) { height += 1; }
+    return height;
+}
+
+
+/// Returns true if the node should be returned before the other node by
+/// tsearch_countedset_copy_top_ints(), which is the same order _tsearch_countedset_compare() sorts by.
+static bool _tsearch_countedset_node_ranks_before(const _tsearch_countedset_node *node,
+                                                  const _tsearch_countedset_node *otherNode)
+{
+    if (node->count != otherNode->count) { return node->count > otherNode->count; }
+    return node->integer < otherNode->integer;
+}
+
+
+/// Restores the heap below the specified index so that every node ranks after its children.
+static void _tsearch_countedset_heap_sift_down(_tsearch_countedset_node *heap, const size_t count, size_t index)
+{
+    while (true) {
+        size_t lowestIndex = index;
+        size_t leftIndex = (2 * index) + 1;
+        size_t rightIndex = leftIndex + 1;
+        if (leftIndex < count && _tsearch_countedset_node_ranks_before(&(heap[lowestIndex]), &(heap[leftIndex]))) {
+            lowestIndex = leftIndex;
+        }
+        if (rightIndex < count && _tsearch_countedset_node_ranks_before(&(heap[lowestIndex]), &(heap[rightIndex]))) {
+            lowestIndex = rightIndex;
+        }
+        if (lowestIndex == index) { return; }
+
+        _tsearch_countedset_node node = heap[index];
+        heap[index] = heap[lowestIndex];
+        heap[lowestIndex] = node;
+        index = lowestIndex;
+    }
+}
@@ -0,0 +1,53 @@
+//
+//  CountedSetPrivate.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_countedset_private_h
+#define tsearch_countedset_private_h
+
+#include <GNETextSearch/CountedSet.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Skips the integers less than the specified integer and then behaves like
+/// tsearch_countedset_iterator_next(). Rather than visiting the skipped integers, the iterator
+/// climbs back up only as far as it has to and then descends to the integer, which makes a seek
+/// the tree equivalent of a galloping search over a sorted array.
+bool _tsearch_countedset_iterator_seek(tsearch_countedset_iterator *iterator, const GNEInteger integer,
+                                       GNEInteger *outInteger, size_t *outCount);
+
+/// Creates a balanced counted set from count integers, which must be in strictly ascending order,
+/// and their counts, which must not be 0. Pass NULL counts to give every integer a count of 1.
+/// Runs in O(n) and makes a single allocation for the nodes. Returns NULL on failure.
+tsearch_countedset_ptr _tsearch_countedset_init_with_sorted_ints(const GNEInteger *integers,
+                                                                 const size_t *counts,
+                                                                 const size_t count);
+
+/// Creates a counted set holding every integer in the sets with the sum of its counts, like a series
+/// of tsearch_countedset_union() calls, but in a single pass over the sets followed by building the
+/// result directly from the sorted integers. NULL sets are skipped. Returns NULL on failure,
+/// including when a count would overflow.
+tsearch_countedset_ptr _tsearch_countedset_init_with_union_of_sets(const tsearch_countedset_ptr *sets,
+                                                                   const size_t setsCount);
+
+/// Adds countToAdd to the count of the specified integer. If the count would overflow, returns
+/// failure and leaves the count unchanged.
+result _tsearch_countedset_add_int(const tsearch_countedset_ptr ptr,
+                                   const GNEInteger newInteger, const size_t countToAdd);
+
+/// Removes each integer in the other counted set from the specified set, regardless of either
+/// integer's count. Unlike tsearch_countedset_minus(), which subtracts the other set's counts, the
+/// integers are removed outright, and the loop runs over whichever of the two sets is smaller.
+result _tsearch_countedset_remove_ints_in_set(const tsearch_countedset_ptr ptr, const tsearch_countedset_ptr otherPtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_countedset_private_h */
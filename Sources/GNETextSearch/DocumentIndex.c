@@ -0,0 +1,72 @@
+//
+//  DocumentIndex.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include "DocumentIndex.h"
+#include "GNETextSearchPrivate.h"
+#include "NodeTable.h"
+
+// ------------------------------------------------------------------------------------------
+
+struct _tsearch_documentindex
+{
+    _tsearch_hashtable table; // Each slot is a _tsearch_nodetable_slot keyed by document ID.
+};
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Document Index
+// ------------------------------------------------------------------------------------------
+_tsearch_documentindex * _tsearch_documentindex_init(void)
+{
+    _tsearch_documentindex *index = calloc(1, sizeof(_tsearch_documentindex));
+    if (index == NULL) { return NULL; }
+    if (_tsearch_nodetable_init(&(index->table)) == failure) { free(index); return NULL; }
+    return index;
+}
+
+
+void _tsearch_documentindex_free(_tsearch_documentindex *index)
+{
+    if (index == NULL) { return; }
+    _tsearch_nodetable_free(&(index->table));
+    free(index);
+}
+
+
+size_t _tsearch_documentindex_get_count(const _tsearch_documentindex *index)
+{
+    return (index == NULL) ? 0 : index->table.count;
+}
+
+
+result _tsearch_documentindex_add(_tsearch_documentindex *index, const GNEInteger documentID, void *node)
+{
+    if (index == NULL || node == NULL) { return failure; }
+
+    size_t slotIndex = 0;
+    _tsearch_nodetable_slot *slot = _tsearch_nodetable_find(&(index->table), (uint64_t)documentID, &slotIndex);
+    if (slot->nodes != NULL) { return _tsearch_nodetable_slot_insert(slot, slot->count, node); }
+    return _tsearch_nodetable_add(&(index->table), (uint64_t)documentID, node);
+}
+
+
+void _tsearch_documentindex_take(_tsearch_documentindex *index, const GNEInteger documentID,
+                                 void ***outNodes, size_t *outCount)
+{
+    if (outNodes == NULL || outCount == NULL) { return; }
+    *outNodes = NULL;
+    *outCount = 0;
+    if (index == NULL) { return; }
+
+    size_t slotIndex = 0;
+    _tsearch_nodetable_slot *slot = _tsearch_nodetable_find(&(index->table), (uint64_t)documentID, &slotIndex);
+    if (slot->nodes == NULL) { return; }
+
+    *outNodes = slot->nodes;
+    *outCount = slot->count;
+    _tsearch_hashtable_remove(&(index->table), slotIndex);
+}
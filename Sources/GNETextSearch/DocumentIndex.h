@@ -0,0 +1,41 @@
+//
+//  DocumentIndex.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_documentindex_h
+#define tsearch_documentindex_h
+
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A hash table mapping document IDs to the nodes of the words they contain. The index doesn't
+/// know anything about the nodes, so it stores them as opaque pointers and never dereferences them.
+typedef struct _tsearch_documentindex _tsearch_documentindex;
+
+_tsearch_documentindex * _tsearch_documentindex_init(void);
+void _tsearch_documentindex_free(_tsearch_documentindex *index);
+
+/// Returns the number of documents in the index.
+size_t _tsearch_documentindex_get_count(const _tsearch_documentindex *index);
+
+/// Appends the node to the document's nodes. The caller is responsible for not adding a node to
+/// the same document twice.
+result _tsearch_documentindex_add(_tsearch_documentindex *index, const GNEInteger documentID, void *node);
+
+/// Removes the document from the index and transfers ownership of its nodes to the caller, who
+/// must free outNodes. Writes NULL and 0 if the document isn't in the index.
+void _tsearch_documentindex_take(_tsearch_documentindex *index, const GNEInteger documentID,
+                                 void ***outNodes, size_t *outCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_documentindex_h */
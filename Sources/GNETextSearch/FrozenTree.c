@@ -0,0 +1,639 @@
+//
+//  FrozenTree.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <GNETextSearch/FrozenTree.h>
+#include "FrozenTreePrivate.h"
+#include "CompactNode.h"
+#include "CountedSetPrivate.h"
+#include "GNETextSearchPrivate.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ------------------------------------------------------------------------------------------
+
+#define TSEARCH_FROZENTREE_FILE_VERSION 1
+#define TSEARCH_FROZENTREE_FILE_BYTE_ORDER 0x01020304
+
+/// All of the arrays point into one buffer. The document IDs and counts come first because they
+/// need 8-byte alignment, followed by the postings offsets and then the nodes. Files contain the
+/// same buffer after a header, so trees opened from files search the mapped file in place.
+typedef struct tsearch_frozentree
+{
+    const _tsearch_compact_node *nodes;
+    uint32_t nodeCount;
+    uint32_t postingsCount;
+    uint64_t entryCount;
+    const uint64_t *postingsOffsets; // postingsCount + 1 offsets into documentIDs and counts.
+    const GNEInteger *documentIDs;   // Sorted in ascending order within each word's postings.
+    const uint64_t *counts;
+    const unsigned char *buffer;
+    size_t bufferLength;
+    void *mapping;                   // The mapped file, if the tree was opened from one.
+    size_t mappingLength;
+} tsearch_frozentree;
+
+
+/// Files are written in the byte order of the machine writing them. Readers reject files whose
+/// byte order mark, version, or node size doesn't match their own.
+typedef struct _tsearch_frozentree_file_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeSize;
+    uint32_t nodeCount;
+    uint32_t postingsCount;
+    uint32_t reserved;
+    uint64_t entryCount;
+    uint64_t bufferLength;
+    uint64_t bufferChecksum;
+    uint64_t headerChecksum; // The checksum of all of the bytes before this field.
+} _tsearch_frozentree_file_header;
+
+_Static_assert(sizeof(_tsearch_frozentree_file_header) == 64, "The file header must not contain padding.");
+
+static const char _tsearch_frozentree_file_magic[8] = {'G', 'N', 'E', 'T', 'S', 'I', 'D', 'X'};
+
+
+typedef struct _tsearch_frozentree_posting
+{
+    GNEInteger documentID;
+    size_t count;
+} _tsearch_frozentree_posting;
+
+// ------------------------------------------------------------------------------------------
+
+static bool _tsearch_cstring_is_nonempty(const char *string);
+static result _tsearch_frozentree_get_buffer_len(const uint32_t nodeCount, const uint32_t postingsCount,
+                                                 const uint64_t entryCount, size_t *outLength);
+static void _tsearch_frozentree_set_buffer(const tsearch_frozentree_ptr ptr, const unsigned char *buffer,
+                                           const size_t bufferLength, const uint32_t nodeCount,
+                                           const uint32_t postingsCount, const uint64_t entryCount);
+static result _tsearch_frozentree_validate_file_header(const _tsearch_frozentree_file_header *header,
+                                                       const size_t fileLength);
+static uint64_t _tsearch_frozentree_checksum(const void *bytes, const size_t length);
+static void * _tsearch_frozentree_map_file(const char *path, size_t *outLength);
+static void _tsearch_frozentree_unmap_file(void *mapping, const size_t length);
+static _tsearch_compact_view _tsearch_frozentree_view(const tsearch_frozentree_ptr ptr);
+static bool _tsearch_frozentree_has_postings(const void *postings, const uint32_t postingsID);
+static result _tsearch_frozentree_union_postings(const void *postings, const uint32_t postingsID,
+                                                 tsearch_countedset_ptr results);
+static tsearch_countedset_ptr _tsearch_frozentree_get_postings(const tsearch_countedset_ptr *postings,
+                                                               const uint32_t postingsCount,
+                                                               const uint32_t postingsID);
+static result _tsearch_frozentree_copy_sorted_postings(const tsearch_countedset_ptr documentIDs,
+                                                       _tsearch_frozentree_posting **buffer,
+                                                       size_t *capacity,
+                                                       size_t *outCount);
+static int _tsearch_frozentree_posting_compare(const void *valuePtr1, const void *valuePtr2);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Frozen Tree
+// ------------------------------------------------------------------------------------------
+void tsearch_frozentree_free(const tsearch_frozentree_ptr ptr)
+{
+    if (ptr == NULL) { return; }
+
+    if (ptr->mapping != NULL) {
+        _tsearch_frozentree_unmap_file(ptr->mapping, ptr->mappingLength);
+    } else {
+        free((void *)ptr->buffer);
+    }
+    ptr->mapping = NULL;
+    ptr->mappingLength = 0;
+    ptr->buffer = NULL;
+    ptr->bufferLength = 0;
+    ptr->nodes = NULL;
+    ptr->nodeCount = 0;
+    ptr->postingsCount = 0;
+    ptr->entryCount = 0;
+    ptr->postingsOffsets = NULL;
+    ptr->documentIDs = NULL;
+    ptr->counts = NULL;
+    free(ptr);
+}
+
+
+size_t tsearch_frozentree_get_node_count(const tsearch_frozentree_ptr ptr)
+{
+    return (ptr == NULL) ? 0 : (size_t)ptr->nodeCount;
+}
+
+
+result tsearch_frozentree_write_file(const tsearch_frozentree_ptr ptr, const char *path)
+{
+    if (ptr == NULL || path == NULL) { return failure; }
+
+    _tsearch_frozentree_file_header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, _tsearch_frozentree_file_magic, sizeof(header.magic));
+    header.version = TSEARCH_FROZENTREE_FILE_VERSION;
+    header.byteOrder = TSEARCH_FROZENTREE_FILE_BYTE_ORDER;
+    header.nodeSize = (uint32_t)sizeof(_tsearch_compact_node);
+    header.nodeCount = ptr->nodeCount;
+    header.postingsCount = ptr->postingsCount;
+    header.entryCount = ptr->entryCount;
+    header.bufferLength = (uint64_t)ptr->bufferLength;
+    header.bufferChecksum = _tsearch_frozentree_checksum(ptr->buffer, ptr->bufferLength);
+    header.headerChecksum = _tsearch_frozentree_checksum(&header, offsetof(_tsearch_frozentree_file_header,
+                                                                           headerChecksum));
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL) { return failure; }
+
+    result ret = success;
+    if (fwrite(&header, sizeof(header), 1, file) != 1 ||
+        (ptr->bufferLength > 0 && fwrite(ptr->buffer, ptr->bufferLength, 1, file) != 1)) {
+        ret = failure;
+    }
+
+    if (fclose(file) != 0) { ret = failure; }
+    return ret;
+}
+
+
+tsearch_frozentree_ptr tsearch_frozentree_init_with_file(const char *path, const bool shouldVerifyChecksum)
+{
+    if (path == NULL) { return NULL; }
+
+    size_t mappingLength = 0;
+    unsigned char *mapping = _tsearch_frozentree_map_file(path, &mappingLength);
+    if (mapping == NULL) { return NULL; }
+
+    const _tsearch_frozentree_file_header *header = (const _tsearch_frozentree_file_header *)mapping;
+    const unsigned char *buffer = mapping + sizeof(_tsearch_frozentree_file_header);
+    size_t bufferLength = mappingLength - sizeof(_tsearch_frozentree_file_header);
+
+    tsearch_frozentree_ptr ptr = NULL;
+    if (_tsearch_frozentree_validate_file_header(header, mappingLength) == success &&
+        (shouldVerifyChecksum == false ||
+         _tsearch_frozentree_checksum(buffer, bufferLength) == header->bufferChecksum)) {
+        ptr = calloc(1, sizeof(tsearch_frozentree));
+    }
+
+    if (ptr == NULL) {
+        _tsearch_frozentree_unmap_file(mapping, mappingLength);
+        return NULL;
+    }
+
+    _tsearch_frozentree_set_buffer(ptr, buffer, bufferLength,
+                                   header->nodeCount, header->postingsCount, header->entryCount);
+    ptr->mapping = mapping;
+    ptr->mappingLength = mappingLength;
+
+    // The postings offsets are bounds checked against the entry count when they are read, but
+    // a file whose offsets don't start at 0 and end at the entry count was never a valid tree.
+    if (ptr->postingsOffsets[0] != 0 || ptr->postingsOffsets[ptr->postingsCount] != ptr->entryCount) {
+        tsearch_frozentree_free(ptr);
+        return NULL;
+    }
+
+    return ptr;
+}
+
+
+tsearch_countedset_ptr tsearch_frozentree_copy_search_results(const tsearch_frozentree_ptr ptr, const char *target)
+{
+    if (ptr == NULL || !_tsearch_cstring_is_nonempty(target)) { return NULL; }
+    _tsearch_compact_view view = _tsearch_frozentree_view(ptr);
+    return _tsearch_compact_copy_search_results(&view, target);
+}
+
+
+tsearch_countedset_ptr tsearch_frozentree_copy_prefix_search_results(const tsearch_frozentree_ptr ptr,
+                                                                     const char *prefix)
+{
+    if (ptr == NULL || !_tsearch_cstring_is_nonempty(prefix)) { return NULL; }
+    _tsearch_compact_view view = _tsearch_frozentree_view(ptr);
+    return _tsearch_compact_copy_prefix_search_results(&view, prefix);
+}
+
+
+tsearch_countedset_ptr tsearch_frozentree_copy_partial_search_results(const tsearch_frozentree_ptr ptr,
+                                                                      const char *target,
+                                                                      const size_t length)
+{
+    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    _tsearch_compact_view view = _tsearch_frozentree_view(ptr);
+    return _tsearch_compact_copy_partial_search_results(&view, target, length);
+}
+
+
+tsearch_countedset_ptr tsearch_frozentree_copy_subsequence_search_results(const tsearch_frozentree_ptr ptr,
+                                                                          const char *target,
+                                                                          const size_t length)
+{
+    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    _tsearch_compact_view view = _tsearch_frozentree_view(ptr);
+    return _tsearch_compact_copy_subsequence_search_results(&view, target, length);
+}
+
+
+tsearch_countedset_ptr tsearch_frozentree_copy_suffix_search_results(const tsearch_frozentree_ptr ptr,
+                                                                     const char *suffix,
+                                                                     const size_t length)
+{
+    if (ptr == NULL || suffix == NULL || length == 0) { return NULL; }
+    _tsearch_compact_view view = _tsearch_frozentree_view(ptr);
+    return _tsearch_compact_copy_suffix_search_results(&view, suffix, length);
+}
+
+
+result tsearch_frozentree_copy_contents(const tsearch_frozentree_ptr ptr, char **outResults, size_t *outLength)
+{
+    if (outResults == NULL || outLength == NULL) { return failure; }
+    *outResults = NULL;
+    *outLength = 0;
+
+    if (ptr == NULL) { return failure; }
+
+    _tsearch_compact_view view = _tsearch_frozentree_view(ptr);
+    return _tsearch_compact_copy_contents(&view, outResults, outLength);
+}
+
+
+void tsearch_frozentree_print(const tsearch_frozentree_ptr ptr)
+{
+    char *results = NULL;
+    size_t length = 0;
+
+    printf("<GNEFrozenTree, %p>\n", (void *)ptr);
+    if (tsearch_frozentree_copy_contents(ptr, &results, &length) == success && results != NULL) {
+        printf("%s\n", results);
+    } else {
+        printf("\n");
+    }
+
+    free(results);
+    results = NULL;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Building
+// ------------------------------------------------------------------------------------------
+tsearch_frozentree_ptr _tsearch_frozentree_init_with_nodes(const _tsearch_compact_node *nodes,
+                                                           const uint32_t nodeCount,
+                                                           const tsearch_countedset_ptr *postings,
+                                                           const uint32_t postingsCount)
+{
+    if (nodeCount > 0 && nodes == NULL) { return NULL; }
+    if (nodeCount == TSEARCH_COMPACT_NONE) { return NULL; }
+
+    // The first pass sizes the buffer. Postings are renumbered in node order, so the postings of
+    // neighboring words are next to each other, too.
+    uint32_t frozenPostingsCount = 0;
+    size_t entryCount = 0;
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        tsearch_countedset_ptr documentIDs = _tsearch_frozentree_get_postings(postings, postingsCount,
+                                                                             nodes[i].postingsID);
+        if (documentIDs == NULL) { continue; }
+        frozenPostingsCount += 1;
+        if (_tsearch_size_add_overflows(entryCount, tsearch_countedset_get_count(documentIDs), &entryCount)) {
+            return NULL;
+        }
+    }
+
+    size_t bufferLength = 0;
+    if (_tsearch_frozentree_get_buffer_len(nodeCount, frozenPostingsCount, entryCount, &bufferLength) == failure) {
+        return NULL;
+    }
+
+    tsearch_frozentree_ptr ptr = calloc(1, sizeof(tsearch_frozentree));
+    if (ptr == NULL) { return NULL; }
+
+    // The buffer is zeroed so that the nodes' padding bytes are written to files deterministically.
+    unsigned char *buffer = calloc(1, bufferLength);
+    if (buffer == NULL) { free(ptr); return NULL; }
+
+    _tsearch_frozentree_set_buffer(ptr, buffer, bufferLength, nodeCount, frozenPostingsCount, entryCount);
+    GNEInteger *documentIDs = (GNEInteger *)ptr->documentIDs;
+    uint64_t *counts = (uint64_t *)ptr->counts;
+    uint64_t *postingsOffsets = (uint64_t *)ptr->postingsOffsets;
+    _tsearch_compact_node *frozenNodes = (_tsearch_compact_node *)ptr->nodes;
+
+    _tsearch_frozentree_posting *sorted = NULL;
+    size_t sortedCapacity = 0;
+    uint32_t postingsID = 0;
+    size_t offset = 0;
+    postingsOffsets[0] = 0;
+
+    for (uint32_t i = 0; i < nodeCount; i++) {
+        frozenNodes[i].lower = nodes[i].lower;
+        frozenNodes[i].same = nodes[i].same;
+        frozenNodes[i].higher = nodes[i].higher;
+        frozenNodes[i].postingsID = TSEARCH_COMPACT_NONE;
+        frozenNodes[i].character = nodes[i].character;
+
+        tsearch_countedset_ptr wordIDs = _tsearch_frozentree_get_postings(postings, postingsCount,
+                                                                         nodes[i].postingsID);
+        if (wordIDs == NULL) { continue; }
+
+        size_t sortedCount = 0;
+        if (_tsearch_frozentree_copy_sorted_postings(wordIDs, &sorted, &sortedCapacity, &sortedCount) == failure ||
+            sortedCount > entryCount - offset) {
+            free(sorted);
+            free(buffer);
+            free(ptr);
+            return NULL;
+        }
+
+        for (size_t j = 0; j < sortedCount; j++) {
+            documentIDs[offset + j] = sorted[j].documentID;
+            counts[offset + j] = (uint64_t)sorted[j].count;
+        }
+        offset += sortedCount;
+
+        frozenNodes[i].postingsID = postingsID;
+        postingsID += 1;
+        postingsOffsets[postingsID] = (uint64_t)offset;
+    }
+
+    free(sorted);
+    return ptr;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+static bool _tsearch_cstring_is_nonempty(const char *string)
+{
+    return (string != NULL && string[0] != '\0');
+}
+
+
+/// Computes the length of a buffer holding the specified number of nodes, postings, and entries.
+/// Fails if the length doesn't fit in a size_t.
+static result _tsearch_frozentree_get_buffer_len(const uint32_t nodeCount, const uint32_t postingsCount,
+                                                 const uint64_t entryCount, size_t *outLength)
+{
+    if (outLength == NULL) { return failure; }
+    *outLength = 0;
+#if SIZE_MAX < UINT64_MAX
+    if (entryCount > SIZE_MAX) { return failure; }
+#endif
+
+    size_t entriesLength = 0, offsetsLength = 0, nodesLength = 0, bufferLength = 0;
+    if (_tsearch_size_mul_overflows((size_t)entryCount, sizeof(uint64_t), &entriesLength) ||
+        _tsearch_size_mul_overflows((size_t)postingsCount + 1, sizeof(uint64_t), &offsetsLength) ||
+        _tsearch_size_mul_overflows(nodeCount, sizeof(_tsearch_compact_node), &nodesLength) ||
+        _tsearch_size_add_overflows(entriesLength, entriesLength, &bufferLength) ||
+        _tsearch_size_add_overflows(bufferLength, offsetsLength, &bufferLength) ||
+        _tsearch_size_add_overflows(bufferLength, nodesLength, &bufferLength)) {
+        return failure;
+    }
+
+    *outLength = bufferLength;
+    return success;
+}
+
+
+/// Points the tree's arrays into the buffer. The buffer must be at least as long as
+/// _tsearch_frozentree_get_buffer_len() returns for the counts.
+static void _tsearch_frozentree_set_buffer(const tsearch_frozentree_ptr ptr, const unsigned char *buffer,
+                                           const size_t bufferLength, const uint32_t nodeCount,
+                                           const uint32_t postingsCount, const uint64_t entryCount)
+{
+    size_t entriesLength = (size_t)entryCount * sizeof(uint64_t);
+    size_t offsetsLength = ((size_t)postingsCount + 1) * sizeof(uint64_t);
+
+    ptr->documentIDs = (const GNEInteger *)buffer;
+    ptr->counts = (const uint64_t *)(buffer + entriesLength);
+    ptr->postingsOffsets = (const uint64_t *)(buffer + entriesLength * 2);
+    ptr->nodes = (const _tsearch_compact_node *)(buffer + entriesLength * 2 + offsetsLength);
+    ptr->nodeCount = nodeCount;
+    ptr->postingsCount = postingsCount;
+    ptr->entryCount = entryCount;
+    ptr->buffer = buffer;
+    ptr->bufferLength = bufferLength;
+}
+
+
+static result _tsearch_frozentree_validate_file_header(const _tsearch_frozentree_file_header *header,
+                                                       const size_t fileLength)
+{
+    if (header == NULL || fileLength < sizeof(_tsearch_frozentree_file_header)) { return failure; }
+
+    uint64_t headerChecksum = _tsearch_frozentree_checksum(header, offsetof(_tsearch_frozentree_file_header,
+                                                                            headerChecksum));
+    if (memcmp(header->magic, _tsearch_frozentree_file_magic, sizeof(header->magic)) != 0 ||
+        header->version != TSEARCH_FROZENTREE_FILE_VERSION ||
+        header->byteOrder != TSEARCH_FROZENTREE_FILE_BYTE_ORDER ||
+        header->nodeSize != sizeof(_tsearch_compact_node) ||
+        header->headerChecksum != headerChecksum ||
+        header->nodeCount == TSEARCH_COMPACT_NONE ||
+        header->postingsCount == TSEARCH_COMPACT_NONE) {
+        return failure;
+    }
+
+    size_t bufferLength = 0;
+    if (_tsearch_frozentree_get_buffer_len(header->nodeCount, header->postingsCount, header->entryCount,
+                                           &bufferLength) == failure ||
+        header->bufferLength != (uint64_t)bufferLength ||
+        fileLength - sizeof(_tsearch_frozentree_file_header) != bufferLength) {
+        return failure;
+    }
+
+    return success;
+}
+
+
+/// 64-bit FNV-1a.
+static uint64_t _tsearch_frozentree_checksum(const void *bytes, const size_t length)
+{
+    const unsigned char *cursor = bytes;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint64_t)cursor[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+/// Maps the whole file into memory read-only. Platforms without mmap() read the file into a
+/// heap buffer instead. Returns NULL on failure or if the file is empty.
+static void * _tsearch_frozentree_map_file(const char *path, size_t *outLength)
+{
+    if (path == NULL || outLength == NULL) { return NULL; }
+    *outLength = 0;
+
+#if defined(_WIN32)
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) { return NULL; }
+
+    long fileLength = -1;
+    if (fseek(file, 0, SEEK_END) == 0) { fileLength = ftell(file); }
+    if (fileLength <= 0 || fseek(file, 0, SEEK_SET) != 0) { fclose(file); return NULL; }
+
+    void *mapping = malloc((size_t)fileLength);
+    if (mapping == NULL) { fclose(file); return NULL; }
+
+    if (fread(mapping, (size_t)fileLength, 1, file) != 1) {
+        free(mapping);
+        fclose(file);
+        return NULL;
+    }
+
+    fclose(file);
+    *outLength = (size_t)fileLength;
+    return mapping;
+#else
+    int fileDescriptor = open(path, O_RDONLY);
+    if (fileDescriptor < 0) { return NULL; }
+
+    struct stat fileStatus;
+    if (fstat(fileDescriptor, &fileStatus) != 0 ||
+        fileStatus.st_size <= 0 ||
+        (uint64_t)fileStatus.st_size > (uint64_t)SIZE_MAX) {
+        close(fileDescriptor);
+        return NULL;
+    }
+
+    size_t fileLength = (size_t)fileStatus.st_size;
+    void *mapping = mmap(NULL, fileLength, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED) { return NULL; }
+
+    *outLength = fileLength;
+    return mapping;
+#endif
+}
+
+
+static void _tsearch_frozentree_unmap_file(void *mapping, const size_t length)
+{
+    if (mapping == NULL) { return; }
+#if defined(_WIN32)
+    (void)length;
+    free(mapping);
+#else
+    (void)munmap(mapping, length);
+#endif
+}
+
+
+static _tsearch_compact_view _tsearch_frozentree_view(const tsearch_frozentree_ptr ptr)
+{
+    return (_tsearch_compact_view){
+        ptr->nodes,
+        ptr->nodeCount,
+        ptr,
+        _tsearch_frozentree_has_postings,
+        _tsearch_frozentree_union_postings,
+    };
+}
+
+
+static bool _tsearch_frozentree_has_postings(const void *postings, const uint32_t postingsID)
+{
+    const tsearch_frozentree *ptr = postings;
+    return (ptr != NULL && postingsID < ptr->postingsCount) ? true : false;
+}
+
+
+static result _tsearch_frozentree_union_postings(const void *postings, const uint32_t postingsID,
+                                                 tsearch_countedset_ptr results)
+{
+    const tsearch_frozentree *ptr = postings;
+    if (ptr == NULL || postingsID >= ptr->postingsCount) { return failure; }
+
+    uint64_t start = ptr->postingsOffsets[postingsID];
+    uint64_t end = ptr->postingsOffsets[postingsID + 1];
+    if (start > end || end > ptr->entryCount) { return failure; }
+
+    for (uint64_t i = start; i < end; i++) {
+#if SIZE_MAX < UINT64_MAX
+        if (ptr->counts[i] > SIZE_MAX) { return failure; }
+#endif
+        if (_tsearch_countedset_add_int(results, ptr->documentIDs[i], (size_t)ptr->counts[i]) == failure) {
+            return failure;
+        }
+    }
+
+    return success;
+}
+
+
+/// Returns the counted set for the postings ID or NULL if the ID is invalid or the set is empty.
+static tsearch_countedset_ptr _tsearch_frozentree_get_postings(const tsearch_countedset_ptr *postings,
+                                                               const uint32_t postingsCount,
+                                                               const uint32_t postingsID)
+{
+    if (postings == NULL || postingsID == TSEARCH_COMPACT_NONE || postingsID >= postingsCount) { return NULL; }
+    tsearch_countedset_ptr documentIDs = postings[postingsID];
+    return (tsearch_countedset_get_count(documentIDs) > 0) ? documentIDs : NULL;
+}
+
+
+/// Copies the document IDs and counts in the counted set into the buffer, growing it if needed,
+/// and sorts them by document ID.
+static result _tsearch_frozentree_copy_sorted_postings(const tsearch_countedset_ptr documentIDs,
+                                                       _tsearch_frozentree_posting **buffer,
+                                                       size_t *capacity,
+                                                       size_t *outCount)
+{
+    if (buffer == NULL || capacity == NULL || outCount == NULL) { return failure; }
+    *outCount = 0;
+
+    GNEInteger *integers = NULL;
+    size_t count = 0;
+    if (tsearch_countedset_copy_ints(documentIDs, &integers, &count) == failure) { return failure; }
+
+    if (count > *capacity) {
+        size_t byteLength = 0;
+        if (_tsearch_size_mul_overflows(count, sizeof(_tsearch_frozentree_posting), &byteLength)) {
+            free(integers);
+            return failure;
+        }
+
+        _tsearch_frozentree_posting *newBuffer = realloc(*buffer, byteLength);
+        if (newBuffer == NULL) { free(integers); return failure; }
+
+        *buffer = newBuffer;
+        *capacity = count;
+    }
+
+    for (size_t i = 0; i < count; i++) {
+        GNEInteger integer = integers[i];
+        (*buffer)[i] = (_tsearch_frozentree_posting){integer, tsearch_countedset_get_count_for_int(documentIDs, integer)};
+    }
+    free(integers);
+
+    if (count > 1) {
+        qsort(*buffer, count, sizeof(_tsearch_frozentree_posting), _tsearch_frozentree_posting_compare);
+    }
+
+    *outCount = count;
+    return success;
+}
+
+
+static int _tsearch_frozentree_posting_compare(const void *valuePtr1, const void *valuePtr2)
+{
+    if (valuePtr1 == NULL || valuePtr2 == NULL) { return 0; }
+    GNEInteger documentID1 = ((const _tsearch_frozentree_posting *)valuePtr1)->documentID;
+    GNEInteger documentID2 = ((const _tsearch_frozentree_posting *)valuePtr2)->documentID;
+
+    if (documentID1 < documentID2) { return -1; }
+    if (documentID1 > documentID2) { return 1; }
+    return 0;
+}
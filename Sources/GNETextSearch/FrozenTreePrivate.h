@@ -0,0 +1,31 @@
+//
+//  FrozenTreePrivate.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_frozentree_private_h
+#define tsearch_frozentree_private_h
+
+#include <GNETextSearch/FrozenTree.h>
+#include "CompactNode.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Creates a frozen tree from compact nodes that are already in their final order and the counted
+/// sets referred to by the nodes' postings IDs. Empty counted sets are dropped. Neither the nodes
+/// nor the counted sets are retained. Returns NULL on failure.
+tsearch_frozentree_ptr _tsearch_frozentree_init_with_nodes(const _tsearch_compact_node *nodes,
+                                                           const uint32_t nodeCount,
+                                                           const tsearch_countedset_ptr *postings,
+                                                           const uint32_t postingsCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_frozentree_private_h */
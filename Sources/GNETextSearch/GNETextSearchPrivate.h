@@ -72,6 +72,56 @@ TSEARCH_INLINE result _tsearch_next_buf_len(size_t *capacity,
     return success;
 }
 
+
+TSEARCH_INLINE result _tsearch_build_prefix_table(const char *target, const size_t length, size_t **outTable)
+{
+    if (target == NULL || length == 0 || outTable == NULL) { return failure; }
+    *outTable = NULL;
+
+    size_t byteLength = 0;
+    if (_tsearch_size_mul_overflows(length, sizeof(size_t), &byteLength)) {
+        return failure;
+    }
+
+    size_t *table = calloc(1, byteLength);
+    if (table == NULL) { return failure; }
+
+    size_t matched = 0;
+    for (size_t i = 1; i < length; i++) {
+        while (matched > 0 && target[i] != target[matched]) {
+            matched = table[matched - 1];
+        }
+
+        if (target[i] == target[matched]) {
+            matched += 1;
+        }
+
+        table[i] = matched;
+    }
+
+    *outTable = table;
+    return success;
+}
+
+
+TSEARCH_INLINE size_t _tsearch_kmp_next_index(const char *target,
+                                              const size_t *prefixTable,
+                                              size_t currentIndex,
+                                              const char character)
+{
+    if (target == NULL || prefixTable == NULL) { return 0; }
+
+    while (currentIndex > 0 && character != target[currentIndex]) {
+        currentIndex = prefixTable[currentIndex - 1];
+    }
+
+    if (character == target[currentIndex]) {
+        currentIndex += 1;
+    }
+
+    return currentIndex;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,191 @@
+//
+//  HashTable.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include "HashTable.h"
+#include "GNETextSearchPrivate.h"
+#include <string.h>
+
+// ------------------------------------------------------------------------------------------
+
+#define TSEARCH_HASHTABLE_INITIAL_CAPACITY 64
+
+// ------------------------------------------------------------------------------------------
+
+static size_t _tsearch_hashtable_find_empty(const _tsearch_hashtable *table, const size_t hash);
+static result _tsearch_hashtable_grow(_tsearch_hashtable *table);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Hash Table
+// ------------------------------------------------------------------------------------------
+result _tsearch_hashtable_init(_tsearch_hashtable *table, const size_t slotSize,
+                               const _tsearch_hashtable_hash_func hashSlot,
+                               const _tsearch_hashtable_is_empty_func isSlotEmpty,
+                               const _tsearch_hashtable_has_key_func slotHasKey)
+{
+    if (table == NULL || slotSize == 0 || hashSlot == NULL || isSlotEmpty == NULL || slotHasKey == NULL) {
+        return failure;
+    }
+
+    table->slots = calloc(TSEARCH_HASHTABLE_INITIAL_CAPACITY, slotSize);
+    if (table->slots == NULL) { return failure; }
+
+    table->slotSize = slotSize;
+    table->capacity = TSEARCH_HASHTABLE_INITIAL_CAPACITY;
+    table->count = 0;
+    table->hashSlot = hashSlot;
+    table->isSlotEmpty = isSlotEmpty;
+    table->slotHasKey = slotHasKey;
+    return success;
+}
+
+
+void _tsearch_hashtable_free(_tsearch_hashtable *table)
+{
+    if (table == NULL) { return; }
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->count = 0;
+}
+
+
+size_t _tsearch_hashtable_get_byte_length(const _tsearch_hashtable *table)
+{
+    return (table == NULL) ? 0 : table->capacity * table->slotSize;
+}
+
+
+size_t _tsearch_hashtable_get_growth_byte_length(const _tsearch_hashtable *table)
+{
+    if (table == NULL) { return 0; }
+    size_t threshold = (table->capacity / 4) * 3;
+    return (table->count + 1 > threshold) ? table->capacity * table->slotSize : 0;
+}
+
+
+void * _tsearch_hashtable_get_slot(const _tsearch_hashtable *table, const size_t slotIndex)
+{
+    return (char *)table->slots + (slotIndex * table->slotSize);
+}
+
+
+size_t _tsearch_hashtable_find(const _tsearch_hashtable *table, const void *key, const size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t slotIndex = hash & mask;
+    while (true) {
+        const void *slot = _tsearch_hashtable_get_slot(table, slotIndex);
+        if (table->isSlotEmpty(slot) == true || table->slotHasKey(slot, key) == true) { return slotIndex; }
+        slotIndex = (slotIndex + 1) & mask;
+    }
+}
+
+
+result _tsearch_hashtable_add(_tsearch_hashtable *table, const size_t hash, void **outSlot)
+{
+    if (table == NULL || outSlot == NULL) { return failure; }
+    *outSlot = NULL;
+
+    if (_tsearch_hashtable_get_growth_byte_length(table) > 0 && _tsearch_hashtable_grow(table) == failure) {
+        return failure;
+    }
+
+    *outSlot = _tsearch_hashtable_get_slot(table, _tsearch_hashtable_find_empty(table, hash));
+    table->count += 1;
+    return success;
+}
+
+
+void _tsearch_hashtable_remove(_tsearch_hashtable *table, const size_t slotIndex)
+{
+    size_t mask = table->capacity - 1;
+    size_t emptyIndex = slotIndex;
+    size_t nextIndex = (slotIndex + 1) & mask;
+
+    while (true) {
+        void *next = _tsearch_hashtable_get_slot(table, nextIndex);
+        if (table->isSlotEmpty(next) == true) { break; }
+
+        // The slot can move into the empty slot unless its home lies cyclically after the empty slot.
+        size_t homeIndex = table->hashSlot(next) & mask;
+        size_t distanceToNext = (nextIndex - homeIndex) & mask;
+        size_t distanceToEmpty = (emptyIndex - homeIndex) & mask;
+        if (distanceToEmpty <= distanceToNext) {
+            memcpy(_tsearch_hashtable_get_slot(table, emptyIndex), next, table->slotSize);
+            emptyIndex = nextIndex;
+        }
+        nextIndex = (nextIndex + 1) & mask;
+    }
+
+    memset(_tsearch_hashtable_get_slot(table, emptyIndex), 0, table->slotSize);
+    table->count -= 1;
+}
+
+
+void _tsearch_hashtable_remove_all(_tsearch_hashtable *table)
+{
+    if (table == NULL) { return; }
+    memset(table->slots, 0, table->capacity * table->slotSize);
+    table->count = 0;
+}
+
+
+size_t _tsearch_hashtable_mix(const uint64_t value)
+{
+    uint64_t hash = value;
+    hash ^= hash >> 30;
+    hash *= UINT64_C(0xbf58476d1ce4e5b9);
+    hash ^= hash >> 27;
+    hash *= UINT64_C(0x94d049bb133111eb);
+    hash ^= hash >> 31;
+    return (size_t)hash;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+static size_t _tsearch_hashtable_find_empty(const _tsearch_hashtable *table, const size_t hash)
+{
+    size_t mask = table->capacity - 1;
+    size_t slotIndex = hash & mask;
+    while (table->isSlotEmpty(_tsearch_hashtable_get_slot(table, slotIndex)) == false) {
+        slotIndex = (slotIndex + 1) & mask;
+    }
+    return slotIndex;
+}
+
+
+static result _tsearch_hashtable_grow(_tsearch_hashtable *table)
+{
+    size_t capacity = 0;
+    size_t byteLength = 0;
+    if (_tsearch_size_mul_overflows(table->capacity, 2, &capacity) ||
+        _tsearch_size_mul_overflows(capacity, table->slotSize, &byteLength)) {
+        return failure;
+    }
+
+    void *slots = calloc(1, byteLength);
+    if (slots == NULL) { return failure; }
+
+    char *oldSlots = table->slots;
+    size_t oldCapacity = table->capacity;
+    table->slots = slots;
+    table->capacity = capacity;
+
+    // Every key in the old table is distinct, so each slot only needs an empty slot.
+    for (size_t i = 0; i < oldCapacity; i++) {
+        const void *oldSlot = oldSlots + (i * table->slotSize);
+        if (table->isSlotEmpty(oldSlot) == true) { continue; }
+        size_t slotIndex = _tsearch_hashtable_find_empty(table, table->hashSlot(oldSlot));
+        memcpy(_tsearch_hashtable_get_slot(table, slotIndex), oldSlot, table->slotSize);
+    }
+
+    free(oldSlots);
+    return success;
+}
@@ -0,0 +1,77 @@
+//
+//  HashTable.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_hashtable_h
+#define tsearch_hashtable_h
+
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef size_t(*_tsearch_hashtable_hash_func)(const void *slot);
+typedef bool(*_tsearch_hashtable_is_empty_func)(const void *slot);
+typedef bool(*_tsearch_hashtable_has_key_func)(const void *slot, const void *key);
+
+/// An open-addressing hash table of fixed-size slots, which its owner lays out and describes with
+/// the functions below. Keys are whatever the owner's functions compare slots against. Slots whose
+/// bytes are all zero must be empty. The table keeps itself at most three-quarters full, so that
+/// probe sequences stay short, and never full, so that probes always terminate.
+typedef struct _tsearch_hashtable
+{
+    void *slots;
+    size_t slotSize;
+    size_t capacity; // Always a power of two.
+    size_t count;
+    _tsearch_hashtable_hash_func hashSlot;
+    _tsearch_hashtable_is_empty_func isSlotEmpty;
+    _tsearch_hashtable_has_key_func slotHasKey;
+} _tsearch_hashtable;
+
+/// Sets up an empty table. Returns failure if the slots can't be allocated.
+result _tsearch_hashtable_init(_tsearch_hashtable *table, const size_t slotSize,
+                               const _tsearch_hashtable_hash_func hashSlot,
+                               const _tsearch_hashtable_is_empty_func isSlotEmpty,
+                               const _tsearch_hashtable_has_key_func slotHasKey);
+
+/// Frees the table's slots, but not anything they point to.
+void _tsearch_hashtable_free(_tsearch_hashtable *table);
+
+/// Returns the number of bytes taken by the table's slots.
+size_t _tsearch_hashtable_get_byte_length(const _tsearch_hashtable *table);
+
+/// Returns the number of bytes the table's slots grow by when the next slot is added.
+size_t _tsearch_hashtable_get_growth_byte_length(const _tsearch_hashtable *table);
+
+void * _tsearch_hashtable_get_slot(const _tsearch_hashtable *table, const size_t slotIndex);
+
+/// Returns the index of the key's slot or, if the key isn't in the table, of the empty slot where
+/// it belongs. The hash must be the one hashSlot returns for the key's slot.
+size_t _tsearch_hashtable_find(const _tsearch_hashtable *table, const void *key, const size_t hash);
+
+/// Grows the table if needed and writes the empty slot for a key with the hash, which must not be
+/// in the table yet. The slot is counted right away, so the caller must fill it.
+result _tsearch_hashtable_add(_tsearch_hashtable *table, const size_t hash, void **outSlot);
+
+/// Empties the slot. Any later slots in its probe sequence that would become unreachable are
+/// shifted back, so the table doesn't need tombstones. The caller must free what the slot points to first.
+void _tsearch_hashtable_remove(_tsearch_hashtable *table, const size_t slotIndex);
+
+/// Empties every slot without shrinking the table.
+void _tsearch_hashtable_remove_all(_tsearch_hashtable *table);
+
+/// Mixes integers and addresses, which are often sequential or evenly spaced, with the SplitMix64
+/// finalizer before the table masks them to its capacity.
+size_t _tsearch_hashtable_mix(const uint64_t value);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_hashtable_h */
@@ -0,0 +1,118 @@
+//
+//  NodeTable.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include "NodeTable.h"
+#include "GNETextSearchPrivate.h"
+#include <string.h>
+
+// ------------------------------------------------------------------------------------------
+
+#define TSEARCH_NODETABLE_INITIAL_NODES_CAPACITY 4
+
+// ------------------------------------------------------------------------------------------
+
+static size_t _tsearch_nodetable_hash_slot(const void *slot);
+static bool _tsearch_nodetable_is_slot_empty(const void *slot);
+static bool _tsearch_nodetable_slot_has_key(const void *slot, const void *key);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Node Table
+// ------------------------------------------------------------------------------------------
+result _tsearch_nodetable_init(_tsearch_hashtable *table)
+{
+    return _tsearch_hashtable_init(table, sizeof(_tsearch_nodetable_slot), _tsearch_nodetable_hash_slot,
+                                   _tsearch_nodetable_is_slot_empty, _tsearch_nodetable_slot_has_key);
+}
+
+
+void _tsearch_nodetable_free(_tsearch_hashtable *table)
+{
+    if (table == NULL) { return; }
+
+    _tsearch_nodetable_slot *slots = table->slots;
+    for (size_t i = 0; i < table->capacity; i++) {
+        free(slots[i].nodes);
+    }
+    _tsearch_hashtable_free(table);
+}
+
+
+_tsearch_nodetable_slot * _tsearch_nodetable_find(const _tsearch_hashtable *table, const uint64_t key,
+                                                  size_t *outSlotIndex)
+{
+    *outSlotIndex = _tsearch_hashtable_find(table, &key, _tsearch_hashtable_mix(key));
+    return _tsearch_hashtable_get_slot(table, *outSlotIndex);
+}
+
+
+result _tsearch_nodetable_add(_tsearch_hashtable *table, const uint64_t key, void *node)
+{
+    if (table == NULL || node == NULL) { return failure; }
+
+    // The first node goes into a slot of its own before the table is changed, so a failed
+    // allocation leaves the table as it was.
+    _tsearch_nodetable_slot newSlot = (_tsearch_nodetable_slot){key, NULL, 0, 0};
+    if (_tsearch_nodetable_slot_insert(&newSlot, 0, node) == failure) { return failure; }
+
+    void *emptySlot = NULL;
+    if (_tsearch_hashtable_add(table, _tsearch_hashtable_mix(key), &emptySlot) == failure) {
+        free(newSlot.nodes);
+        return failure;
+    }
+
+    *(_tsearch_nodetable_slot *)emptySlot = newSlot;
+    return success;
+}
+
+
+result _tsearch_nodetable_slot_insert(_tsearch_nodetable_slot *slot, const size_t position, void *node)
+{
+    if (slot == NULL || position > slot->count) { return failure; }
+
+    if (slot->count >= slot->capacity) {
+        size_t capacity = slot->capacity;
+        size_t byteLength = 0;
+        if (capacity == 0) {
+            capacity = TSEARCH_NODETABLE_INITIAL_NODES_CAPACITY;
+            byteLength = capacity * sizeof(void *);
+        } else if (_tsearch_next_buf_len(&capacity, sizeof(void *), &byteLength) == failure) {
+            return failure;
+        }
+
+        void **nodes = realloc(slot->nodes, byteLength);
+        if (nodes == NULL) { return failure; }
+        slot->nodes = nodes;
+        slot->capacity = capacity;
+    }
+
+    memmove(&(slot->nodes[position + 1]), &(slot->nodes[position]), (slot->count - position) * sizeof(void *));
+    slot->nodes[position] = node;
+    slot->count += 1;
+    return success;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+static size_t _tsearch_nodetable_hash_slot(const void *slot)
+{
+    return _tsearch_hashtable_mix(((const _tsearch_nodetable_slot *)slot)->key);
+}
+
+
+static bool _tsearch_nodetable_is_slot_empty(const void *slot)
+{
+    return (((const _tsearch_nodetable_slot *)slot)->nodes == NULL) ? true : false;
+}
+
+
+static bool _tsearch_nodetable_slot_has_key(const void *slot, const void *key)
+{
+    return (((const _tsearch_nodetable_slot *)slot)->key == *(const uint64_t *)key) ? true : false;
+}
@@ -0,0 +1,50 @@
+//
+//  NodeTable.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_nodetable_h
+#define tsearch_nodetable_h
+
+#include <GNETextSearch/Types.h>
+#include "HashTable.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A slot of a hash table mapping integer keys to lists of nodes, which the document and trigram
+/// indexes both build on. The nodes are opaque pointers that are never dereferenced.
+typedef struct _tsearch_nodetable_slot
+{
+    uint64_t key;
+    void **nodes; // NULL for empty slots. Occupied slots always hold at least one node.
+    size_t count;
+    size_t capacity;
+} _tsearch_nodetable_slot;
+
+/// Sets up an empty table of node lists. Returns failure if the slots can't be allocated.
+result _tsearch_nodetable_init(_tsearch_hashtable *table);
+
+/// Frees every slot's nodes and the table's slots.
+void _tsearch_nodetable_free(_tsearch_hashtable *table);
+
+/// Returns the key's slot or, if the key isn't in the table, the empty slot where it belongs.
+_tsearch_nodetable_slot * _tsearch_nodetable_find(const _tsearch_hashtable *table, const uint64_t key,
+                                                  size_t *outSlotIndex);
+
+/// Adds a slot holding just the node for a key that isn't in the table yet. A failed allocation
+/// leaves the table as it was.
+result _tsearch_nodetable_add(_tsearch_hashtable *table, const uint64_t key, void *node);
+
+/// Inserts the node into the slot's nodes at the position, growing them if needed.
+result _tsearch_nodetable_slot_insert(_tsearch_nodetable_slot *slot, const size_t position, void *node);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_nodetable_h */
@@ -0,0 +1,542 @@
+//
+//  PostingList.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include <GNETextSearch/PostingList.h>
+#include "CountedSetPrivate.h"
+#include "GNETextSearchPrivate.h"
+#include <string.h>
+
+// ------------------------------------------------------------------------------------------
+
+#define TSEARCH_POSTINGLIST_BLOCK_LENGTH 64
+#define TSEARCH_POSTINGLIST_MAX_VARINT_LENGTH 10
+
+/// The first integer of each block of a compressed list. The block's other integers are stored as
+/// differences from the integer before them, so decoding can start at any block.
+typedef struct _tsearch_postinglist_skip
+{
+    GNEInteger integer;
+    size_t offset; // The offset of the first integer's count in the list's bytes.
+} _tsearch_postinglist_skip;
+
+typedef struct tsearch_postinglist
+{
+    size_t count;
+    bool isCompressed;
+    GNEInteger *integers; // Only used by uncompressed lists.
+    size_t *counts;       // Only used by uncompressed lists.
+    uint8_t *bytes;       // Only used by compressed lists.
+    size_t byteLength;
+    _tsearch_postinglist_skip *skips;
+    size_t skipCount;
+} tsearch_postinglist;
+
+/// Reads a list's integers in ascending order without decoding the whole list first.
+typedef struct _tsearch_postinglist_cursor
+{
+    const tsearch_postinglist *list;
+    size_t index;
+    size_t offset; // The offset of the next value to decode in compressed lists.
+    GNEInteger integer;
+    size_t count;
+} _tsearch_postinglist_cursor;
+
+typedef enum _tsearch_postinglist_operation
+{
+    _tsearch_postinglist_operation_union,
+    _tsearch_postinglist_operation_intersection,
+    _tsearch_postinglist_operation_minus,
+} _tsearch_postinglist_operation;
+
+// ------------------------------------------------------------------------------------------
+
+static tsearch_postinglist_ptr _tsearch_postinglist_init_with_arrays(GNEInteger *integers, size_t *counts,
+                                                                     const size_t count, const bool shouldCompress);
+static result _tsearch_postinglist_compress(const tsearch_postinglist_ptr ptr, const GNEInteger *integers,
+                                            const size_t *counts);
+static bool _tsearch_postinglist_find(const tsearch_postinglist_ptr ptr, const GNEInteger integer,
+                                      size_t *outCount);
+static tsearch_postinglist_ptr _tsearch_postinglist_merge(const tsearch_postinglist_ptr ptr,
+                                                          const tsearch_postinglist_ptr otherPtr,
+                                                          const _tsearch_postinglist_operation operation);
+static void _tsearch_postinglist_cursor_init(_tsearch_postinglist_cursor *cursor, const tsearch_postinglist *list,
+                                             const size_t index);
+static bool _tsearch_postinglist_cursor_is_valid(const _tsearch_postinglist_cursor *cursor);
+static void _tsearch_postinglist_cursor_next(_tsearch_postinglist_cursor *cursor);
+static void _tsearch_postinglist_cursor_load(_tsearch_postinglist_cursor *cursor);
+static size_t _tsearch_varint_get_length(uint64_t value);
+static size_t _tsearch_varint_write(uint8_t *bytes, uint64_t value);
+static uint64_t _tsearch_varint_read(const uint8_t *bytes, const size_t length, size_t *offset);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Posting List
+// ------------------------------------------------------------------------------------------
+tsearch_postinglist_ptr tsearch_postinglist_init_with_countedset(const tsearch_countedset_ptr set,
+                                                                 const bool shouldCompress)
+{
+    tsearch_countedset_iterator iterator;
+    if (tsearch_countedset_iterator_init(&iterator, set) == failure) { return NULL; }
+
+    size_t count = tsearch_countedset_get_count(set);
+    if (count == 0) { return _tsearch_postinglist_init_with_arrays(NULL, NULL, 0, shouldCompress); }
+
+    GNEInteger *integers = calloc(count, sizeof(GNEInteger));
+    size_t *counts = calloc(count, sizeof(size_t));
+    if (integers == NULL || counts == NULL) {
+        free(integers);
+        free(counts);
+        return NULL;
+    }
+
+    // The iterator visits the integers in ascending order, so they don't need to be sorted.
+    size_t index = 0;
+    while (index < count && tsearch_countedset_iterator_next(&iterator, &(integers[index]), &(counts[index]))) {
+        index += 1;
+    }
+
+    return _tsearch_postinglist_init_with_arrays(integers, counts, count, shouldCompress);
+}
+
+
+tsearch_postinglist_ptr tsearch_postinglist_init_with_ints(const GNEInteger *integers, const size_t *counts,
+                                                           const size_t count, const bool shouldCompress)
+{
+    if (count == 0) { return _tsearch_postinglist_init_with_arrays(NULL, NULL, 0, shouldCompress); }
+    if (integers == NULL) { return NULL; }
+
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0 && integers[i - 1] >= integers[i]) { return NULL; }
+        if (counts != NULL && counts[i] == 0) { return NULL; }
+    }
+
+    GNEInteger *integersCopy = calloc(count, sizeof(GNEInteger));
+    size_t *countsCopy = calloc(count, sizeof(size_t));
+    if (integersCopy == NULL || countsCopy == NULL) {
+        free(integersCopy);
+        free(countsCopy);
+        return NULL;
+    }
+
+    memcpy(integersCopy, integers, count * sizeof(GNEInteger));
+    for (size_t i = 0; i < count; i++) {
+        countsCopy[i] = (counts == NULL) ? 1 : counts[i];
+    }
+
+    return _tsearch_postinglist_init_with_arrays(integersCopy, countsCopy, count, shouldCompress);
+}
+
+
+void tsearch_postinglist_free(const tsearch_postinglist_ptr ptr)
+{
+    if (ptr == NULL) { return; }
+    free(ptr->integers);
+    free(ptr->counts);
+    free(ptr->bytes);
+    free(ptr->skips);
+    free(ptr);
+}
+
+
+size_t tsearch_postinglist_get_count(const tsearch_postinglist_ptr ptr)
+{
+    return (ptr == NULL) ? 0 : ptr->count;
+}
+
+
+size_t tsearch_postinglist_get_byte_length(const tsearch_postinglist_ptr ptr)
+{
+    if (ptr == NULL) { return 0; }
+    if (ptr->isCompressed == false) { return ptr->count * (sizeof(GNEInteger) + sizeof(size_t)); }
+    return ptr->byteLength + (ptr->skipCount * sizeof(_tsearch_postinglist_skip));
+}
+
+
+bool tsearch_postinglist_is_compressed(const tsearch_postinglist_ptr ptr)
+{
+    return (ptr == NULL) ? false : ptr->isCompressed;
+}
+
+
+bool tsearch_postinglist_contains_int(const tsearch_postinglist_ptr ptr, const GNEInteger integer)
+{
+    return _tsearch_postinglist_find(ptr, integer, NULL);
+}
+
+
+size_t tsearch_postinglist_get_count_for_int(const tsearch_postinglist_ptr ptr, const GNEInteger integer)
+{
+    size_t count = 0;
+    return (_tsearch_postinglist_find(ptr, integer, &count) == true) ? count : 0;
+}
+
+
+result tsearch_postinglist_copy_ints(const tsearch_postinglist_ptr ptr, GNEInteger **outIntegers,
+                                     size_t **outCounts, size_t *outCount)
+{
+    if (outIntegers == NULL || outCounts == NULL || outCount == NULL) { return failure; }
+    *outIntegers = NULL;
+    *outCounts = NULL;
+    *outCount = 0;
+
+    if (ptr == NULL) { return failure; }
+    if (ptr->count == 0) { return success; }
+
+    GNEInteger *integers = calloc(ptr->count, sizeof(GNEInteger));
+    size_t *counts = calloc(ptr->count, sizeof(size_t));
+    if (integers == NULL || counts == NULL) {
+        free(integers);
+        free(counts);
+        return failure;
+    }
+
+    _tsearch_postinglist_cursor cursor;
+    _tsearch_postinglist_cursor_init(&cursor, ptr, 0);
+    for (size_t i = 0; _tsearch_postinglist_cursor_is_valid(&cursor); i++) {
+        integers[i] = cursor.integer;
+        counts[i] = cursor.count;
+        _tsearch_postinglist_cursor_next(&cursor);
+    }
+
+    *outIntegers = integers;
+    *outCounts = counts;
+    *outCount = ptr->count;
+    return success;
+}
+
+
+tsearch_countedset_ptr tsearch_postinglist_copy_countedset(const tsearch_postinglist_ptr ptr)
+{
+    if (ptr == NULL) { return NULL; }
+    if (ptr->isCompressed == false) {
+        return _tsearch_countedset_init_with_sorted_ints(ptr->integers, ptr->counts, ptr->count);
+    }
+
+    GNEInteger *integers = NULL;
+    size_t *counts = NULL;
+    size_t count = 0;
+    if (tsearch_postinglist_copy_ints(ptr, &integers, &counts, &count) == failure) { return NULL; }
+
+    tsearch_countedset_ptr set = _tsearch_countedset_init_with_sorted_ints(integers, counts, count);
+    free(integers);
+    free(counts);
+    return set;
+}
+
+
+tsearch_postinglist_ptr tsearch_postinglist_copy_union(const tsearch_postinglist_ptr ptr,
+                                                       const tsearch_postinglist_ptr otherPtr)
+{
+    return _tsearch_postinglist_merge(ptr, otherPtr, _tsearch_postinglist_operation_union);
+}
+
+
+tsearch_postinglist_ptr tsearch_postinglist_copy_intersection(const tsearch_postinglist_ptr ptr,
+                                                              const tsearch_postinglist_ptr otherPtr)
+{
+    return _tsearch_postinglist_merge(ptr, otherPtr, _tsearch_postinglist_operation_intersection);
+}
+
+
+tsearch_postinglist_ptr tsearch_postinglist_copy_minus(const tsearch_postinglist_ptr ptr,
+                                                       const tsearch_postinglist_ptr otherPtr)
+{
+    return _tsearch_postinglist_merge(ptr, otherPtr, _tsearch_postinglist_operation_minus);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+/// Creates a list that takes ownership of the sorted arrays. Compressed lists free the arrays
+/// after encoding them. The arrays are freed on failure.
+static tsearch_postinglist_ptr _tsearch_postinglist_init_with_arrays(GNEInteger *integers, size_t *counts,
+                                                                     const size_t count, const bool shouldCompress)
+{
+    tsearch_postinglist_ptr ptr = calloc(1, sizeof(tsearch_postinglist));
+    if (ptr == NULL) {
+        free(integers);
+        free(counts);
+        return NULL;
+    }
+
+    ptr->count = count;
+    ptr->isCompressed = shouldCompress;
+    if (shouldCompress == false) {
+        ptr->integers = integers;
+        ptr->counts = counts;
+        return ptr;
+    }
+
+    result ret = _tsearch_postinglist_compress(ptr, integers, counts);
+    free(integers);
+    free(counts);
+    if (ret == failure) {
+        tsearch_postinglist_free(ptr);
+        return NULL;
+    }
+    return ptr;
+}
+
+
+/// Encodes the sorted integers and counts into the list's bytes. The first integer of each block
+/// is only stored in the skip table, and every other integer is stored as its difference from the
+/// previous integer, followed by its count.
+static result _tsearch_postinglist_compress(const tsearch_postinglist_ptr ptr, const GNEInteger *integers,
+                                            const size_t *counts)
+{
+    size_t count = ptr->count;
+    if (count == 0) { return success; }
+
+    size_t byteLength = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t length = _tsearch_varint_get_length((uint64_t)counts[i]);
+        if (i % TSEARCH_POSTINGLIST_BLOCK_LENGTH != 0) {
+            length += _tsearch_varint_get_length((uint64_t)integers[i] - (uint64_t)integers[i - 1]);
+        }
+        if (_tsearch_size_add_overflows(byteLength, length, &byteLength)) { return failure; }
+    }
+
+    size_t skipCount = (count - 1) / TSEARCH_POSTINGLIST_BLOCK_LENGTH + 1;
+    ptr->bytes = malloc(byteLength);
+    ptr->skips = calloc(skipCount, sizeof(_tsearch_postinglist_skip));
+    if (ptr->bytes == NULL || ptr->skips == NULL) { return failure; }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (i % TSEARCH_POSTINGLIST_BLOCK_LENGTH == 0) {
+            ptr->skips[i / TSEARCH_POSTINGLIST_BLOCK_LENGTH] = (_tsearch_postinglist_skip){integers[i], offset};
+        } else {
+            offset += _tsearch_varint_write(ptr->bytes + offset, (uint64_t)integers[i] - (uint64_t)integers[i - 1]);
+        }
+        offset += _tsearch_varint_write(ptr->bytes + offset, (uint64_t)counts[i]);
+    }
+
+    ptr->byteLength = byteLength;
+    ptr->skipCount = skipCount;
+    return success;
+}
+
+
+/// Binary searches uncompressed lists. Compressed lists are binary searched by their skip tables,
+/// and then the one block that could contain the integer is decoded.
+static bool _tsearch_postinglist_find(const tsearch_postinglist_ptr ptr, const GNEInteger integer,
+                                      size_t *outCount)
+{
+    if (ptr == NULL || ptr->count == 0) { return false; }
+
+    if (ptr->isCompressed == false) {
+        size_t low = 0, high = ptr->count;
+        while (low < high) {
+            size_t middle = low + (high - low) / 2;
+            if (ptr->integers[middle] < integer) { low = middle + 1; }
+            else { high = middle; }
+        }
+
+        if (low == ptr->count || ptr->integers[low] != integer) { return false; }
+        if (outCount != NULL) { *outCount = ptr->counts[low]; }
+        return true;
+    }
+
+    // Finds the last block whose first integer isn't greater than the integer.
+    size_t low = 0, high = ptr->skipCount;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (ptr->skips[middle].integer <= integer) { low = middle + 1; }
+        else { high = middle; }
+    }
+    if (low == 0) { return false; }
+
+    size_t blockStart = (low - 1) * TSEARCH_POSTINGLIST_BLOCK_LENGTH;
+    size_t blockEnd = blockStart + TSEARCH_POSTINGLIST_BLOCK_LENGTH;
+    _tsearch_postinglist_cursor cursor;
+    _tsearch_postinglist_cursor_init(&cursor, ptr, blockStart);
+    while (_tsearch_postinglist_cursor_is_valid(&cursor) && cursor.index < blockEnd) {
+        if (cursor.integer == integer) {
+            if (outCount != NULL) { *outCount = cursor.count; }
+            return true;
+        }
+        if (cursor.integer > integer) { return false; }
+        _tsearch_postinglist_cursor_next(&cursor);
+    }
+
+    return false;
+}
+
+
+/// Merges the two sorted lists in one pass. The result can't have more integers than the two
+/// lists together, so its arrays are allocated once before merging.
+static tsearch_postinglist_ptr _tsearch_postinglist_merge(const tsearch_postinglist_ptr ptr,
+                                                          const tsearch_postinglist_ptr otherPtr,
+                                                          const _tsearch_postinglist_operation operation)
+{
+    if (ptr == NULL || otherPtr == NULL) { return NULL; }
+
+    size_t capacity = ptr->count;
+    if (operation == _tsearch_postinglist_operation_union &&
+        _tsearch_size_add_overflows(ptr->count, otherPtr->count, &capacity)) {
+        return NULL;
+    }
+
+    GNEInteger *integers = NULL;
+    size_t *counts = NULL;
+    if (capacity > 0) {
+        integers = calloc(capacity, sizeof(GNEInteger));
+        counts = calloc(capacity, sizeof(size_t));
+        if (integers == NULL || counts == NULL) {
+            free(integers);
+            free(counts);
+            return NULL;
+        }
+    }
+
+    _tsearch_postinglist_cursor cursor, otherCursor;
+    _tsearch_postinglist_cursor_init(&cursor, ptr, 0);
+    _tsearch_postinglist_cursor_init(&otherCursor, otherPtr, 0);
+    size_t count = 0;
+
+    while (_tsearch_postinglist_cursor_is_valid(&cursor) || _tsearch_postinglist_cursor_is_valid(&otherCursor)) {
+        bool hasValue = _tsearch_postinglist_cursor_is_valid(&cursor);
+        bool hasOtherValue = _tsearch_postinglist_cursor_is_valid(&otherCursor);
+
+        if (hasValue && (hasOtherValue == false || cursor.integer < otherCursor.integer)) {
+            if (operation == _tsearch_postinglist_operation_intersection) {
+                if (hasOtherValue == false) { break; }
+            } else {
+                integers[count] = cursor.integer;
+                counts[count] = cursor.count;
+                count += 1;
+            }
+            _tsearch_postinglist_cursor_next(&cursor);
+        } else if (hasOtherValue && (hasValue == false || otherCursor.integer < cursor.integer)) {
+            if (operation == _tsearch_postinglist_operation_union) {
+                integers[count] = otherCursor.integer;
+                counts[count] = otherCursor.count;
+                count += 1;
+            } else if (hasValue == false) {
+                break; // Nothing else can be added to intersections or differences.
+            }
+            _tsearch_postinglist_cursor_next(&otherCursor);
+        } else {
+            size_t newCount = 0;
+            if (operation == _tsearch_postinglist_operation_minus) {
+                newCount = (cursor.count > otherCursor.count) ? cursor.count - otherCursor.count : 0;
+            } else if (_tsearch_size_add_overflows(cursor.count, otherCursor.count, &newCount)) {
+                free(integers);
+                free(counts);
+                return NULL;
+            }
+
+            if (newCount > 0) {
+                integers[count] = cursor.integer;
+                counts[count] = newCount;
+                count += 1;
+            }
+            _tsearch_postinglist_cursor_next(&cursor);
+            _tsearch_postinglist_cursor_next(&otherCursor);
+        }
+    }
+
+    return _tsearch_postinglist_init_with_arrays(integers, counts, count, ptr->isCompressed);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Cursor
+// ------------------------------------------------------------------------------------------
+/// Positions the cursor at the specified index, which must be the first index of a block in
+/// compressed lists.
+static void _tsearch_postinglist_cursor_init(_tsearch_postinglist_cursor *cursor, const tsearch_postinglist *list,
+                                             const size_t index)
+{
+    cursor->list = list;
+    cursor->index = index;
+    cursor->offset = 0;
+    cursor->integer = 0;
+    cursor->count = 0;
+    _tsearch_postinglist_cursor_load(cursor);
+}
+
+
+static bool _tsearch_postinglist_cursor_is_valid(const _tsearch_postinglist_cursor *cursor)
+{
+    return (cursor->list != NULL && cursor->index < cursor->list->count) ? true : false;
+}
+
+
+static void _tsearch_postinglist_cursor_next(_tsearch_postinglist_cursor *cursor)
+{
+    if (_tsearch_postinglist_cursor_is_valid(cursor) == false) { return; }
+    cursor->index += 1;
+    _tsearch_postinglist_cursor_load(cursor);
+}
+
+
+static void _tsearch_postinglist_cursor_load(_tsearch_postinglist_cursor *cursor)
+{
+    if (_tsearch_postinglist_cursor_is_valid(cursor) == false) { return; }
+
+    const tsearch_postinglist *list = cursor->list;
+    if (list->isCompressed == false) {
+        cursor->integer = list->integers[cursor->index];
+        cursor->count = list->counts[cursor->index];
+        return;
+    }
+
+    if (cursor->index % TSEARCH_POSTINGLIST_BLOCK_LENGTH == 0) {
+        _tsearch_postinglist_skip skip = list->skips[cursor->index / TSEARCH_POSTINGLIST_BLOCK_LENGTH];
+        cursor->integer = skip.integer;
+        cursor->offset = skip.offset;
+    } else {
+        uint64_t delta = _tsearch_varint_read(list->bytes, list->byteLength, &(cursor->offset));
+        cursor->integer = (GNEInteger)((uint64_t)cursor->integer + delta);
+    }
+    cursor->count = (size_t)_tsearch_varint_read(list->bytes, list->byteLength, &(cursor->offset));
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Variable-Length Integers
+// ------------------------------------------------------------------------------------------
+/// Variable-length integers store seven bits in each byte, starting with the lowest bits. The high
+/// bit of each byte is set if more bytes follow.
+static size_t _tsearch_varint_get_length(uint64_t value)
+{
+    size_t length = 1;
+    while (value >= 0x80) {
+        value >>= 7;
+        length += 1;
+    }
+    return length;
+}
+
+
+static size_t _tsearch_varint_write(uint8_t *bytes, uint64_t value)
+{
+    size_t length = 0;
+    while (value >= 0x80) {
+        bytes[length] = (uint8_t)(value | 0x80);
+        value >>= 7;
+        length += 1;
+    }
+    bytes[length] = (uint8_t)value;
+    return length + 1;
+}
+
+
+/// Reads the integer at offset and advances offset past it. Never reads past length.
+static uint64_t _tsearch_varint_read(const uint8_t *bytes, const size_t length, size_t *offset)
+{
+    uint64_t value = 0;
+    for (size_t i = 0; i < TSEARCH_POSTINGLIST_MAX_VARINT_LENGTH && *offset < length; i++) {
+        uint8_t byte = bytes[*offset];
+        *offset += 1;
+        value |= (uint64_t)(byte & 0x7f) << (7 * i);
+        if ((byte & 0x80) == 0) { break; }
+    }
+    return value;
+}
@@ -0,0 +1,263 @@
+//
+//  PrefixIndex.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include "PrefixIndex.h"
+#include "CountedSetPrivate.h"
+#include "GNETextSearchPrivate.h"
+#include "HashTable.h"
+
+// ------------------------------------------------------------------------------------------
+
+typedef struct _tsearch_prefixindex_slot
+{
+    const void *node; // NULL for empty slots.
+    tsearch_countedset_ptr documentIDs;
+    size_t byteLength; // The document IDs' byte length when they were last changed.
+} _tsearch_prefixindex_slot;
+
+struct _tsearch_prefixindex
+{
+    _tsearch_hashtable table;
+    size_t documentIDsByteLength; // The sum of the slots' byte lengths.
+    size_t maxByteLength; // 0 if the index doesn't have a limit.
+};
+
+// ------------------------------------------------------------------------------------------
+
+static size_t _tsearch_prefixindex_hash(const void *node);
+static size_t _tsearch_prefixindex_hash_slot(const void *slot);
+static bool _tsearch_prefixindex_is_slot_empty(const void *slot);
+static bool _tsearch_prefixindex_slot_has_key(const void *slot, const void *key);
+static size_t _tsearch_prefixindex_find_slot(const _tsearch_prefixindex *index, const void *node);
+static _tsearch_prefixindex_slot * _tsearch_prefixindex_get_slot(const _tsearch_prefixindex *index,
+                                                                const size_t slotIndex);
+static bool _tsearch_prefixindex_fits(const _tsearch_prefixindex *index, const size_t byteLength);
+static void _tsearch_prefixindex_did_change_slot(_tsearch_prefixindex *index, const size_t slotIndex,
+                                                 const result status);
+static void _tsearch_prefixindex_remove_slot(_tsearch_prefixindex *index, size_t slotIndex);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Prefix Index
+// ------------------------------------------------------------------------------------------
+_tsearch_prefixindex * _tsearch_prefixindex_init(const size_t maxByteLength)
+{
+    _tsearch_prefixindex *index = calloc(1, sizeof(_tsearch_prefixindex));
+    if (index == NULL) { return NULL; }
+
+    if (_tsearch_hashtable_init(&(index->table), sizeof(_tsearch_prefixindex_slot),
+                                _tsearch_prefixindex_hash_slot, _tsearch_prefixindex_is_slot_empty,
+                                _tsearch_prefixindex_slot_has_key) == failure) {
+        free(index);
+        return NULL;
+    }
+
+    index->documentIDsByteLength = 0;
+    index->maxByteLength = maxByteLength;
+    return index;
+}
+
+
+void _tsearch_prefixindex_free(_tsearch_prefixindex *index)
+{
+    if (index == NULL) { return; }
+    for (size_t i = 0; i < index->table.capacity; i++) {
+        tsearch_countedset_free(_tsearch_prefixindex_get_slot(index, i)->documentIDs);
+    }
+    _tsearch_hashtable_free(&(index->table));
+    free(index);
+}
+
+
+size_t _tsearch_prefixindex_get_count(const _tsearch_prefixindex *index)
+{
+    return (index == NULL) ? 0 : index->table.count;
+}
+
+
+size_t _tsearch_prefixindex_get_byte_length(const _tsearch_prefixindex *index)
+{
+    if (index == NULL) { return 0; }
+    return sizeof(_tsearch_prefixindex) + _tsearch_hashtable_get_byte_length(&(index->table)) +
+           index->documentIDsByteLength;
+}
+
+
+tsearch_countedset_ptr _tsearch_prefixindex_get(const _tsearch_prefixindex *index, const void *node)
+{
+    if (index == NULL || node == NULL) { return NULL; }
+    return _tsearch_prefixindex_get_slot(index, _tsearch_prefixindex_find_slot(index, node))->documentIDs;
+}
+
+
+result _tsearch_prefixindex_insert(_tsearch_prefixindex *index, void *node, const tsearch_countedset_ptr documentIDs)
+{
+    if (index == NULL || node == NULL || documentIDs == NULL) {
+        tsearch_countedset_free(documentIDs);
+        return failure;
+    }
+
+    // Growing the table counts against the limit too.
+    size_t byteLength = tsearch_countedset_get_byte_length(documentIDs);
+    size_t growthByteLength = _tsearch_hashtable_get_growth_byte_length(&(index->table));
+    size_t totalByteLength = 0;
+    if (_tsearch_size_add_overflows(byteLength, growthByteLength, &totalByteLength) ||
+        _tsearch_prefixindex_fits(index, totalByteLength) == false) {
+        tsearch_countedset_free(documentIDs);
+        return success;
+    }
+
+    void *slot = NULL;
+    if (_tsearch_hashtable_add(&(index->table), _tsearch_prefixindex_hash(node), &slot) == failure) {
+        tsearch_countedset_free(documentIDs);
+        return failure;
+    }
+
+    *(_tsearch_prefixindex_slot *)slot = (_tsearch_prefixindex_slot){node, documentIDs, byteLength};
+    index->documentIDsByteLength += byteLength;
+    return success;
+}
+
+
+void _tsearch_prefixindex_remove(_tsearch_prefixindex *index, const void *node)
+{
+    if (index == NULL || node == NULL) { return; }
+
+    size_t slotIndex = _tsearch_prefixindex_find_slot(index, node);
+    if (_tsearch_prefixindex_get_slot(index, slotIndex)->node == NULL) { return; }
+    _tsearch_prefixindex_remove_slot(index, slotIndex);
+}
+
+
+void _tsearch_prefixindex_add_int(_tsearch_prefixindex *index, const void *node,
+                                  const GNEInteger documentID, const size_t count)
+{
+    if (index == NULL || node == NULL) { return; }
+
+    size_t slotIndex = _tsearch_prefixindex_find_slot(index, node);
+    tsearch_countedset_ptr documentIDs = _tsearch_prefixindex_get_slot(index, slotIndex)->documentIDs;
+    if (documentIDs == NULL) { return; }
+
+    result status = _tsearch_countedset_add_int(documentIDs, documentID, count);
+    _tsearch_prefixindex_did_change_slot(index, slotIndex, status);
+}
+
+
+void _tsearch_prefixindex_remove_int(_tsearch_prefixindex *index, const void *node, const GNEInteger documentID)
+{
+    if (index == NULL || node == NULL) { return; }
+
+    size_t slotIndex = _tsearch_prefixindex_find_slot(index, node);
+    tsearch_countedset_ptr documentIDs = _tsearch_prefixindex_get_slot(index, slotIndex)->documentIDs;
+    if (documentIDs == NULL) { return; }
+
+    result status = tsearch_countedset_remove_int(documentIDs, documentID);
+    _tsearch_prefixindex_did_change_slot(index, slotIndex, status);
+}
+
+
+void _tsearch_prefixindex_remove_ints_in_set(_tsearch_prefixindex *index, const tsearch_countedset_ptr documentIDs)
+{
+    if (index == NULL || tsearch_countedset_get_count(documentIDs) == 0) { return; }
+
+    size_t slotIndex = 0;
+    while (slotIndex < index->table.capacity) {
+        _tsearch_prefixindex_slot *slot = _tsearch_prefixindex_get_slot(index, slotIndex);
+        if (slot->node == NULL) { slotIndex += 1; continue; }
+
+        size_t count = index->table.count;
+        result status = _tsearch_countedset_remove_ints_in_set(slot->documentIDs, documentIDs);
+        _tsearch_prefixindex_did_change_slot(index, slotIndex, status);
+
+        // Removing a slot can shift a later slot into it, so the same slot is visited again. A slot
+        // that wraps around from the start of the table is visited twice, which is harmless
+        // because removing the document IDs a second time doesn't change anything.
+        if (index->table.count == count) { slotIndex += 1; }
+    }
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+static size_t _tsearch_prefixindex_hash(const void *node)
+{
+    return _tsearch_hashtable_mix((uint64_t)(uintptr_t)node);
+}
+
+
+static size_t _tsearch_prefixindex_hash_slot(const void *slot)
+{
+    return _tsearch_prefixindex_hash(((const _tsearch_prefixindex_slot *)slot)->node);
+}
+
+
+static bool _tsearch_prefixindex_is_slot_empty(const void *slot)
+{
+    return (((const _tsearch_prefixindex_slot *)slot)->node == NULL) ? true : false;
+}
+
+
+static bool _tsearch_prefixindex_slot_has_key(const void *slot, const void *key)
+{
+    return (((const _tsearch_prefixindex_slot *)slot)->node == key) ? true : false;
+}
+
+
+/// Returns the index of the node's slot or, if the node isn't in the index, of the empty slot
+/// where it belongs.
+static size_t _tsearch_prefixindex_find_slot(const _tsearch_prefixindex *index, const void *node)
+{
+    return _tsearch_hashtable_find(&(index->table), node, _tsearch_prefixindex_hash(node));
+}
+
+
+static _tsearch_prefixindex_slot * _tsearch_prefixindex_get_slot(const _tsearch_prefixindex *index,
+                                                                const size_t slotIndex)
+{
+    return _tsearch_hashtable_get_slot(&(index->table), slotIndex);
+}
+
+
+/// Returns true if the index can take byteLength more bytes without going past its limit.
+static bool _tsearch_prefixindex_fits(const _tsearch_prefixindex *index, const size_t byteLength)
+{
+    if (index->maxByteLength == 0) { return true; }
+    size_t currentByteLength = _tsearch_prefixindex_get_byte_length(index);
+    if (currentByteLength > index->maxByteLength) { return false; }
+    return (byteLength <= index->maxByteLength - currentByteLength);
+}
+
+
+/// Brings the index's byte length up to date after the slot's document IDs were changed, and
+/// removes the slot if the change failed or left the index past its limit.
+static void _tsearch_prefixindex_did_change_slot(_tsearch_prefixindex *index, const size_t slotIndex,
+                                                 const result status)
+{
+    _tsearch_prefixindex_slot *slot = _tsearch_prefixindex_get_slot(index, slotIndex);
+    size_t byteLength = tsearch_countedset_get_byte_length(slot->documentIDs);
+    index->documentIDsByteLength -= slot->byteLength;
+    slot->byteLength = 0;
+
+    if (status == failure || _tsearch_prefixindex_fits(index, byteLength) == false) {
+        _tsearch_prefixindex_remove_slot(index, slotIndex);
+        return;
+    }
+
+    index->documentIDsByteLength += byteLength;
+    slot->byteLength = byteLength;
+}
+
+
+/// Frees the slot's document IDs and removes the slot.
+static void _tsearch_prefixindex_remove_slot(_tsearch_prefixindex *index, size_t slotIndex)
+{
+    _tsearch_prefixindex_slot *slot = _tsearch_prefixindex_get_slot(index, slotIndex);
+    index->documentIDsByteLength -= slot->byteLength;
+    tsearch_countedset_free(slot->documentIDs);
+    _tsearch_hashtable_remove(&(index->table), slotIndex);
+}
@@ -0,0 +1,65 @@
+//
+//  PrefixIndex.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_prefixindex_h
+#define tsearch_prefixindex_h
+
+#include <GNETextSearch/CountedSet.h>
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A hash table mapping the nodes that end short prefixes to the document IDs of every word starting
+/// with the prefix. Like the document index, it stores the nodes as opaque pointers and never
+/// dereferences them. The index owns the document IDs and keeps track of the bytes they take, so
+/// that it can stay within a byte limit.
+typedef struct _tsearch_prefixindex _tsearch_prefixindex;
+
+/// Creates an empty index that never takes more than maxByteLength bytes. Pass 0 for no limit.
+_tsearch_prefixindex * _tsearch_prefixindex_init(const size_t maxByteLength);
+void _tsearch_prefixindex_free(_tsearch_prefixindex *index);
+
+/// Returns the number of nodes in the index.
+size_t _tsearch_prefixindex_get_count(const _tsearch_prefixindex *index);
+
+/// Returns the number of bytes taken by the index's table and document IDs.
+size_t _tsearch_prefixindex_get_byte_length(const _tsearch_prefixindex *index);
+
+/// Returns the node's document IDs, which belong to the index, or NULL if the node isn't in the index.
+tsearch_countedset_ptr _tsearch_prefixindex_get(const _tsearch_prefixindex *index, const void *node);
+
+/// Adds the node, which must not be in the index yet, and takes ownership of its document IDs. If
+/// they would take the index past its byte limit, they're freed instead and the node isn't added.
+/// Returns failure if documentIDs is NULL or allocation fails, in which case they're freed as well.
+result _tsearch_prefixindex_insert(_tsearch_prefixindex *index, void *node, const tsearch_countedset_ptr documentIDs);
+
+/// Removes the node from the index and frees its document IDs. Does nothing if the node isn't in
+/// the index.
+void _tsearch_prefixindex_remove(_tsearch_prefixindex *index, const void *node);
+
+/// Adds count to the document ID's count in the node's document IDs. If that fails or would take
+/// the index past its byte limit, the node is removed, so the index never holds incomplete document
+/// IDs. Does nothing if the node isn't in the index.
+void _tsearch_prefixindex_add_int(_tsearch_prefixindex *index, const void *node,
+                                  const GNEInteger documentID, const size_t count);
+
+/// Removes the document ID from the node's document IDs. If that fails, the node is removed. Does
+/// nothing if the node isn't in the index.
+void _tsearch_prefixindex_remove_int(_tsearch_prefixindex *index, const void *node, const GNEInteger documentID);
+
+/// Removes each of the document IDs from every node's document IDs. Nodes whose document IDs can't
+/// be changed are removed.
+void _tsearch_prefixindex_remove_ints_in_set(_tsearch_prefixindex *index, const tsearch_countedset_ptr documentIDs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_prefixindex_h */
@@ -0,0 +1,336 @@
+//
+//  QueryCache.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include "QueryCache.h"
+#include "GNETextSearchPrivate.h"
+#include "HashTable.h"
+#include <string.h>
+
+// ------------------------------------------------------------------------------------------
+
+typedef struct _tsearch_querycache_entry _tsearch_querycache_entry;
+
+struct _tsearch_querycache_entry
+{
+    _tsearch_querycache_entry *newer; // The more recently used neighbor, or NULL for the newest entry.
+    _tsearch_querycache_entry *older; // The less recently used neighbor, or NULL for the oldest entry.
+    size_t hash;
+    _tsearch_querycache_kind kind;
+    tsearch_countedset_ptr results; // NULL if nothing matched.
+    size_t byteLength; // The bytes taken by the entry, its key, and its results.
+    size_t length;
+    char key[]; // Not null-terminated, because partial, subsequence, and suffix searches take lengths.
+};
+
+typedef struct _tsearch_querycache_key
+{
+    size_t hash;
+    _tsearch_querycache_kind kind;
+    const char *key;
+    size_t length;
+} _tsearch_querycache_key;
+
+struct _tsearch_querycache
+{
+    _tsearch_hashtable table; // Each slot holds an entry, or NULL if it's empty.
+    _tsearch_querycache_entry *newest;
+    _tsearch_querycache_entry *oldest;
+    size_t entriesByteLength; // The sum of the entries' byte lengths.
+    size_t maxByteLength;
+    size_t hitCount;
+    size_t missCount;
+    size_t evictionCount;
+};
+
+// ------------------------------------------------------------------------------------------
+
+static size_t _tsearch_querycache_hash(const _tsearch_querycache_kind kind, const char *key, const size_t length);
+static size_t _tsearch_querycache_hash_slot(const void *slot);
+static bool _tsearch_querycache_is_slot_empty(const void *slot);
+static bool _tsearch_querycache_slot_has_key(const void *slot, const void *key);
+static size_t _tsearch_querycache_find_slot(const _tsearch_querycache *cache, const _tsearch_querycache_key *key);
+static _tsearch_querycache_entry * _tsearch_querycache_get_entry(const _tsearch_querycache *cache,
+                                                                 const size_t slotIndex);
+static bool _tsearch_querycache_fits(const _tsearch_querycache *cache, const size_t byteLength);
+static void _tsearch_querycache_make_newest(_tsearch_querycache *cache, _tsearch_querycache_entry *entry);
+static void _tsearch_querycache_unlink(_tsearch_querycache *cache, _tsearch_querycache_entry *entry);
+static void _tsearch_querycache_remove_slot(_tsearch_querycache *cache, size_t slotIndex);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Query Cache
+// ------------------------------------------------------------------------------------------
+_tsearch_querycache * _tsearch_querycache_init(const size_t maxByteLength)
+{
+    _tsearch_querycache *cache = calloc(1, sizeof(_tsearch_querycache));
+    if (cache == NULL) { return NULL; }
+
+    if (_tsearch_hashtable_init(&(cache->table), sizeof(_tsearch_querycache_entry *),
+                                _tsearch_querycache_hash_slot, _tsearch_querycache_is_slot_empty,
+                                _tsearch_querycache_slot_has_key) == failure) {
+        free(cache);
+        return NULL;
+    }
+
+    cache->newest = NULL;
+    cache->oldest = NULL;
+    cache->entriesByteLength = 0;
+    cache->maxByteLength = maxByteLength;
+    cache->hitCount = 0;
+    cache->missCount = 0;
+    cache->evictionCount = 0;
+    return cache;
+}
+
+
+void _tsearch_querycache_free(_tsearch_querycache *cache)
+{
+    if (cache == NULL) { return; }
+    _tsearch_querycache_remove_all(cache);
+    _tsearch_hashtable_free(&(cache->table));
+    free(cache);
+}
+
+
+size_t _tsearch_querycache_get_count(const _tsearch_querycache *cache)
+{
+    return (cache == NULL) ? 0 : cache->table.count;
+}
+
+
+size_t _tsearch_querycache_get_byte_length(const _tsearch_querycache *cache)
+{
+    if (cache == NULL) { return 0; }
+    return sizeof(_tsearch_querycache) + _tsearch_hashtable_get_byte_length(&(cache->table)) +
+           cache->entriesByteLength;
+}
+
+
+size_t _tsearch_querycache_get_hit_count(const _tsearch_querycache *cache)
+{
+    return (cache == NULL) ? 0 : cache->hitCount;
+}
+
+
+size_t _tsearch_querycache_get_miss_count(const _tsearch_querycache *cache)
+{
+    return (cache == NULL) ? 0 : cache->missCount;
+}
+
+
+size_t _tsearch_querycache_get_eviction_count(const _tsearch_querycache *cache)
+{
+    return (cache == NULL) ? 0 : cache->evictionCount;
+}
+
+
+bool _tsearch_querycache_copy(_tsearch_querycache *cache, const _tsearch_querycache_kind kind,
+                              const char *key, const size_t length, tsearch_countedset_ptr *outResults)
+{
+    if (cache == NULL || key == NULL || outResults == NULL) { return false; }
+    *outResults = NULL;
+
+    _tsearch_querycache_key search = { _tsearch_querycache_hash(kind, key, length), kind, key, length };
+    _tsearch_querycache_entry *entry = _tsearch_querycache_get_entry(cache,
+                                                                     _tsearch_querycache_find_slot(cache, &search));
+    if (entry == NULL) { cache->missCount += 1; return false; }
+
+    if (entry->results != NULL) {
+        *outResults = tsearch_countedset_copy(entry->results);
+        if (*outResults == NULL) { cache->missCount += 1; return false; }
+    }
+
+    _tsearch_querycache_unlink(cache, entry);
+    _tsearch_querycache_make_newest(cache, entry);
+    cache->hitCount += 1;
+    return true;
+}
+
+
+result _tsearch_querycache_insert(_tsearch_querycache *cache, const _tsearch_querycache_kind kind,
+                                  const char *key, const size_t length, const tsearch_countedset_ptr results)
+{
+    if (cache == NULL || key == NULL) { return failure; }
+
+    _tsearch_querycache_key search = { _tsearch_querycache_hash(kind, key, length), kind, key, length };
+    if (_tsearch_querycache_get_entry(cache, _tsearch_querycache_find_slot(cache, &search)) != NULL) {
+        return success;
+    }
+
+    size_t entryByteLength = 0;
+    if (_tsearch_size_add_overflows(sizeof(_tsearch_querycache_entry), length, &entryByteLength)) { return failure; }
+
+    _tsearch_querycache_entry *entry = malloc(entryByteLength);
+    if (entry == NULL) { return failure; }
+
+    entry->newer = NULL;
+    entry->older = NULL;
+    entry->hash = search.hash;
+    entry->kind = kind;
+    entry->results = NULL;
+    entry->length = length;
+    memcpy(entry->key, key, length);
+
+    if (results != NULL) {
+        entry->results = tsearch_countedset_copy(results);
+        if (entry->results == NULL) { free(entry); return failure; }
+    }
+
+    size_t byteLength = 0;
+    if (_tsearch_size_add_overflows(entryByteLength, tsearch_countedset_get_byte_length(entry->results),
+                                    &byteLength) || byteLength > cache->maxByteLength) {
+        tsearch_countedset_free(entry->results);
+        free(entry);
+        return success;
+    }
+    entry->byteLength = byteLength;
+
+    // Growing the table counts against the limit too, so the oldest entries are evicted until both fit.
+    while (_tsearch_querycache_fits(cache, byteLength +
+                                    _tsearch_hashtable_get_growth_byte_length(&(cache->table))) == false) {
+        if (cache->oldest == NULL) {
+            tsearch_countedset_free(entry->results);
+            free(entry);
+            return success;
+        }
+
+        _tsearch_querycache_entry *oldest = cache->oldest;
+        _tsearch_querycache_key oldestKey = { oldest->hash, oldest->kind, oldest->key, oldest->length };
+        _tsearch_querycache_remove_slot(cache, _tsearch_querycache_find_slot(cache, &oldestKey));
+        cache->evictionCount += 1;
+    }
+
+    void *slot = NULL;
+    if (_tsearch_hashtable_add(&(cache->table), search.hash, &slot) == failure) {
+        tsearch_countedset_free(entry->results);
+        free(entry);
+        return failure;
+    }
+
+    *(_tsearch_querycache_entry **)slot = entry;
+    cache->entriesByteLength += byteLength;
+    _tsearch_querycache_make_newest(cache, entry);
+    return success;
+}
+
+
+void _tsearch_querycache_remove_all(_tsearch_querycache *cache)
+{
+    if (cache == NULL || cache->table.count == 0) { return; }
+
+    _tsearch_querycache_entry *entry = cache->newest;
+    while (entry != NULL) {
+        _tsearch_querycache_entry *older = entry->older;
+        tsearch_countedset_free(entry->results);
+        free(entry);
+        entry = older;
+    }
+
+    _tsearch_hashtable_remove_all(&(cache->table));
+    cache->entriesByteLength = 0;
+    cache->newest = NULL;
+    cache->oldest = NULL;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+/// Hashes the kind followed by the key's bytes with 64-bit FNV-1a, so that the same bytes searched
+/// for by different kinds of searches land in different slots.
+static size_t _tsearch_querycache_hash(const _tsearch_querycache_kind kind, const char *key, const size_t length)
+{
+    uint64_t hash = UINT64_C(0xcbf29ce484222325);
+    hash ^= (uint64_t)kind;
+    hash *= UINT64_C(0x100000001b3);
+    for (size_t i = 0; i < length; i++) {
+        hash ^= (uint64_t)(unsigned char)key[i];
+        hash *= UINT64_C(0x100000001b3);
+    }
+    return (size_t)hash;
+}
+
+
+static size_t _tsearch_querycache_hash_slot(const void *slot)
+{
+    return (*(_tsearch_querycache_entry *const *)slot)->hash;
+}
+
+
+static bool _tsearch_querycache_is_slot_empty(const void *slot)
+{
+    return (*(_tsearch_querycache_entry *const *)slot == NULL) ? true : false;
+}
+
+
+static bool _tsearch_querycache_slot_has_key(const void *slot, const void *key)
+{
+    const _tsearch_querycache_entry *entry = *(_tsearch_querycache_entry *const *)slot;
+    const _tsearch_querycache_key *search = key;
+    return (entry->hash == search->hash && entry->kind == search->kind && entry->length == search->length &&
+            memcmp(entry->key, search->key, search->length) == 0) ? true : false;
+}
+
+
+/// Returns the index of the search's slot or, if the search isn't in the cache, of the empty slot
+/// where it belongs.
+static size_t _tsearch_querycache_find_slot(const _tsearch_querycache *cache, const _tsearch_querycache_key *key)
+{
+    return _tsearch_hashtable_find(&(cache->table), key, key->hash);
+}
+
+
+/// Returns the slot's entry, or NULL if the slot is empty.
+static _tsearch_querycache_entry * _tsearch_querycache_get_entry(const _tsearch_querycache *cache,
+                                                                 const size_t slotIndex)
+{
+    return *(_tsearch_querycache_entry **)_tsearch_hashtable_get_slot(&(cache->table), slotIndex);
+}
+
+
+/// Returns true if the cache can take byteLength more bytes without going past its limit.
+static bool _tsearch_querycache_fits(const _tsearch_querycache *cache, const size_t byteLength)
+{
+    size_t currentByteLength = _tsearch_querycache_get_byte_length(cache);
+    if (currentByteLength > cache->maxByteLength) { return false; }
+    return (byteLength <= cache->maxByteLength - currentByteLength);
+}
+
+
+static void _tsearch_querycache_make_newest(_tsearch_querycache *cache, _tsearch_querycache_entry *entry)
+{
+    entry->newer = NULL;
+    entry->older = cache->newest;
+    if (cache->newest != NULL) { cache->newest->newer = entry; }
+    cache->newest = entry;
+    if (cache->oldest == NULL) { cache->oldest = entry; }
+}
+
+
+static void _tsearch_querycache_unlink(_tsearch_querycache *cache, _tsearch_querycache_entry *entry)
+{
+    if (entry->newer != NULL) { entry->newer->older = entry->older; }
+    else { cache->newest = entry->older; }
+
+    if (entry->older != NULL) { entry->older->newer = entry->newer; }
+    else { cache->oldest = entry->newer; }
+
+    entry->newer = NULL;
+    entry->older = NULL;
+}
+
+
+/// Frees the slot's entry and removes the slot.
+static void _tsearch_querycache_remove_slot(_tsearch_querycache *cache, size_t slotIndex)
+{
+    _tsearch_querycache_entry *entry = _tsearch_querycache_get_entry(cache, slotIndex);
+    _tsearch_querycache_unlink(cache, entry);
+    cache->entriesByteLength -= entry->byteLength;
+    tsearch_countedset_free(entry->results);
+    free(entry);
+    _tsearch_hashtable_remove(&(cache->table), slotIndex);
+}
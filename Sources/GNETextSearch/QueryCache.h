@@ -0,0 +1,71 @@
+//
+//  QueryCache.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_querycache_h
+#define tsearch_querycache_h
+
+#include <GNETextSearch/CountedSet.h>
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum _tsearch_querycache_kind
+{
+    _tsearch_querycache_kind_prefix,
+    _tsearch_querycache_kind_partial,
+    _tsearch_querycache_kind_subsequence,
+    _tsearch_querycache_kind_suffix,
+} _tsearch_querycache_kind;
+
+/// A hash table mapping searches, identified by their kind and the bytes they searched for, to copies
+/// of their results. The table keeps its searches in the order they were last used, and when adding
+/// results would take it past its byte limit, the least recently used results are evicted first.
+/// The cache doesn't know when its results go stale, so its owner must remove them all whenever
+/// the searched tree changes.
+typedef struct _tsearch_querycache _tsearch_querycache;
+
+/// Creates an empty cache that never takes more than maxByteLength bytes.
+_tsearch_querycache * _tsearch_querycache_init(const size_t maxByteLength);
+void _tsearch_querycache_free(_tsearch_querycache *cache);
+
+/// Returns the number of searches in the cache.
+size_t _tsearch_querycache_get_count(const _tsearch_querycache *cache);
+
+/// Returns the number of bytes taken by the cache's table, searches, and results.
+size_t _tsearch_querycache_get_byte_length(const _tsearch_querycache *cache);
+
+size_t _tsearch_querycache_get_hit_count(const _tsearch_querycache *cache);
+size_t _tsearch_querycache_get_miss_count(const _tsearch_querycache *cache);
+
+/// Returns the number of searches removed to make room for others, not counting the ones removed
+/// by _tsearch_querycache_remove_all().
+size_t _tsearch_querycache_get_eviction_count(const _tsearch_querycache *cache);
+
+/// If the search is in the cache, writes a copy of its results, or NULL if nothing matched, marks
+/// the search as the most recently used, and returns true. Otherwise, or if the results can't be
+/// copied, returns false and counts a miss.
+bool _tsearch_querycache_copy(_tsearch_querycache *cache, const _tsearch_querycache_kind kind,
+                              const char *key, const size_t length, tsearch_countedset_ptr *outResults);
+
+/// Adds a copy of the search's results, which may be NULL if nothing matched, as the most recently
+/// used search. Searches are evicted until the results fit, and results larger than the cache's
+/// limit aren't added. Does nothing if the search is already in the cache.
+/// Returns failure if allocation fails, in which case the results aren't added.
+result _tsearch_querycache_insert(_tsearch_querycache *cache, const _tsearch_querycache_kind kind,
+                                  const char *key, const size_t length, const tsearch_countedset_ptr results);
+
+/// Removes every search from the cache without counting them as evictions.
+void _tsearch_querycache_remove_all(_tsearch_querycache *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_querycache_h */
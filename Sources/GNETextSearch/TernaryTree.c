@@ -7,9 +7,17 @@
 //
 
 #include <GNETextSearch/TernaryTree.h>
+#include "CountedSetPrivate.h"
+#include "DocumentIndex.h"
+#include "FrozenTreePrivate.h"
+#include "PrefixIndex.h"
+#include "QueryCache.h"
 #include "StringBuffer.h"
+#include "Tokenize.h"
+#include "TrigramIndex.h"
 #include "GNETextSearchPrivate.h"
 #include <stdio.h>
+#include <string.h>
 
 // ------------------------------------------------------------------------------------------
 
@@ -17,6 +25,10 @@ typedef int callback_signal;
 #define callback_continue 0
 #define callback_stop 1
 typedef callback_signal(*reverse_search_func)(const char character, const size_t index, const void *context);
+typedef result(*document_ids_func)(const tsearch_countedset_ptr documentIDs, void *context);
+typedef result(*node_func)(const tsearch_ternarytree_ptr ptr, const size_t depth, void *context);
+typedef result(*search_func)(const tsearch_ternarytree_ptr ptr, const char *target, const size_t length,
+                             tsearch_countedset_ptr *outResults);
 
 typedef struct _tsearch_string_search
 {
@@ -32,29 +44,204 @@ typedef struct _tsearch_partial_search_item
     size_t currentIndex;
 } _tsearch_partial_search_item;
 
+typedef enum _tsearch_ternarytree_branch
+{
+    _tsearch_ternarytree_branch_parent,
+    _tsearch_ternarytree_branch_lower,
+    _tsearch_ternarytree_branch_same,
+    _tsearch_ternarytree_branch_higher,
+} _tsearch_ternarytree_branch;
+
+typedef struct _tsearch_ternarytree_removal
+{
+    tsearch_ternarytree_ptr root;
+    tsearch_countedset_ptr removedIDs;
+} _tsearch_ternarytree_removal;
+
+typedef struct _tsearch_ternarytree_prefix_indexing
+{
+    _tsearch_prefixindex *index;
+    size_t length;
+    size_t count; // The number of nodes ending prefixes of the length.
+} _tsearch_ternarytree_prefix_indexing;
+
+typedef struct _tsearch_ternarytree_freeze_item
+{
+    tsearch_ternarytree_ptr node;
+    uint32_t *link; // The parent's child index, which is set once the node's index is known.
+} _tsearch_ternarytree_freeze_item;
+
+typedef struct _tsearch_ternarytree_build_item
+{
+    tsearch_ternarytree_ptr node;
+    size_t start, end; // The range of sorted entries whose characters the node's branches hold.
+    size_t depth;
+} _tsearch_ternarytree_build_item;
+
+typedef struct _tsearch_ternarytree_document_term
+{
+    const char *characters; // Points into the document's text, so it isn't null-terminated.
+    size_t length;
+    size_t count;
+} _tsearch_ternarytree_document_term;
+
+typedef struct _tsearch_ternarytree_document_terms
+{
+    _tsearch_ternarytree_document_term *terms;
+    size_t count;
+    size_t capacity;
+    size_t maxLength;
+    result status;
+} _tsearch_ternarytree_document_terms;
+
+typedef struct _tsearch_ternarytree_document_id_sets
+{
+    tsearch_countedset_ptr *sets; // Borrowed from the tree's nodes.
+    size_t count;
+    size_t capacity;
+} _tsearch_ternarytree_document_id_sets;
+
+typedef struct _tsearch_ternarytree_node_pool _tsearch_ternarytree_node_pool;
+typedef struct _tsearch_ternarytree_root _tsearch_ternarytree_root;
+
+#define TSEARCH_TERNARYTREE_DEFAULT_NODES_PER_CHUNK 4096
+
 // ------------------------------------------------------------------------------------------
 
 static bool _tsearch_cstring_is_nonempty(const char *string);
+static _tsearch_ternarytree_root * _tsearch_ternarytree_get_root(const tsearch_ternarytree_ptr ptr);
+static tsearch_ternarytree_ptr _tsearch_ternarytree_node_init(const tsearch_ternarytree_ptr root,
+                                                              const tsearch_ternarytree_ptr parent);
+static void _tsearch_ternarytree_node_release(const tsearch_ternarytree_ptr root, const tsearch_ternarytree_ptr ptr);
+static void _tsearch_ternarytree_node_pool_free(_tsearch_ternarytree_node_pool *pool);
+static _tsearch_ternarytree_branch _tsearch_ternarytree_branch_of_child(const tsearch_ternarytree_ptr parent,
+                                                                       const tsearch_ternarytree_ptr child);
+static result _tsearch_ternarytree_visit_nodes(const tsearch_ternarytree_ptr ptr, const size_t maxDepth,
+                                               const node_func enter, const node_func leave, void *context);
+static void _tsearch_ternarytree_prune_node_if_empty(const tsearch_ternarytree_ptr root,
+                                                     const tsearch_ternarytree_ptr ptr);
+static void _tsearch_ternarytree_prune_empty_nodes_from(const tsearch_ternarytree_ptr root,
+                                                        const tsearch_ternarytree_ptr ptr);
+static tsearch_ternarytree_ptr _tsearch_ternarytree_insert_word_nodes(const tsearch_ternarytree_ptr root,
+                                                                      const char *word);
+static result _tsearch_ternarytree_add_document_id(const tsearch_ternarytree_ptr root,
+                                                   const tsearch_ternarytree_ptr ptr,
+                                                   const GNEInteger documentID, const size_t count);
+static result _tsearch_ternarytree_remove_document_ids(const tsearch_ternarytree_ptr ptr,
+                                                       const GNEInteger *documentIDs,
+                                                       const size_t count);
+static result _tsearch_ternarytree_remove_ints_in_set_from_node(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                                void *context);
+static result _tsearch_ternarytree_prune_removed_node(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                      void *context);
+static result _tsearch_ternarytree_index_node(const tsearch_ternarytree_ptr ptr, const size_t depth, void *context);
+static result _tsearch_ternarytree_remove_indexed(const tsearch_ternarytree_ptr root,
+                                                  _tsearch_documentindex *index,
+                                                  const GNEInteger documentID);
+static result _tsearch_ternarytree_index_prefixes_of_length(const tsearch_ternarytree_ptr root,
+                                                            _tsearch_prefixindex *index,
+                                                            const size_t length, size_t *outCount);
+static result _tsearch_ternarytree_index_prefix_node(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                     void *context);
+static void _tsearch_ternarytree_add_to_prefix_index(const tsearch_ternarytree_ptr root,
+                                                     const tsearch_ternarytree_ptr ptr,
+                                                     const GNEInteger documentID, const size_t count);
+static void _tsearch_ternarytree_remove_from_prefix_index(const tsearch_ternarytree_ptr root,
+                                                          const tsearch_ternarytree_ptr ptr,
+                                                          const GNEInteger documentID);
+static void _tsearch_ternarytree_add_to_suffix_index(const tsearch_ternarytree_ptr root,
+                                                     const tsearch_ternarytree_ptr ptr,
+                                                     const GNEInteger documentID, const size_t count);
+static result _tsearch_ternarytree_index_reversed_words(const tsearch_ternarytree_ptr root,
+                                                        const tsearch_ternarytree_ptr reversedTree);
+static result _tsearch_ternarytree_index_reversed_word(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                       void *context);
+static void _tsearch_ternarytree_remove_suffix_index(const tsearch_ternarytree_ptr root);
+static char * _tsearch_ternarytree_copy_reversed_word(const tsearch_ternarytree_ptr ptr);
+static void _tsearch_ternarytree_add_to_trigram_index(const tsearch_ternarytree_ptr root,
+                                                      const tsearch_ternarytree_ptr ptr);
+static result _tsearch_ternarytree_index_trigrams(const tsearch_ternarytree_ptr root, _tsearch_trigramindex *index);
+static result _tsearch_ternarytree_index_word_trigrams(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                       void *context);
+static result _tsearch_ternarytree_update_trigram_index(_tsearch_trigramindex *index,
+                                                        const tsearch_ternarytree_ptr ptr, const bool shouldAdd);
+static uint32_t _tsearch_ternarytree_make_gram(const char first, const char second, const char third);
+static tsearch_ternarytree_ptr _tsearch_ternarytree_get_shorter_prefix_node(const tsearch_ternarytree_ptr ptr,
+                                                                            bool *isOnlyWord);
+static bool _tsearch_ternarytree_get_indexed_prefix_results(const tsearch_ternarytree_ptr root,
+                                                            const char *prefix,
+                                                            const tsearch_ternarytree_ptr foundPtr,
+                                                            tsearch_countedset_ptr *outResults);
+static size_t _tsearch_ternarytree_get_node_count(const tsearch_ternarytree_ptr ptr);
+static result _tsearch_ternarytree_count_node(const tsearch_ternarytree_ptr ptr, const size_t depth, void *context);
+static result _tsearch_ternarytree_copy_sorted_entries(const tsearch_ternarytree_entry *entries,
+                                                       const size_t count,
+                                                       tsearch_ternarytree_entry **outEntries,
+                                                       size_t *outCount);
+static int _tsearch_ternarytree_entry_compare(const void *valuePtr1, const void *valuePtr2);
+static size_t _tsearch_ternarytree_get_node_count_for_sorted_entries(const tsearch_ternarytree_entry *entries,
+                                                                     const size_t count);
+static result _tsearch_ternarytree_build_from_sorted_entries(const tsearch_ternarytree_ptr root,
+                                                             const tsearch_ternarytree_entry *entries,
+                                                             const size_t count,
+                                                             const size_t nodeCount);
+static void _tsearch_ternarytree_get_median_character_range(const tsearch_ternarytree_entry *entries,
+                                                            const size_t start, const size_t end,
+                                                            const size_t depth,
+                                                            size_t *outStart, size_t *outEnd);
+static void _tsearch_ternarytree_add_document_term(const char *string, const tsearch_range range,
+                                                  uint32_t *token, const size_t length, const void *context);
+static int _tsearch_ternarytree_document_term_compare(const void *valuePtr1, const void *valuePtr2);
+static size_t _tsearch_ternarytree_merge_document_terms(_tsearch_ternarytree_document_term *terms,
+                                                        const size_t count);
+static result _tsearch_ternarytree_insert_document_terms(const tsearch_ternarytree_ptr root,
+                                                         const _tsearch_ternarytree_document_term *terms,
+                                                         const size_t count, const size_t maxLength,
+                                                         const GNEInteger documentID);
 tsearch_ternarytree_ptr _tsearch_ternarytree_search(tsearch_ternarytree_ptr ptr, const char *target);
-result _tsearch_ternarytree_copy_words_from_node(const tsearch_ternarytree_ptr ptr, tsearch_countedset_ptr results);
-static result _tsearch_build_prefix_table(const char *target, const size_t length, size_t **outTable);
-static size_t _tsearch_kmp_next_index(const char *target,
-                                      const size_t *prefixTable,
-                                      size_t currentIndex,
-                                      const char character);
+static result _tsearch_ternarytree_copy_prefix_document_ids(const tsearch_ternarytree_ptr ptr,
+                                                            tsearch_countedset_ptr *outDocumentIDs);
+static tsearch_countedset_ptr _tsearch_ternarytree_copy_cached_search_results(const tsearch_ternarytree_ptr ptr,
+                                                                              const _tsearch_querycache_kind kind,
+                                                                              const char *target,
+                                                                              const size_t length,
+                                                                              const search_func func);
+static result _tsearch_ternarytree_copy_prefix_matches(const tsearch_ternarytree_ptr ptr, const char *prefix,
+                                                       const size_t length, tsearch_countedset_ptr *outResults);
+static result _tsearch_ternarytree_copy_partial_matches(const tsearch_ternarytree_ptr ptr, const char *target,
+                                                        const size_t length, tsearch_countedset_ptr *outResults);
+static result _tsearch_ternarytree_copy_subsequence_matches(const tsearch_ternarytree_ptr ptr, const char *target,
+                                                            const size_t length, tsearch_countedset_ptr *outResults);
+static result _tsearch_ternarytree_copy_suffix_matches(const tsearch_ternarytree_ptr ptr, const char *suffix,
+                                                       const size_t length, tsearch_countedset_ptr *outResults);
+static result _tsearch_ternarytree_copy_trigram_matches(_tsearch_trigramindex *index, const char *target,
+                                                       const size_t length, tsearch_countedset_ptr *outResults);
+static bool _tsearch_ternarytree_word_contains_reversed(const tsearch_ternarytree_ptr ptr,
+                                                        const char *reversedTarget, const size_t length,
+                                                        const size_t *prefixTable);
+static result _tsearch_ternarytree_copy_reversed_prefix_matches(const tsearch_ternarytree_ptr reversedTree,
+                                                                const char *suffix, const size_t length,
+                                                                tsearch_countedset_ptr *outResults);
+static result _tsearch_ternarytree_take_document_id_sets(_tsearch_ternarytree_document_id_sets *sets,
+                                                         tsearch_countedset_ptr *outResults);
+result _tsearch_ternarytree_copy_words_from_node(const tsearch_ternarytree_ptr ptr,
+                                                 _tsearch_ternarytree_document_id_sets *results);
+static result _tsearch_ternarytree_visit_document_ids_from_node(const tsearch_ternarytree_ptr ptr,
+                                                                const document_ids_func func, void *context);
+static result _tsearch_ternarytree_append_document_id_set(const tsearch_countedset_ptr documentIDs, void *context);
 result _tsearch_ternarytree_find_partial_match(const tsearch_ternarytree_ptr ptr,
                                                const char *target,
                                                const size_t length,
                                                const size_t *prefixTable,
                                                size_t currentIndex,
-                                               tsearch_countedset_ptr results);
+                                               _tsearch_ternarytree_document_id_sets *results);
 result _tsearch_ternarytree_find_subsequence_match(const tsearch_ternarytree_ptr ptr,
                                                    const char *target,
                                                    const size_t length,
                                                    size_t currentIndex,
-                                                   tsearch_countedset_ptr results);
+                                                   _tsearch_ternarytree_document_id_sets *results);
 result _tsearch_ternarytree_find_suffix(const tsearch_ternarytree_ptr ptr, const char *suffix,
-                                        const size_t length, tsearch_countedset_ptr results);
+                                        const size_t length, _tsearch_ternarytree_document_id_sets *results);
 result _tsearch_ternarytree_reverse_search_from_node(tsearch_ternarytree_ptr ptr, reverse_search_func callback,
                                                      void *context);
 result _tsearch_ternarytree_copy_contents(tsearch_ternarytree_ptr ptr, tsearch_stringbuf_ptr contentsPtr);
@@ -83,18 +270,107 @@ typedef struct tsearch_ternarytree_node
 } tsearch_ternarytree_node;
 
 
+typedef struct _tsearch_ternarytree_node_chunk
+{
+    struct _tsearch_ternarytree_node_chunk *next;
+    size_t count; // The number of nodes that have been carved out of this chunk.
+    size_t capacity;
+    tsearch_ternarytree_node nodes[];
+} _tsearch_ternarytree_node_chunk;
+
+
+struct _tsearch_ternarytree_node_pool
+{
+    _tsearch_ternarytree_node_chunk *chunks;
+    tsearch_ternarytree_ptr freeNodes; // Released nodes, linked through their parent pointers.
+    size_t nodesPerChunk;
+};
+
+
+/// The root node is the tree's public handle. It is allocated together with the state that
+/// belongs to the whole tree, so every public function can reach that state from its pointer.
+struct _tsearch_ternarytree_root
+{
+    tsearch_ternarytree_node node;
+    _tsearch_ternarytree_node_pool *pool;
+    _tsearch_documentindex *documentIndex; // NULL unless the document index has been enabled.
+    _tsearch_prefixindex *prefixIndex; // NULL unless the prefix index has been enabled.
+    size_t prefixIndexMaxLength;
+    size_t prefixHitCount;
+    size_t prefixMissCount;
+    _tsearch_querycache *queryCache; // NULL unless the query cache has been enabled.
+    tsearch_ternarytree_ptr reversedTree; // NULL unless the suffix index has been enabled.
+    _tsearch_trigramindex *trigramIndex; // NULL unless the trigram index has been enabled.
+};
+
+
 tsearch_ternarytree_ptr tsearch_ternarytree_init(void)
 {
-    tsearch_ternarytree_ptr ptr = calloc(1, sizeof(tsearch_ternarytree_node));
-    if (ptr == NULL) { return ptr; }
+    _tsearch_ternarytree_root *root = calloc(1, sizeof(_tsearch_ternarytree_root));
+    if (root == NULL) { return NULL; }
 
+    tsearch_ternarytree_ptr ptr = &(root->node);
     ptr->character = '\0';
     ptr->parent = NULL;
     ptr->lower = NULL;
     ptr->same = NULL;
     ptr->higher = NULL;
     ptr->documentIDs = NULL;
+    root->pool = NULL;
+    root->documentIndex = NULL;
+    root->prefixIndex = NULL;
+    root->prefixIndexMaxLength = 0;
+    root->prefixHitCount = 0;
+    root->prefixMissCount = 0;
+    root->queryCache = NULL;
+    root->reversedTree = NULL;
+    root->trigramIndex = NULL;
+
+    return ptr;
+}
 
+
+tsearch_ternarytree_ptr tsearch_ternarytree_init_with_node_pool(const size_t nodesPerChunk)
+{
+    _tsearch_ternarytree_node_pool *pool = calloc(1, sizeof(_tsearch_ternarytree_node_pool));
+    if (pool == NULL) { return NULL; }
+
+    tsearch_ternarytree_ptr ptr = tsearch_ternarytree_init();
+    if (ptr == NULL) { free(pool); return NULL; }
+
+    pool->chunks = NULL;
+    pool->freeNodes = NULL;
+    pool->nodesPerChunk = (nodesPerChunk == 0) ? TSEARCH_TERNARYTREE_DEFAULT_NODES_PER_CHUNK : nodesPerChunk;
+    _tsearch_ternarytree_get_root(ptr)->pool = pool;
+
+    return ptr;
+}
+
+
+tsearch_ternarytree_ptr tsearch_ternarytree_init_with_entries(const tsearch_ternarytree_entry *entries,
+                                                              const size_t count)
+{
+    if (entries == NULL && count > 0) { return NULL; }
+
+    tsearch_ternarytree_entry *sorted = NULL;
+    size_t sortedCount = 0;
+    if (_tsearch_ternarytree_copy_sorted_entries(entries, count, &sorted, &sortedCount) == failure) {
+        return NULL;
+    }
+
+    // The root is allocated with the tree, so the pool's first chunk is sized to hold every other node.
+    size_t nodeCount = _tsearch_ternarytree_get_node_count_for_sorted_entries(sorted, sortedCount);
+    tsearch_ternarytree_ptr ptr = tsearch_ternarytree_init_with_node_pool((nodeCount > 1) ? nodeCount - 1 : 0);
+    if (ptr == NULL) { free(sorted); return NULL; }
+
+    if (_tsearch_ternarytree_build_from_sorted_entries(ptr, sorted, sortedCount, nodeCount) == failure) {
+        tsearch_ternarytree_free(ptr);
+        free(sorted);
+        return NULL;
+    }
+
+    _tsearch_ternarytree_get_root(ptr)->pool->nodesPerChunk = TSEARCH_TERNARYTREE_DEFAULT_NODES_PER_CHUNK;
+    free(sorted);
     return ptr;
 }
 
@@ -103,6 +379,25 @@ void tsearch_ternarytree_free(const tsearch_ternarytree_ptr ptr)
 {
     if (ptr == NULL) { return; }
 
+    _tsearch_documentindex_free(_tsearch_ternarytree_get_root(ptr)->documentIndex);
+    _tsearch_ternarytree_get_root(ptr)->documentIndex = NULL;
+    _tsearch_prefixindex_free(_tsearch_ternarytree_get_root(ptr)->prefixIndex);
+    _tsearch_ternarytree_get_root(ptr)->prefixIndex = NULL;
+    _tsearch_querycache_free(_tsearch_ternarytree_get_root(ptr)->queryCache);
+    _tsearch_ternarytree_get_root(ptr)->queryCache = NULL;
+    _tsearch_ternarytree_remove_suffix_index(ptr);
+    _tsearch_trigramindex_free(_tsearch_ternarytree_get_root(ptr)->trigramIndex);
+    _tsearch_ternarytree_get_root(ptr)->trigramIndex = NULL;
+
+    _tsearch_ternarytree_node_pool *pool = _tsearch_ternarytree_get_root(ptr)->pool;
+    if (pool != NULL) {
+        _tsearch_ternarytree_node_pool_free(pool);
+        tsearch_countedset_free(ptr->documentIDs);
+        ptr->documentIDs = NULL;
+        free(ptr);
+        return;
+    }
+
     tsearch_ternarytree_ptr stopParent = ptr->parent;
     tsearch_ternarytree_ptr previous = stopParent;
     tsearch_ternarytree_ptr current = ptr;
@@ -150,187 +445,269 @@ tsearch_ternarytree_ptr tsearch_ternarytree_insert(tsearch_ternarytree_ptr ptr,
         if (ptr == NULL) { return ptr; }
     }
 
-    tsearch_ternarytree_ptr root = ptr;
-    tsearch_ternarytree_ptr node = ptr;
-    const char *cursor = newCharacter;
+    _tsearch_querycache_remove_all(_tsearch_ternarytree_get_root(ptr)->queryCache);
 
-    while (true) {
-        if (node->character == '\0') { node->character = *cursor; }
+    tsearch_ternarytree_ptr node = _tsearch_ternarytree_insert_word_nodes(ptr, newCharacter);
+    if (node != NULL) { (void)_tsearch_ternarytree_add_document_id(ptr, node, documentID, 1); }
+    return ptr;
+}
 
-        if (*cursor < node->character) {
-            if (node->lower == NULL) {
-                node->lower = tsearch_ternarytree_init();
-                if (node->lower == NULL) { return root; }
-                node->lower->parent = node;
-            }
-            node = node->lower;
-            continue;
-        }
 
-        if (*cursor > node->character) {
-            if (node->higher == NULL) {
-                node->higher = tsearch_ternarytree_init();
-                if (node->higher == NULL) { return root; }
-                node->higher->parent = node;
-            }
-            node = node->higher;
-            continue;
-        }
+result tsearch_ternarytree_insert_document(const tsearch_ternarytree_ptr ptr,
+                                          const char *utf8Text,
+                                          const GNEInteger documentID)
+{
+    if (ptr == NULL || utf8Text == NULL) { return failure; }
 
-        if (cursor[1] == '\0') {
-            if (node->documentIDs == NULL) {
-                node->documentIDs = tsearch_countedset_init();
-                if (node->documentIDs == NULL) { return root; }
-            }
+    _tsearch_querycache_remove_all(_tsearch_ternarytree_get_root(ptr)->queryCache);
 
-            (void)tsearch_countedset_add_int(node->documentIDs, documentID);
-            return root;
-        }
+    _tsearch_ternarytree_document_terms terms = {NULL, 0, 64, 0, success};
+    terms.terms = calloc(terms.capacity, sizeof(_tsearch_ternarytree_document_term));
+    if (terms.terms == NULL) { return failure; }
 
-        cursor += 1;
-        if (node->same == NULL) {
-            node->same = tsearch_ternarytree_init();
-            if (node->same == NULL) { return root; }
-            node->same->parent = node;
-        }
-        node = node->same;
+    if (tsearch_cstring_tokenize(utf8Text, _tsearch_ternarytree_add_document_term, &terms) == failure ||
+        terms.status == failure) {
+        free(terms.terms);
+        return failure;
     }
+
+    qsort(terms.terms, terms.count, sizeof(_tsearch_ternarytree_document_term),
+          _tsearch_ternarytree_document_term_compare);
+    size_t termCount = _tsearch_ternarytree_merge_document_terms(terms.terms, terms.count);
+
+    result ret = _tsearch_ternarytree_insert_document_terms(ptr, terms.terms, termCount,
+                                                            terms.maxLength, documentID);
+    free(terms.terms);
+    return ret;
 }
 
 
-result tsearch_ternarytree_remove(const tsearch_ternarytree_ptr ptr, const GNEInteger documentID)
+result tsearch_ternarytree_enable_document_index(const tsearch_ternarytree_ptr ptr)
 {
-    if (ptr == NULL) { return success; }
+    if (ptr == NULL) { return failure; }
+    if (_tsearch_ternarytree_get_root(ptr)->documentIndex != NULL) { return success; }
 
-    tsearch_ternarytree_ptr stopParent = ptr->parent;
-    tsearch_ternarytree_ptr previous = stopParent;
-    tsearch_ternarytree_ptr current = ptr;
+    _tsearch_documentindex *index = _tsearch_documentindex_init();
+    if (index == NULL) { return failure; }
 
-    while (current != stopParent) {
-        tsearch_ternarytree_ptr next = NULL;
+    if (_tsearch_ternarytree_visit_nodes(ptr, SIZE_MAX, _tsearch_ternarytree_index_node, NULL, index) == failure) {
+        _tsearch_documentindex_free(index);
+        return failure;
+    }
 
-        if (previous == current->parent) {
-            if (_tsearch_ternarytree_has_valid_document_ids(current) == true &&
-                tsearch_countedset_remove_int(current->documentIDs, documentID) == failure) {
-                return failure;
-            }
+    _tsearch_ternarytree_get_root(ptr)->documentIndex = index;
 
-            if (current->lower != NULL) { next = current->lower; }
-            else if (current->same != NULL) { next = current->same; }
-            else if (current->higher != NULL) { next = current->higher; }
-            else { next = current->parent; }
-        } else if (previous == current->lower) {
-            if (current->same != NULL) { next = current->same; }
-            else if (current->higher != NULL) { next = current->higher; }
-            else { next = current->parent; }
-        } else if (previous == current->same) {
-            if (current->higher != NULL) { next = current->higher; }
-            else { next = current->parent; }
-        } else {
-            next = current->parent;
-        }
+    // Without its own index, the suffix index would still visit every one of its nodes on removal.
+    // It works either way, so failing to index it isn't reported.
+    tsearch_ternarytree_ptr reversedTree = _tsearch_ternarytree_get_root(ptr)->reversedTree;
+    if (reversedTree != NULL) { (void)tsearch_ternarytree_enable_document_index(reversedTree); }
+    return success;
+}
 
-        previous = current;
-        current = next;
+
+result tsearch_ternarytree_enable_prefix_index(const tsearch_ternarytree_ptr ptr,
+                                               const size_t maxLength, const size_t maxByteLength)
+{
+    if (ptr == NULL) { return failure; }
+
+    _tsearch_ternarytree_root *root = _tsearch_ternarytree_get_root(ptr);
+    _tsearch_prefixindex_free(root->prefixIndex);
+    root->prefixIndex = NULL;
+    root->prefixIndexMaxLength = 0;
+    root->prefixHitCount = 0;
+    root->prefixMissCount = 0;
+    if (maxLength == 0) { return success; }
+
+    _tsearch_prefixindex *index = _tsearch_prefixindex_init(maxByteLength);
+    if (index == NULL) { return failure; }
+
+    // Shorter prefixes are indexed first, because they match the most words and are the slowest
+    // to search without the index, so they're the ones kept when the index runs out of room.
+    for (size_t length = 1; length <= maxLength; length++) {
+        size_t count = 0;
+        if (_tsearch_ternarytree_index_prefixes_of_length(ptr, index, length, &count) == failure) {
+            _tsearch_prefixindex_free(index);
+            return failure;
+        }
+        if (count == 0) { break; }
     }
 
+    root->prefixIndex = index;
+    root->prefixIndexMaxLength = maxLength;
     return success;
 }
 
 
-tsearch_countedset_ptr tsearch_ternarytree_copy_search_results(const tsearch_ternarytree_ptr ptr, const char *target)
+result tsearch_ternarytree_get_prefix_index_stats(const tsearch_ternarytree_ptr ptr,
+                                                  tsearch_ternarytree_prefix_index_stats *outStats)
 {
-    if (ptr == NULL || !_tsearch_cstring_is_nonempty(target)) { return NULL; }
+    if (ptr == NULL || outStats == NULL) { return failure; }
 
-    tsearch_ternarytree_ptr foundPtr = _tsearch_ternarytree_search(ptr, target);
-    bool hasResults = _tsearch_ternarytree_has_valid_document_ids(foundPtr);
-    return (hasResults == true) ? tsearch_countedset_copy(foundPtr->documentIDs) : NULL;
+    _tsearch_ternarytree_root *root = _tsearch_ternarytree_get_root(ptr);
+    outStats->prefixCount = _tsearch_prefixindex_get_count(root->prefixIndex);
+    outStats->byteLength = _tsearch_prefixindex_get_byte_length(root->prefixIndex);
+    outStats->hitCount = root->prefixHitCount;
+    outStats->missCount = root->prefixMissCount;
+    return success;
 }
 
 
-tsearch_countedset_ptr tsearch_ternarytree_copy_prefix_search_results(const tsearch_ternarytree_ptr ptr, const char *prefix)
+result tsearch_ternarytree_enable_suffix_index(const tsearch_ternarytree_ptr ptr)
 {
-    if (ptr == NULL || !_tsearch_cstring_is_nonempty(prefix)) { return NULL; }
+    if (ptr == NULL) { return failure; }
 
-    tsearch_ternarytree_ptr foundPtr = _tsearch_ternarytree_search(ptr, prefix);
-    if (foundPtr == NULL) { return NULL; }
+    _tsearch_ternarytree_root *root = _tsearch_ternarytree_get_root(ptr);
+    if (root->reversedTree != NULL) { return success; }
 
-    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
-    if (resultsPtr == NULL) { return NULL; }
+    tsearch_ternarytree_ptr reversedTree = (root->pool != NULL) ?
+        tsearch_ternarytree_init_with_node_pool(root->pool->nodesPerChunk) : tsearch_ternarytree_init();
+    if (reversedTree == NULL) { return failure; }
 
-    if (_tsearch_ternarytree_has_valid_document_ids(foundPtr) == true) {
-        if (tsearch_countedset_union(resultsPtr, foundPtr->documentIDs) == failure) {
-            tsearch_countedset_free(resultsPtr);
-            return NULL;
-        }
+    if (_tsearch_ternarytree_index_reversed_words(ptr, reversedTree) == failure) {
+        tsearch_ternarytree_free(reversedTree);
+        return failure;
     }
 
-    if (_tsearch_ternarytree_copy_words_from_node(foundPtr->same, resultsPtr) == failure) {
-        tsearch_countedset_free(resultsPtr);
-        return NULL;
-    }
+    if (root->documentIndex != NULL) { (void)tsearch_ternarytree_enable_document_index(reversedTree); }
+    root->reversedTree = reversedTree;
+    return success;
+}
+
+
+result tsearch_ternarytree_enable_trigram_index(const tsearch_ternarytree_ptr ptr)
+{
+    if (ptr == NULL) { return failure; }
+
+    _tsearch_ternarytree_root *root = _tsearch_ternarytree_get_root(ptr);
+    if (root->trigramIndex != NULL) { return success; }
 
-    if (tsearch_countedset_get_count(resultsPtr) == 0) {
-        tsearch_countedset_free(resultsPtr);
-        resultsPtr = NULL;
+    _tsearch_trigramindex *index = _tsearch_trigramindex_init();
+    if (index == NULL) { return failure; }
+
+    if (_tsearch_ternarytree_index_trigrams(ptr, index) == failure) {
+        _tsearch_trigramindex_free(index);
+        return failure;
     }
 
-    return resultsPtr;
+    root->trigramIndex = index;
+    return success;
 }
 
 
-tsearch_countedset_ptr tsearch_ternarytree_copy_partial_search_results(const tsearch_ternarytree_ptr ptr,
-                                                                       const char *target,
-                                                                       const size_t length)
+result tsearch_ternarytree_enable_query_cache(const tsearch_ternarytree_ptr ptr, const size_t maxByteLength)
 {
-    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    if (ptr == NULL) { return failure; }
 
-    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
-    if (resultsPtr == NULL) { return  NULL; }
+    _tsearch_ternarytree_root *root = _tsearch_ternarytree_get_root(ptr);
+    _tsearch_querycache_free(root->queryCache);
+    root->queryCache = NULL;
+    if (maxByteLength == 0) { return success; }
 
-    size_t *prefixTable = NULL;
-    if (_tsearch_build_prefix_table(target, length, &prefixTable) == failure) {
-        tsearch_countedset_free(resultsPtr);
-        return NULL;
-    }
+    root->queryCache = _tsearch_querycache_init(maxByteLength);
+    return (root->queryCache != NULL) ? success : failure;
+}
 
-    if (_tsearch_ternarytree_find_partial_match(ptr, target, length, prefixTable, 0, resultsPtr) == failure) {
-        free(prefixTable);
-        tsearch_countedset_free(resultsPtr);
-        return NULL;
-    }
 
-    free(prefixTable);
+result tsearch_ternarytree_get_query_cache_stats(const tsearch_ternarytree_ptr ptr,
+                                                 tsearch_ternarytree_query_cache_stats *outStats)
+{
+    if (ptr == NULL || outStats == NULL) { return failure; }
+
+    _tsearch_querycache *cache = _tsearch_ternarytree_get_root(ptr)->queryCache;
+    outStats->entryCount = _tsearch_querycache_get_count(cache);
+    outStats->byteLength = _tsearch_querycache_get_byte_length(cache);
+    outStats->hitCount = _tsearch_querycache_get_hit_count(cache);
+    outStats->missCount = _tsearch_querycache_get_miss_count(cache);
+    outStats->evictionCount = _tsearch_querycache_get_eviction_count(cache);
+    return success;
+}
+
+
+result tsearch_ternarytree_remove(const tsearch_ternarytree_ptr ptr, const GNEInteger documentID)
+{
+    return tsearch_ternarytree_remove_many(ptr, &documentID, 1);
+}
 
-    if (tsearch_countedset_get_count(resultsPtr) == 0) {
-        tsearch_countedset_free(resultsPtr);
-        resultsPtr = NULL;
+
+result tsearch_ternarytree_remove_many(const tsearch_ternarytree_ptr ptr,
+                                       const GNEInteger *documentIDs,
+                                       const size_t count)
+{
+    if (ptr == NULL || count == 0) { return success; }
+    if (documentIDs == NULL) { return failure; }
+
+    _tsearch_querycache_remove_all(_tsearch_ternarytree_get_root(ptr)->queryCache);
+
+    // If either tree is left with only some of the documents removed, the suffix index no longer
+    // matches the tree, so it's removed and suffix searches visit the tree again.
+    result status = _tsearch_ternarytree_remove_document_ids(ptr, documentIDs, count);
+    tsearch_ternarytree_ptr reversedTree = _tsearch_ternarytree_get_root(ptr)->reversedTree;
+    if (reversedTree != NULL &&
+        (status == failure || tsearch_ternarytree_remove_many(reversedTree, documentIDs, count) == failure)) {
+        _tsearch_ternarytree_remove_suffix_index(ptr);
     }
+    return status;
+}
+
 
-    return resultsPtr;
+tsearch_countedset_ptr tsearch_ternarytree_copy_search_results(const tsearch_ternarytree_ptr ptr, const char *target)
+{
+    tsearch_countedset_ptr results = tsearch_ternarytree_get_search_results(ptr, target);
+    return (results == NULL) ? NULL : tsearch_countedset_copy(results);
 }
 
 
-tsearch_countedset_ptr tsearch_ternarytree_copy_subsequence_search_results(const tsearch_ternarytree_ptr ptr,
-                                                                           const char *target,
-                                                                           const size_t length)
+tsearch_countedset_ptr tsearch_ternarytree_get_search_results(const tsearch_ternarytree_ptr ptr, const char *target)
 {
-    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    if (ptr == NULL || !_tsearch_cstring_is_nonempty(target)) { return NULL; }
+
+    tsearch_ternarytree_ptr foundPtr = _tsearch_ternarytree_search(ptr, target);
+    bool hasResults = _tsearch_ternarytree_has_valid_document_ids(foundPtr);
+    return (hasResults == true) ? foundPtr->documentIDs : NULL;
+}
+
+
+tsearch_countedset_ptr tsearch_ternarytree_copy_prefix_search_results(const tsearch_ternarytree_ptr ptr, const char *prefix)
+{
+    if (ptr == NULL || !_tsearch_cstring_is_nonempty(prefix)) { return NULL; }
+    return _tsearch_ternarytree_copy_cached_search_results(ptr, _tsearch_querycache_kind_prefix, prefix,
+                                                           strlen(prefix), _tsearch_ternarytree_copy_prefix_matches);
+}
+
 
-    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
-    if (resultsPtr == NULL) { return NULL; }
+tsearch_countedset_ptr tsearch_ternarytree_get_prefix_search_results(const tsearch_ternarytree_ptr ptr,
+                                                                     const char *prefix)
+{
+    if (ptr == NULL || !_tsearch_cstring_is_nonempty(prefix)) { return NULL; }
+
+    tsearch_ternarytree_ptr foundPtr = _tsearch_ternarytree_search(ptr, prefix);
+    if (foundPtr == NULL) { return NULL; }
 
-    if (_tsearch_ternarytree_find_subsequence_match(ptr, target, length, 0, resultsPtr) == failure) {
-        tsearch_countedset_free(resultsPtr);
+    tsearch_countedset_ptr resultsPtr = NULL;
+    if (_tsearch_ternarytree_get_indexed_prefix_results(ptr, prefix, foundPtr, &resultsPtr) == false) {
         return NULL;
     }
+    return (tsearch_countedset_get_count(resultsPtr) > 0) ? resultsPtr : NULL;
+}
 
-    if (tsearch_countedset_get_count(resultsPtr) == 0) {
-        tsearch_countedset_free(resultsPtr);
-        resultsPtr = NULL;
-    }
 
-    return resultsPtr;
+tsearch_countedset_ptr tsearch_ternarytree_copy_partial_search_results(const tsearch_ternarytree_ptr ptr,
+                                                                       const char *target,
+                                                                       const size_t length)
+{
+    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    return _tsearch_ternarytree_copy_cached_search_results(ptr, _tsearch_querycache_kind_partial, target, length,
+                                                           _tsearch_ternarytree_copy_partial_matches);
+}
+
+
+tsearch_countedset_ptr tsearch_ternarytree_copy_subsequence_search_results(const tsearch_ternarytree_ptr ptr,
+                                                                           const char *target,
+                                                                           const size_t length)
+{
+    if (ptr == NULL || target == NULL || length == 0) { return NULL; }
+    return _tsearch_ternarytree_copy_cached_search_results(ptr, _tsearch_querycache_kind_subsequence, target, length,
+                                                           _tsearch_ternarytree_copy_subsequence_matches);
 }
 
 
@@ -339,21 +716,78 @@ tsearch_countedset_ptr tsearch_ternarytree_copy_suffix_search_results(const tsea
                                                                       const size_t length)
 {
     if (ptr == NULL || suffix == NULL || length == 0) { return NULL; }
+    return _tsearch_ternarytree_copy_cached_search_results(ptr, _tsearch_querycache_kind_suffix, suffix, length,
+                                                           _tsearch_ternarytree_copy_suffix_matches);
+}
 
-    tsearch_countedset_ptr resultsPtr = tsearch_countedset_init();
-    if (resultsPtr == NULL) { return NULL; }
 
-    if (_tsearch_ternarytree_find_suffix(ptr, suffix, length, resultsPtr) == failure) {
-        tsearch_countedset_free(resultsPtr);
+tsearch_frozentree_ptr tsearch_ternarytree_freeze(const tsearch_ternarytree_ptr ptr)
+{
+    if (ptr == NULL) { return NULL; }
+
+    size_t nodeCount = (ptr->character == '\0') ? 0 : _tsearch_ternarytree_get_node_count(ptr);
+    if (nodeCount >= TSEARCH_COMPACT_NONE) { return NULL; }
+    if (nodeCount == 0) { return _tsearch_frozentree_init_with_nodes(NULL, 0, NULL, 0); }
+
+    // The node count is known up front, so none of the buffers move and the stack items can point
+    // straight at the links they fill in. A preorder walk never holds more items than nodes.
+    _tsearch_compact_node *nodes = calloc(nodeCount, sizeof(_tsearch_compact_node));
+    tsearch_countedset_ptr *postings = calloc(nodeCount, sizeof(tsearch_countedset_ptr));
+    _tsearch_ternarytree_freeze_item *stack = calloc(nodeCount, sizeof(_tsearch_ternarytree_freeze_item));
+    if (nodes == NULL || postings == NULL || stack == NULL) {
+        free(nodes);
+        free(postings);
+        free(stack);
         return NULL;
     }
 
-    if (tsearch_countedset_get_count(resultsPtr) == 0) {
-        tsearch_countedset_free(resultsPtr);
-        resultsPtr = NULL;
+    uint32_t count = 0;
+    uint32_t postingsCount = 0;
+    size_t stackCount = 0;
+    stack[stackCount++] = (_tsearch_ternarytree_freeze_item){ptr, NULL};
+
+    // Each node's same branch is laid out right after it, because that's the branch every
+    // character of a match follows.
+    while (stackCount > 0) {
+        _tsearch_ternarytree_freeze_item item = stack[--stackCount];
+        tsearch_ternarytree_ptr node = item.node;
+        uint32_t index = count;
+        count += 1;
+
+        if (item.link != NULL) { *(item.link) = index; }
+
+        nodes[index] = (_tsearch_compact_node){
+            TSEARCH_COMPACT_NONE,
+            TSEARCH_COMPACT_NONE,
+            TSEARCH_COMPACT_NONE,
+            TSEARCH_COMPACT_NONE,
+            node->character,
+        };
+
+        if (_tsearch_ternarytree_has_valid_document_ids(node) == true) {
+            postings[postingsCount] = node->documentIDs;
+            nodes[index].postingsID = postingsCount;
+            postingsCount += 1;
+        }
+
+        if (node->higher != NULL) {
+            stack[stackCount++] = (_tsearch_ternarytree_freeze_item){node->higher, &(nodes[index].higher)};
+        }
+        if (node->lower != NULL) {
+            stack[stackCount++] = (_tsearch_ternarytree_freeze_item){node->lower, &(nodes[index].lower)};
+        }
+        if (node->same != NULL) {
+            stack[stackCount++] = (_tsearch_ternarytree_freeze_item){node->same, &(nodes[index].same)};
+        }
     }
 
-    return resultsPtr;
+    tsearch_frozentree_ptr frozenPtr = _tsearch_frozentree_init_with_nodes(nodes, count, postings, postingsCount);
+
+    free(nodes);
+    free(postings);
+    free(stack);
+
+    return frozenPtr;
 }
 
 
@@ -410,40 +844,1318 @@ static bool _tsearch_cstring_is_nonempty(const char *string)
 }
 
 
-tsearch_ternarytree_ptr _tsearch_ternarytree_search(tsearch_ternarytree_ptr ptr, const char *target)
+static _tsearch_ternarytree_root * _tsearch_ternarytree_get_root(const tsearch_ternarytree_ptr ptr)
 {
-    if (!_tsearch_cstring_is_nonempty(target)) { return NULL; }
+    return (_tsearch_ternarytree_root *)ptr;
+}
 
-    const char *cursor = target;
-    while (ptr != NULL) {
-        char targetCharacter = *cursor;
 
-        if (targetCharacter < ptr->character) {
-            ptr = ptr->lower;
-        } else if (targetCharacter > ptr->character) {
-            ptr = ptr->higher;
-        } else {
-            if (cursor[1] == '\0') { return ptr; }
-            cursor += 1;
-            ptr = ptr->same;
+/// Returns a new, empty node whose parent is the specified node. The node is taken from the
+/// tree's node pool if it has one, otherwise it is allocated on its own. Returns NULL on failure.
+static tsearch_ternarytree_ptr _tsearch_ternarytree_node_init(const tsearch_ternarytree_ptr root,
+                                                              const tsearch_ternarytree_ptr parent)
+{
+    if (root == NULL) { return NULL; }
+
+    tsearch_ternarytree_ptr ptr = NULL;
+    _tsearch_ternarytree_node_pool *pool = _tsearch_ternarytree_get_root(root)->pool;
+    if (pool == NULL) {
+        ptr = calloc(1, sizeof(tsearch_ternarytree_node));
+    } else if (pool->freeNodes != NULL) {
+        ptr = pool->freeNodes;
+        pool->freeNodes = ptr->parent;
+    } else {
+        _tsearch_ternarytree_node_chunk *chunk = pool->chunks;
+        if (chunk == NULL || chunk->count >= chunk->capacity) {
+            size_t byteLength = 0;
+            if (_tsearch_size_mul_overflows(pool->nodesPerChunk, sizeof(tsearch_ternarytree_node), &byteLength) ||
+                _tsearch_size_add_overflows(byteLength, sizeof(_tsearch_ternarytree_node_chunk), &byteLength)) {
+                return NULL;
+            }
+
+            chunk = calloc(1, byteLength);
+            if (chunk == NULL) { return NULL; }
+            chunk->next = pool->chunks;
+            chunk->count = 0;
+            chunk->capacity = pool->nodesPerChunk;
+            pool->chunks = chunk;
         }
+
+        ptr = &(chunk->nodes[chunk->count]);
+        chunk->count += 1;
     }
+    if (ptr == NULL) { return NULL; }
 
-    return NULL;
+    ptr->character = '\0';
+    ptr->parent = parent;
+    ptr->lower = NULL;
+    ptr->same = NULL;
+    ptr->higher = NULL;
+    ptr->documentIDs = NULL;
+
+    return ptr;
 }
 
 
-result _tsearch_ternarytree_copy_words_from_node(const tsearch_ternarytree_ptr ptr, tsearch_countedset_ptr results)
+/// Frees the node's document IDs and returns the node to the tree's node pool, or frees it if the
+/// tree doesn't have a pool. The node must already have been unlinked from its parent.
+static void _tsearch_ternarytree_node_release(const tsearch_ternarytree_ptr root, const tsearch_ternarytree_ptr ptr)
 {
-    if (ptr == NULL) { return success; }
-    if (results == NULL) { return failure; }
+    if (root == NULL || ptr == NULL || ptr == root) { return; }
 
-    tsearch_ternarytree_ptr stopParent = ptr->parent;
-    tsearch_ternarytree_ptr previous = stopParent;
-    tsearch_ternarytree_ptr current = ptr;
+    _tsearch_prefixindex_remove(_tsearch_ternarytree_get_root(root)->prefixIndex, ptr);
+    tsearch_countedset_free(ptr->documentIDs);
+    ptr->documentIDs = NULL;
+    ptr->lower = NULL;
+    ptr->same = NULL;
+    ptr->higher = NULL;
 
-    while (current != stopParent) {
-        tsearch_ternarytree_ptr next = NULL;
+    _tsearch_ternarytree_node_pool *pool = _tsearch_ternarytree_get_root(root)->pool;
+    if (pool == NULL) {
+        free(ptr);
+    } else {
+        ptr->parent = pool->freeNodes;
+        pool->freeNodes = ptr;
+    }
+}
+
+
+/// Frees every chunk in the pool. The chunks are scanned in order, so the nodes' document IDs are
+/// freed without walking the tree. Released nodes and unused slots have NULL document IDs.
+static void _tsearch_ternarytree_node_pool_free(_tsearch_ternarytree_node_pool *pool)
+{
+    if (pool == NULL) { return; }
+
+    _tsearch_ternarytree_node_chunk *chunk = pool->chunks;
+    while (chunk != NULL) {
+        _tsearch_ternarytree_node_chunk *next = chunk->next;
+        for (size_t i = 0; i < chunk->count; i++) {
+            tsearch_countedset_free(chunk->nodes[i].documentIDs);
+        }
+        free(chunk);
+        chunk = next;
+    }
+
+    pool->chunks = NULL;
+    pool->freeNodes = NULL;
+    free(pool);
+}
+
+
+static _tsearch_ternarytree_branch _tsearch_ternarytree_branch_of_child(const tsearch_ternarytree_ptr parent,
+                                                                       const tsearch_ternarytree_ptr child)
+{
+    if (parent == NULL || child == NULL) { return _tsearch_ternarytree_branch_parent; }
+    if (parent->lower == child) { return _tsearch_ternarytree_branch_lower; }
+    if (parent->same == child) { return _tsearch_ternarytree_branch_same; }
+    return _tsearch_ternarytree_branch_higher;
+}
+
+
+/// Visits ptr and every node below it in depth-first order without recursing. enter is called when
+/// a node is reached, before its branches, and leave, if it isn't NULL, after all of them. leave may
+/// release the node, so the walk tracks which of its parent's branches it is returning from instead
+/// of comparing against the previous node's address. ptr's depth is 1 and each same branch adds one,
+/// and same branches aren't followed from nodes at maxDepth.
+static result _tsearch_ternarytree_visit_nodes(const tsearch_ternarytree_ptr ptr, const size_t maxDepth,
+                                               const node_func enter, const node_func leave, void *context)
+{
+    if (ptr == NULL) { return success; }
+    if (enter == NULL) { return failure; }
+
+    tsearch_ternarytree_ptr current = ptr;
+    size_t depth = 1;
+    _tsearch_ternarytree_branch from = _tsearch_ternarytree_branch_parent;
+
+    while (true) {
+        if (from == _tsearch_ternarytree_branch_parent) {
+            if (enter(current, depth, context) == failure) { return failure; }
+            if (current->lower != NULL) { current = current->lower; continue; }
+            from = _tsearch_ternarytree_branch_lower;
+        }
+
+        if (from == _tsearch_ternarytree_branch_lower) {
+            if (depth < maxDepth && current->same != NULL) {
+                current = current->same;
+                depth += 1;
+                from = _tsearch_ternarytree_branch_parent;
+                continue;
+            }
+            from = _tsearch_ternarytree_branch_same;
+        }
+
+        if (from == _tsearch_ternarytree_branch_same && current->higher != NULL) {
+            current = current->higher;
+            from = _tsearch_ternarytree_branch_parent;
+            continue;
+        }
+
+        tsearch_ternarytree_ptr parent = (current == ptr) ? NULL : current->parent;
+        from = _tsearch_ternarytree_branch_of_child(parent, current);
+        if (leave != NULL && leave(current, depth, context) == failure) { return failure; }
+        if (parent == NULL) { return success; }
+
+        if (from == _tsearch_ternarytree_branch_same) { depth -= 1; }
+        current = parent;
+    }
+}
+
+
+/// Releases the specified node if it doesn't have any children or document IDs. The root node
+/// is never released. Instead, it is reset so that the next insert can reuse it.
+static void _tsearch_ternarytree_prune_node_if_empty(const tsearch_ternarytree_ptr root,
+                                                     const tsearch_ternarytree_ptr ptr)
+{
+    if (root == NULL || ptr == NULL) { return; }
+    if (_tsearch_ternarytree_is_leaf(ptr) == false) { return; }
+    if (_tsearch_ternarytree_has_valid_document_ids(ptr) == true) { return; }
+
+    // Nodes keep their document IDs once they've ended a word, even after they're emptied, so the
+    // trigram index can still list them. They're removed here, while the word can still be read
+    // by climbing to the root.
+    _tsearch_trigramindex *trigramIndex = _tsearch_ternarytree_get_root(root)->trigramIndex;
+    if (trigramIndex != NULL && ptr->documentIDs != NULL) {
+        (void)_tsearch_ternarytree_update_trigram_index(trigramIndex, ptr, false);
+    }
+
+    if (ptr == root) {
+        _tsearch_prefixindex_remove(_tsearch_ternarytree_get_root(root)->prefixIndex, ptr);
+        tsearch_countedset_free(ptr->documentIDs);
+        ptr->documentIDs = NULL;
+        ptr->character = '\0';
+        return;
+    }
+
+    tsearch_ternarytree_ptr parent = ptr->parent;
+    if (parent != NULL) {
+        if (parent->lower == ptr) { parent->lower = NULL; }
+        else if (parent->same == ptr) { parent->same = NULL; }
+        else if (parent->higher == ptr) { parent->higher = NULL; }
+    }
+
+    _tsearch_ternarytree_node_release(root, ptr);
+}
+
+
+/// Prunes the node if it is empty, and then its parent if that leaves the parent empty, and so on,
+/// stopping at the first node that still has document IDs or children.
+static void _tsearch_ternarytree_prune_empty_nodes_from(const tsearch_ternarytree_ptr root,
+                                                        const tsearch_ternarytree_ptr ptr)
+{
+    tsearch_ternarytree_ptr current = ptr;
+    while (current != NULL) {
+        if (_tsearch_ternarytree_is_leaf(current) == false) { return; }
+        if (_tsearch_ternarytree_has_valid_document_ids(current) == true) { return; }
+
+        tsearch_ternarytree_ptr parent = (current == root) ? NULL : current->parent;
+        _tsearch_ternarytree_prune_node_if_empty(root, current);
+        current = parent;
+    }
+}
+
+
+/// Returns the node ending the non-empty word, adding any nodes it doesn't have yet, or NULL if a
+/// node can't be allocated. Nodes added before the failure are left in the tree without document
+/// IDs, where they don't change any search results.
+static tsearch_ternarytree_ptr _tsearch_ternarytree_insert_word_nodes(const tsearch_ternarytree_ptr root,
+                                                                      const char *word)
+{
+    tsearch_ternarytree_ptr node = root;
+    const char *cursor = word;
+
+    while (true) {
+        if (node->character == '\0') { node->character = *cursor; }
+
+        if (*cursor < node->character) {
+            if (node->lower == NULL) {
+                node->lower = _tsearch_ternarytree_node_init(root, node);
+                if (node->lower == NULL) { return NULL; }
+            }
+            node = node->lower;
+            continue;
+        }
+
+        if (*cursor > node->character) {
+            if (node->higher == NULL) {
+                node->higher = _tsearch_ternarytree_node_init(root, node);
+                if (node->higher == NULL) { return NULL; }
+            }
+            node = node->higher;
+            continue;
+        }
+
+        if (cursor[1] == '\0') { return node; }
+
+        cursor += 1;
+        if (node->same == NULL) {
+            node->same = _tsearch_ternarytree_node_init(root, node);
+            if (node->same == NULL) { return NULL; }
+        }
+        node = node->same;
+    }
+}
+
+
+/// Adds count to the document ID's count in the node's document IDs, creating them if needed. If the
+/// tree has a document index and the node didn't contain the document yet, the node is added to the
+/// document's nodes. The prefix index, if there is one, is updated as well.
+static result _tsearch_ternarytree_add_document_id(const tsearch_ternarytree_ptr root,
+                                                   const tsearch_ternarytree_ptr ptr,
+                                                   const GNEInteger documentID, const size_t count)
+{
+    if (root == NULL || ptr == NULL) { return failure; }
+
+    if (ptr->documentIDs == NULL) {
+        ptr->documentIDs = tsearch_countedset_init();
+        if (ptr->documentIDs == NULL) { return failure; }
+    }
+
+    _tsearch_documentindex *index = _tsearch_ternarytree_get_root(root)->documentIndex;
+    bool isNewDocument = (index != NULL && tsearch_countedset_contains_int(ptr->documentIDs, documentID) == false);
+    bool isNewWord = (tsearch_countedset_get_count(ptr->documentIDs) == 0);
+
+    if (_tsearch_countedset_add_int(ptr->documentIDs, documentID, count) == failure) { return failure; }
+
+    // The node must never be in the index for a document it doesn't contain, because it could
+    // be released while the index still referred to it.
+    if (isNewDocument == true && _tsearch_documentindex_add(index, documentID, ptr) == failure) {
+        (void)tsearch_countedset_remove_int(ptr->documentIDs, documentID);
+        return failure;
+    }
+
+    _tsearch_ternarytree_add_to_prefix_index(root, ptr, documentID, count);
+    _tsearch_ternarytree_add_to_suffix_index(root, ptr, documentID, count);
+    if (isNewWord == true) { _tsearch_ternarytree_add_to_trigram_index(root, ptr); }
+    return success;
+}
+
+
+/// Removes the document IDs from every word in the tree itself, leaving the suffix index alone.
+static result _tsearch_ternarytree_remove_document_ids(const tsearch_ternarytree_ptr ptr,
+                                                       const GNEInteger *documentIDs,
+                                                       const size_t count)
+{
+    _tsearch_documentindex *index = _tsearch_ternarytree_get_root(ptr)->documentIndex;
+    if (index != NULL) {
+        for (size_t i = 0; i < count; i++) {
+            if (_tsearch_ternarytree_remove_indexed(ptr, index, documentIDs[i]) == failure) { return failure; }
+        }
+        return success;
+    }
+
+    tsearch_countedset_ptr removedIDs = tsearch_countedset_init();
+    if (removedIDs == NULL) { return failure; }
+    for (size_t i = 0; i < count; i++) {
+        if (tsearch_countedset_add_int(removedIDs, documentIDs[i]) == failure) {
+            tsearch_countedset_free(removedIDs);
+            return failure;
+        }
+    }
+
+    // Every word loses the documents, so every prefix does too.
+    _tsearch_prefixindex_remove_ints_in_set(_tsearch_ternarytree_get_root(ptr)->prefixIndex, removedIDs);
+
+    // Nodes left empty are pruned on the way back up.
+    _tsearch_ternarytree_removal removal = { ptr, removedIDs };
+    result ret = _tsearch_ternarytree_visit_nodes(ptr, SIZE_MAX, _tsearch_ternarytree_remove_ints_in_set_from_node,
+                                                  _tsearch_ternarytree_prune_removed_node, &removal);
+    tsearch_countedset_free(removedIDs);
+    return ret;
+}
+
+
+static result _tsearch_ternarytree_remove_ints_in_set_from_node(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                                void *context)
+{
+    if (_tsearch_ternarytree_has_valid_document_ids(ptr) == false) { return success; }
+    return _tsearch_countedset_remove_ints_in_set(ptr->documentIDs,
+                                                  ((_tsearch_ternarytree_removal *)context)->removedIDs);
+}
+
+
+static result _tsearch_ternarytree_prune_removed_node(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                      void *context)
+{
+    _tsearch_ternarytree_prune_node_if_empty(((_tsearch_ternarytree_removal *)context)->root, ptr);
+    return success;
+}
+
+
+/// Adds the node to the document index in context for each of its document IDs.
+static result _tsearch_ternarytree_index_node(const tsearch_ternarytree_ptr ptr, const size_t depth, void *context)
+{
+    if (_tsearch_ternarytree_has_valid_document_ids(ptr) == false) { return success; }
+
+    _tsearch_documentindex *index = (_tsearch_documentindex *)context;
+
+    GNEInteger *documentIDs = NULL;
+    size_t count = 0;
+    if (tsearch_countedset_copy_ints(ptr->documentIDs, &documentIDs, &count) == failure) { return failure; }
+
+    for (size_t i = 0; i < count; i++) {
+        if (_tsearch_documentindex_add(index, documentIDs[i], ptr) == failure) {
+            free(documentIDs);
+            return failure;
+        }
+    }
+
+    free(documentIDs);
+    return success;
+}
+
+
+/// Removes the document ID from only the nodes the document index lists for it, pruning the nodes
+/// that are left empty along with any ancestors that become empty as a result.
+static result _tsearch_ternarytree_remove_indexed(const tsearch_ternarytree_ptr root,
+                                                  _tsearch_documentindex *index,
+                                                  const GNEInteger documentID)
+{
+    void **nodes = NULL;
+    size_t count = 0;
+    _tsearch_documentindex_take(index, documentID, &nodes, &count);
+
+    for (size_t i = 0; i < count; i++) {
+        tsearch_ternarytree_ptr node = nodes[i];
+        if (tsearch_countedset_remove_int(node->documentIDs, documentID) == failure) {
+            // The nodes that still contain the document go back into the index.
+            for (size_t j = i; j < count; j++) { (void)_tsearch_documentindex_add(index, documentID, nodes[j]); }
+            free(nodes);
+            return failure;
+        }
+        _tsearch_ternarytree_remove_from_prefix_index(root, node, documentID);
+        _tsearch_ternarytree_prune_empty_nodes_from(root, node);
+    }
+
+    free(nodes);
+    return success;
+}
+
+
+/// Adds every prefix of the specified length to the index. The walk doesn't descend past the
+/// prefixes. Writes the number of nodes ending prefixes of the length, whether or not they fit in
+/// the index.
+static result _tsearch_ternarytree_index_prefixes_of_length(const tsearch_ternarytree_ptr root,
+                                                            _tsearch_prefixindex *index,
+                                                            const size_t length, size_t *outCount)
+{
+    _tsearch_ternarytree_prefix_indexing indexing = { index, length, 0 };
+    result ret = _tsearch_ternarytree_visit_nodes(root, length, _tsearch_ternarytree_index_prefix_node, NULL,
+                                                  &indexing);
+    *outCount = indexing.count;
+    return ret;
+}
+
+
+static result _tsearch_ternarytree_index_prefix_node(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                     void *context)
+{
+    _tsearch_ternarytree_prefix_indexing *indexing = (_tsearch_ternarytree_prefix_indexing *)context;
+    if (depth != indexing->length) { return success; }
+
+    indexing->count += 1;
+    tsearch_countedset_ptr documentIDs = NULL;
+    if (_tsearch_ternarytree_copy_prefix_document_ids(ptr, &documentIDs) == failure) { return failure; }
+    if (documentIDs == NULL) { return success; }
+    return _tsearch_prefixindex_insert(indexing->index, ptr, documentIDs);
+}
+
+
+/// Adds count to the document ID's count for each of the word's prefixes in the prefix index. A
+/// prefix that isn't in the index is only added if the word is the only one starting with it,
+/// because its document IDs are then the word's, which is always the case for new prefixes.
+static void _tsearch_ternarytree_add_to_prefix_index(const tsearch_ternarytree_ptr root,
+                                                     const tsearch_ternarytree_ptr ptr,
+                                                     const GNEInteger documentID, const size_t count)
+{
+    _tsearch_ternarytree_root *treeRoot = _tsearch_ternarytree_get_root(root);
+    _tsearch_prefixindex *index = treeRoot->prefixIndex;
+    if (index == NULL) { return; }
+
+    size_t length = _tsearch_ternarytree_get_word_len(ptr);
+    bool isOnlyWord = (ptr->same == NULL);
+    tsearch_ternarytree_ptr current = ptr;
+
+    while (current != NULL) {
+        if (length <= treeRoot->prefixIndexMaxLength) {
+            if (_tsearch_prefixindex_get(index, current) != NULL) {
+                _tsearch_prefixindex_add_int(index, current, documentID, count);
+            } else if (isOnlyWord == true) {
+                (void)_tsearch_prefixindex_insert(index, current, tsearch_countedset_copy(ptr->documentIDs));
+            }
+        }
+
+        current = _tsearch_ternarytree_get_shorter_prefix_node(current, &isOnlyWord);
+        length -= 1;
+    }
+}
+
+
+/// Removes the document ID from each of the word's prefixes in the prefix index.
+static void _tsearch_ternarytree_remove_from_prefix_index(const tsearch_ternarytree_ptr root,
+                                                          const tsearch_ternarytree_ptr ptr,
+                                                          const GNEInteger documentID)
+{
+    _tsearch_ternarytree_root *treeRoot = _tsearch_ternarytree_get_root(root);
+    if (treeRoot->prefixIndex == NULL) { return; }
+
+    size_t length = _tsearch_ternarytree_get_word_len(ptr);
+    bool isOnlyWord = false;
+    tsearch_ternarytree_ptr current = ptr;
+
+    while (current != NULL) {
+        if (length <= treeRoot->prefixIndexMaxLength) {
+            _tsearch_prefixindex_remove_int(treeRoot->prefixIndex, current, documentID);
+        }
+
+        current = _tsearch_ternarytree_get_shorter_prefix_node(current, &isOnlyWord);
+        length -= 1;
+    }
+}
+
+
+/// Adds count to the document ID's count for the reversed word in the suffix index. If that fails,
+/// the suffix index is removed, because it would be missing the word.
+static void _tsearch_ternarytree_add_to_suffix_index(const tsearch_ternarytree_ptr root,
+                                                     const tsearch_ternarytree_ptr ptr,
+                                                     const GNEInteger documentID, const size_t count)
+{
+    tsearch_ternarytree_ptr reversedTree = _tsearch_ternarytree_get_root(root)->reversedTree;
+    if (reversedTree == NULL) { return; }
+
+    char *reversedWord = _tsearch_ternarytree_copy_reversed_word(ptr);
+    tsearch_ternarytree_ptr node = NULL;
+    if (reversedWord != NULL) { node = _tsearch_ternarytree_insert_word_nodes(reversedTree, reversedWord); }
+    free(reversedWord);
+
+    if (node == NULL || _tsearch_ternarytree_add_document_id(reversedTree, node, documentID, count) == failure) {
+        _tsearch_ternarytree_remove_suffix_index(root);
+    }
+}
+
+
+/// Inserts every word in the tree, reversed, into the empty reversedTree with a copy of the word's
+/// document IDs. Distinct words stay distinct when they're reversed, so each node of the reversed
+/// tree only ever receives one word's document IDs.
+static result _tsearch_ternarytree_index_reversed_words(const tsearch_ternarytree_ptr root,
+                                                        const tsearch_ternarytree_ptr reversedTree)
+{
+    return _tsearch_ternarytree_visit_nodes(root, SIZE_MAX, _tsearch_ternarytree_index_reversed_word, NULL,
+                                            reversedTree);
+}
+
+
+/// Inserts the word ending at ptr, if there is one, reversed into the reversed tree in context.
+static result _tsearch_ternarytree_index_reversed_word(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                       void *context)
+{
+    if (_tsearch_ternarytree_has_valid_document_ids(ptr) == false) { return success; }
+
+    char *reversedWord = _tsearch_ternarytree_copy_reversed_word(ptr);
+    if (reversedWord == NULL) { return failure; }
+
+    tsearch_ternarytree_ptr node = _tsearch_ternarytree_insert_word_nodes((tsearch_ternarytree_ptr)context,
+                                                                          reversedWord);
+    free(reversedWord);
+    if (node == NULL) { return failure; }
+
+    node->documentIDs = tsearch_countedset_copy(ptr->documentIDs);
+    return (node->documentIDs == NULL) ? failure : success;
+}
+
+
+static void _tsearch_ternarytree_remove_suffix_index(const tsearch_ternarytree_ptr root)
+{
+    _tsearch_ternarytree_root *treeRoot = _tsearch_ternarytree_get_root(root);
+    tsearch_ternarytree_free(treeRoot->reversedTree);
+    treeRoot->reversedTree = NULL;
+}
+
+
+/// Returns a new null-terminated copy of the word ending at ptr with its characters in reverse
+/// order, which is the order they're reached in by climbing from ptr to the root, or NULL if it
+/// can't be allocated. The caller is responsible for freeing it.
+static char * _tsearch_ternarytree_copy_reversed_word(const tsearch_ternarytree_ptr ptr)
+{
+    size_t length = _tsearch_ternarytree_get_word_len(ptr);
+    size_t byteLength = 0;
+    if (length == 0 || _tsearch_size_add_overflows(length, 1, &byteLength)) { return NULL; }
+
+    char *reversedWord = malloc(byteLength);
+    if (reversedWord == NULL) { return NULL; }
+
+    bool isOnlyWord = false;
+    tsearch_ternarytree_ptr current = ptr;
+    for (size_t i = 0; i < length; i++) {
+        reversedWord[i] = current->character;
+        current = _tsearch_ternarytree_get_shorter_prefix_node(current, &isOnlyWord);
+    }
+    reversedWord[length] = '\0';
+    return reversedWord;
+}
+
+
+/// Adds the word ending at ptr to the trigram index. If that fails, the trigram index is removed,
+/// because it would be missing some of the word's grams.
+static void _tsearch_ternarytree_add_to_trigram_index(const tsearch_ternarytree_ptr root,
+                                                      const tsearch_ternarytree_ptr ptr)
+{
+    _tsearch_ternarytree_root *treeRoot = _tsearch_ternarytree_get_root(root);
+    if (treeRoot->trigramIndex == NULL) { return; }
+
+    if (_tsearch_ternarytree_update_trigram_index(treeRoot->trigramIndex, ptr, true) == failure) {
+        _tsearch_trigramindex_free(treeRoot->trigramIndex);
+        treeRoot->trigramIndex = NULL;
+    }
+}
+
+
+/// Adds every word in the tree to the empty trigram index.
+static result _tsearch_ternarytree_index_trigrams(const tsearch_ternarytree_ptr root, _tsearch_trigramindex *index)
+{
+    return _tsearch_ternarytree_visit_nodes(root, SIZE_MAX, _tsearch_ternarytree_index_word_trigrams, NULL, index);
+}
+
+
+/// Adds the word ending at ptr, if there is one, to the trigram index in context.
+static result _tsearch_ternarytree_index_word_trigrams(const tsearch_ternarytree_ptr ptr, const size_t depth,
+                                                       void *context)
+{
+    if (_tsearch_ternarytree_has_valid_document_ids(ptr) == false) { return success; }
+    return _tsearch_ternarytree_update_trigram_index((_tsearch_trigramindex *)context, ptr, true);
+}
+
+
+/// Adds the node ending the word to, or removes it from, the nodes of each of the word's grams. The
+/// climb to the root reaches the word's characters from last to first, so each character starts
+/// the gram it makes with the two characters reached just before it.
+static result _tsearch_ternarytree_update_trigram_index(_tsearch_trigramindex *index,
+                                                        const tsearch_ternarytree_ptr ptr, const bool shouldAdd)
+{
+    char second = '\0';
+    char third = '\0';
+    size_t depth = 0;
+    bool isOnlyWord = false;
+    tsearch_ternarytree_ptr current = ptr;
+
+    while (current != NULL) {
+        if (depth >= 2) {
+            uint32_t gram = _tsearch_ternarytree_make_gram(current->character, second, third);
+            if (shouldAdd == false) { _tsearch_trigramindex_remove(index, gram, ptr); }
+            else if (_tsearch_trigramindex_add(index, gram, ptr) == failure) { return failure; }
+        }
+
+        third = second;
+        second = current->character;
+        depth += 1;
+        current = _tsearch_ternarytree_get_shorter_prefix_node(current, &isOnlyWord);
+    }
+
+    return success;
+}
+
+
+static uint32_t _tsearch_ternarytree_make_gram(const char first, const char second, const char third)
+{
+    return ((uint32_t)(unsigned char)first << 16) | ((uint32_t)(unsigned char)second << 8) |
+           (uint32_t)(unsigned char)third;
+}
+
+
+/// Returns the node ending the prefix one character shorter than the one ending at ptr, or NULL if
+/// ptr ends a single character. Clears isOnlyWord if the shorter prefix starts any words that the
+/// longer one doesn't, which is the case if it has document IDs of its own or the climb to it passes
+/// a lower or higher branch.
+static tsearch_ternarytree_ptr _tsearch_ternarytree_get_shorter_prefix_node(const tsearch_ternarytree_ptr ptr,
+                                                                            bool *isOnlyWord)
+{
+    if (ptr->lower != NULL || ptr->higher != NULL) { *isOnlyWord = false; }
+
+    tsearch_ternarytree_ptr child = ptr;
+    tsearch_ternarytree_ptr parent = ptr->parent;
+    while (parent != NULL && parent->same != child) {
+        *isOnlyWord = false;
+        child = parent;
+        parent = parent->parent;
+    }
+
+    if (_tsearch_ternarytree_has_valid_document_ids(parent) == true) { *isOnlyWord = false; }
+    return parent;
+}
+
+
+/// Writes the prefix index's document IDs for the prefix ending at foundPtr and returns true, or
+/// returns false if they aren't in the index. Counts a hit, or a miss if the prefix is short enough
+/// to have been in the index.
+static bool _tsearch_ternarytree_get_indexed_prefix_results(const tsearch_ternarytree_ptr root,
+                                                            const char *prefix,
+                                                            const tsearch_ternarytree_ptr foundPtr,
+                                                            tsearch_countedset_ptr *outResults)
+{
+    _tsearch_ternarytree_root *treeRoot = _tsearch_ternarytree_get_root(root);
+    if (treeRoot->prefixIndex == NULL) { return false; }
+
+    *outResults = _tsearch_prefixindex_get(treeRoot->prefixIndex, foundPtr);
+    if (*outResults != NULL) {
+        treeRoot->prefixHitCount += 1;
+        return true;
+    }
+
+    if (strlen(prefix) <= treeRoot->prefixIndexMaxLength) { treeRoot->prefixMissCount += 1; }
+    return false;
+}
+
+
+static size_t _tsearch_ternarytree_get_node_count(const tsearch_ternarytree_ptr ptr)
+{
+    size_t count = 0;
+    (void)_tsearch_ternarytree_visit_nodes(ptr, SIZE_MAX, _tsearch_ternarytree_count_node, NULL, &count);
+    return count;
+}
+
+
+static result _tsearch_ternarytree_count_node(const tsearch_ternarytree_ptr ptr, const size_t depth, void *context)
+{
+    *(size_t *)context += 1;
+    return success;
+}
+
+
+/// Copies the entries with non-empty words and sorts them by word and then by document ID.
+static result _tsearch_ternarytree_copy_sorted_entries(const tsearch_ternarytree_entry *entries,
+                                                       const size_t count,
+                                                       tsearch_ternarytree_entry **outEntries,
+                                                       size_t *outCount)
+{
+    if (outEntries == NULL || outCount == NULL) { return failure; }
+    *outEntries = NULL;
+    *outCount = 0;
+    if (count == 0) { return success; }
+
+    size_t byteLength = 0;
+    if (_tsearch_size_mul_overflows(count, sizeof(tsearch_ternarytree_entry), &byteLength)) { return failure; }
+
+    tsearch_ternarytree_entry *sorted = malloc(byteLength);
+    if (sorted == NULL) { return failure; }
+
+    size_t sortedCount = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!_tsearch_cstring_is_nonempty(entries[i].word)) { continue; }
+        sorted[sortedCount] = entries[i];
+        sortedCount += 1;
+    }
+
+    qsort(sorted, sortedCount, sizeof(tsearch_ternarytree_entry), _tsearch_ternarytree_entry_compare);
+
+    *outEntries = sorted;
+    *outCount = sortedCount;
+    return success;
+}
+
+
+/// Orders words the way the tree does, comparing chars rather than unsigned chars, so that each
+/// character's lower and higher branches hold the characters before and after it in the entries.
+/// A word sorts before every word it is a prefix of.
+static int _tsearch_ternarytree_entry_compare(const void *valuePtr1, const void *valuePtr2)
+{
+    if (valuePtr1 == NULL || valuePtr2 == NULL) { return 0; }
+    const tsearch_ternarytree_entry *entry1 = valuePtr1;
+    const tsearch_ternarytree_entry *entry2 = valuePtr2;
+
+    const char *word1 = entry1->word;
+    const char *word2 = entry2->word;
+    while (*word1 != '\0' && *word1 == *word2) {
+        word1 += 1;
+        word2 += 1;
+    }
+
+    if (*word1 != *word2) {
+        if (*word1 == '\0') { return -1; }
+        if (*word2 == '\0') { return 1; }
+        return (*word1 < *word2) ? -1 : 1;
+    }
+
+    if (entry1->documentID < entry2->documentID) { return -1; }
+    if (entry1->documentID > entry2->documentID) { return 1; }
+    return 0;
+}
+
+
+/// Each word needs a node for every character after the prefix it shares with the word before it.
+static size_t _tsearch_ternarytree_get_node_count_for_sorted_entries(const tsearch_ternarytree_entry *entries,
+                                                                     const size_t count)
+{
+    size_t nodeCount = 0;
+    const char *previous = "";
+    for (size_t i = 0; i < count; i++) {
+        const char *word = entries[i].word;
+        size_t shared = 0;
+        while (word[shared] != '\0' && word[shared] == previous[shared]) { shared += 1; }
+        nodeCount += strlen(word + shared);
+        previous = word;
+    }
+    return nodeCount;
+}
+
+
+/// Builds the tree from the root down. Each node takes the median of the distinct characters in its
+/// range of entries at its depth, and its lower and higher branches are built from the entries before
+/// and after that character. Every stack item becomes a node, so the stack never holds more items
+/// than there are nodes.
+static result _tsearch_ternarytree_build_from_sorted_entries(const tsearch_ternarytree_ptr root,
+                                                             const tsearch_ternarytree_entry *entries,
+                                                             const size_t count,
+                                                             const size_t nodeCount)
+{
+    if (root == NULL) { return failure; }
+    if (count == 0 || nodeCount == 0) { return success; }
+
+    _tsearch_ternarytree_build_item *stack = calloc(nodeCount, sizeof(_tsearch_ternarytree_build_item));
+    if (stack == NULL) { return failure; }
+
+    size_t stackCount = 0;
+    stack[stackCount++] = (_tsearch_ternarytree_build_item){root, 0, count, 0};
+
+    result ret = success;
+    while (ret == success && stackCount > 0) {
+        _tsearch_ternarytree_build_item item = stack[--stackCount];
+        tsearch_ternarytree_ptr node = item.node;
+        size_t depth = item.depth;
+
+        size_t medianStart = item.start, medianEnd = item.end;
+        _tsearch_ternarytree_get_median_character_range(entries, item.start, item.end, depth,
+                                                        &medianStart, &medianEnd);
+        node->character = entries[medianStart].word[depth];
+
+        // Words ending at this node sort before the longer words sharing their prefix.
+        size_t sameStart = medianStart;
+        while (sameStart < medianEnd && entries[sameStart].word[depth + 1] == '\0') { sameStart += 1; }
+
+        if (sameStart > medianStart) {
+            node->documentIDs = tsearch_countedset_init();
+            if (node->documentIDs == NULL) { ret = failure; break; }
+
+            size_t runStart = medianStart;
+            for (size_t i = medianStart + 1; i <= sameStart; i++) {
+                if (i < sameStart && entries[i].documentID == entries[runStart].documentID) { continue; }
+                if (_tsearch_countedset_add_int(node->documentIDs, entries[runStart].documentID,
+                                                i - runStart) == failure) {
+                    ret = failure;
+                    break;
+                }
+                runStart = i;
+            }
+            if (ret == failure) { break; }
+        }
+
+        if (item.start < medianStart) {
+            node->lower = _tsearch_ternarytree_node_init(root, node);
+            if (node->lower == NULL) { ret = failure; break; }
+            stack[stackCount++] = (_tsearch_ternarytree_build_item){node->lower, item.start, medianStart, depth};
+        }
+
+        if (medianEnd < item.end) {
+            node->higher = _tsearch_ternarytree_node_init(root, node);
+            if (node->higher == NULL) { ret = failure; break; }
+            stack[stackCount++] = (_tsearch_ternarytree_build_item){node->higher, medianEnd, item.end, depth};
+        }
+
+        if (sameStart < medianEnd) {
+            node->same = _tsearch_ternarytree_node_init(root, node);
+            if (node->same == NULL) { ret = failure; break; }
+            stack[stackCount++] = (_tsearch_ternarytree_build_item){node->same, sameStart, medianEnd, depth + 1};
+        }
+    }
+
+    free(stack);
+    return ret;
+}
+
+
+/// Finds the range of entries whose character at the specified depth is the median of the distinct
+/// characters at that depth. The entries in the range must be sorted and longer than depth.
+static void _tsearch_ternarytree_get_median_character_range(const tsearch_ternarytree_entry *entries,
+                                                            const size_t start, const size_t end,
+                                                            const size_t depth,
+                                                            size_t *outStart, size_t *outEnd)
+{
+    size_t characterCount = 1;
+    for (size_t i = start + 1; i < end; i++) {
+        if (entries[i].word[depth] != entries[i - 1].word[depth]) { characterCount += 1; }
+    }
+
+    size_t median = characterCount / 2;
+    size_t medianStart = start;
+    for (size_t i = start + 1; i < end && median > 0; i++) {
+        if (entries[i].word[depth] != entries[i - 1].word[depth]) {
+            median -= 1;
+            medianStart = i;
+        }
+    }
+
+    size_t medianEnd = medianStart + 1;
+    while (medianEnd < end && entries[medianEnd].word[depth] == entries[medianStart].word[depth]) {
+        medianEnd += 1;
+    }
+
+    *outStart = medianStart;
+    *outEnd = medianEnd;
+}
+
+
+/// A process_token_func that appends the token's range of bytes to the _tsearch_ternarytree_document_terms
+/// passed as the context. The tokenizer can't be stopped, so failures are recorded in the terms' status.
+static void _tsearch_ternarytree_add_document_term(const char *string, const tsearch_range range,
+                                                  uint32_t *token, const size_t length, const void *context)
+{
+    (void)token;
+    (void)length;
+
+    _tsearch_ternarytree_document_terms *terms = (_tsearch_ternarytree_document_terms *)context;
+    if (terms == NULL || terms->status == failure || range.length == 0) { return; }
+
+    if (terms->count >= terms->capacity) {
+        size_t capacity = terms->capacity;
+        size_t bufferLength = 0;
+        if (_tsearch_next_buf_len(&capacity, sizeof(_tsearch_ternarytree_document_term), &bufferLength) == failure) {
+            terms->status = failure;
+            return;
+        }
+
+        _tsearch_ternarytree_document_term *newTerms = realloc(terms->terms, bufferLength);
+        if (newTerms == NULL) { terms->status = failure; return; }
+        terms->terms = newTerms;
+        terms->capacity = capacity;
+    }
+
+    terms->terms[terms->count] = (_tsearch_ternarytree_document_term){string + range.location, range.length, 1};
+    terms->count += 1;
+    if (range.length > terms->maxLength) { terms->maxLength = range.length; }
+}
+
+
+/// Orders terms the same way as _tsearch_ternarytree_entry_compare(), so consecutive terms share
+/// as much of their prefixes as possible.
+static int _tsearch_ternarytree_document_term_compare(const void *valuePtr1, const void *valuePtr2)
+{
+    if (valuePtr1 == NULL || valuePtr2 == NULL) { return 0; }
+    const _tsearch_ternarytree_document_term *term1 = valuePtr1;
+    const _tsearch_ternarytree_document_term *term2 = valuePtr2;
+
+    size_t length = (term1->length < term2->length) ? term1->length : term2->length;
+    for (size_t i = 0; i < length; i++) {
+        if (term1->characters[i] != term2->characters[i]) {
+            return (term1->characters[i] < term2->characters[i]) ? -1 : 1;
+        }
+    }
+
+    if (term1->length < term2->length) { return -1; }
+    if (term1->length > term2->length) { return 1; }
+    return 0;
+}
+
+
+/// Merges runs of equal terms in the sorted array into single terms counting their occurrences and
+/// returns the number of distinct terms.
+static size_t _tsearch_ternarytree_merge_document_terms(_tsearch_ternarytree_document_term *terms,
+                                                        const size_t count)
+{
+    if (terms == NULL || count == 0) { return 0; }
+
+    size_t distinctCount = 1;
+    for (size_t i = 1; i < count; i++) {
+        _tsearch_ternarytree_document_term *last = &(terms[distinctCount - 1]);
+        if (_tsearch_ternarytree_document_term_compare(last, &(terms[i])) == 0) {
+            last->count += 1;
+        } else {
+            terms[distinctCount] = terms[i];
+            distinctCount += 1;
+        }
+    }
+    return distinctCount;
+}
+
+
+/// Inserts the sorted, distinct terms. The nodes matching each character of the previous term are
+/// kept in a path, so each term resumes from the end of the prefix it shares with the previous term
+/// instead of searching from the root again.
+static result _tsearch_ternarytree_insert_document_terms(const tsearch_ternarytree_ptr root,
+                                                         const _tsearch_ternarytree_document_term *terms,
+                                                         const size_t count, const size_t maxLength,
+                                                         const GNEInteger documentID)
+{
+    if (root == NULL) { return failure; }
+    if (count == 0) { return success; }
+
+    tsearch_ternarytree_ptr *path = calloc(maxLength, sizeof(tsearch_ternarytree_ptr));
+    if (path == NULL) { return failure; }
+
+    const _tsearch_ternarytree_document_term *previous = NULL;
+    for (size_t i = 0; i < count; i++) {
+        const _tsearch_ternarytree_document_term *term = &(terms[i]);
+
+        // Terms are distinct and sorted, so a shared prefix is always shorter than the term.
+        size_t depth = 0;
+        if (previous != NULL) {
+            while (depth < previous->length && depth < term->length &&
+                   term->characters[depth] == previous->characters[depth]) {
+                depth += 1;
+            }
+        }
+
+        tsearch_ternarytree_ptr node = root;
+        if (depth > 0) {
+            tsearch_ternarytree_ptr parent = path[depth - 1];
+            if (parent->same == NULL) {
+                parent->same = _tsearch_ternarytree_node_init(root, parent);
+                if (parent->same == NULL) { free(path); return failure; }
+            }
+            node = parent->same;
+        }
+
+        while (true) {
+            const char character = term->characters[depth];
+            if (node->character == '\0') { node->character = character; }
+
+            if (character < node->character) {
+                if (node->lower == NULL) {
+                    node->lower = _tsearch_ternarytree_node_init(root, node);
+                    if (node->lower == NULL) { free(path); return failure; }
+                }
+                node = node->lower;
+                continue;
+            }
+
+            if (character > node->character) {
+                if (node->higher == NULL) {
+                    node->higher = _tsearch_ternarytree_node_init(root, node);
+                    if (node->higher == NULL) { free(path); return failure; }
+                }
+                node = node->higher;
+                continue;
+            }
+
+            path[depth] = node;
+            if (depth + 1 == term->length) { break; }
+
+            depth += 1;
+            if (node->same == NULL) {
+                node->same = _tsearch_ternarytree_node_init(root, node);
+                if (node->same == NULL) { free(path); return failure; }
+            }
+            node = node->same;
+        }
+
+        if (_tsearch_ternarytree_add_document_id(root, node, documentID, term->count) == failure) {
+            free(path);
+            return failure;
+        }
+        previous = term;
+    }
+
+    free(path);
+    return success;
+}
+
+
+tsearch_ternarytree_ptr _tsearch_ternarytree_search(tsearch_ternarytree_ptr ptr, const char *target)
+{
+    if (!_tsearch_cstring_is_nonempty(target)) { return NULL; }
+
+    const char *cursor = target;
+    while (ptr != NULL) {
+        char targetCharacter = *cursor;
+
+        if (targetCharacter < ptr->character) {
+            ptr = ptr->lower;
+        } else if (targetCharacter > ptr->character) {
+            ptr = ptr->higher;
+        } else {
+            if (cursor[1] == '\0') { return ptr; }
+            cursor += 1;
+            ptr = ptr->same;
+        }
+    }
+
+    return NULL;
+}
+
+
+/// Writes a new counted set with the document IDs of every word starting with the prefix ending at
+/// ptr, or NULL if there aren't any.
+static result _tsearch_ternarytree_copy_prefix_document_ids(const tsearch_ternarytree_ptr ptr,
+                                                            tsearch_countedset_ptr *outDocumentIDs)
+{
+    *outDocumentIDs = NULL;
+
+    _tsearch_ternarytree_document_id_sets sets = { NULL, 0, 0 };
+    if (_tsearch_ternarytree_has_valid_document_ids(ptr) == true &&
+        _tsearch_ternarytree_append_document_id_set(ptr->documentIDs, &sets) == failure) {
+        free(sets.sets);
+        return failure;
+    }
+
+    if (_tsearch_ternarytree_visit_document_ids_from_node(ptr->same, _tsearch_ternarytree_append_document_id_set,
+                                                          &sets) == failure) {
+        free(sets.sets);
+        return failure;
+    }
+
+    return _tsearch_ternarytree_take_document_id_sets(&sets, outDocumentIDs);
+}
+
+
+/// Copies the search's results from the query cache if it's there. Otherwise, runs the search
+/// and adds its results to the cache, including when nothing matched, because searches without
+/// matches are as slow as any other. Returns NULL on failure or if nothing matched.
+static tsearch_countedset_ptr _tsearch_ternarytree_copy_cached_search_results(const tsearch_ternarytree_ptr ptr,
+                                                                              const _tsearch_querycache_kind kind,
+                                                                              const char *target,
+                                                                              const size_t length,
+                                                                              const search_func func)
+{
+    _tsearch_querycache *cache = _tsearch_ternarytree_get_root(ptr)->queryCache;
+    tsearch_countedset_ptr results = NULL;
+    if (_tsearch_querycache_copy(cache, kind, target, length, &results) == true) { return results; }
+
+    if (func(ptr, target, length, &results) == failure) { return NULL; }
+    (void)_tsearch_querycache_insert(cache, kind, target, length, results);
+    return results;
+}
+
+
+/// Writes a new counted set with the document IDs of every word starting with the null-terminated
+/// prefix, or NULL if there aren't any. The length is only used by the query cache.
+static result _tsearch_ternarytree_copy_prefix_matches(const tsearch_ternarytree_ptr ptr, const char *prefix,
+                                                       const size_t length, tsearch_countedset_ptr *outResults)
+{
+    (void)length;
+    *outResults = NULL;
+
+    tsearch_ternarytree_ptr foundPtr = _tsearch_ternarytree_search(ptr, prefix);
+    if (foundPtr == NULL) { return success; }
+
+    tsearch_countedset_ptr indexedResults = NULL;
+    if (_tsearch_ternarytree_get_indexed_prefix_results(ptr, prefix, foundPtr, &indexedResults) == true) {
+        if (tsearch_countedset_get_count(indexedResults) == 0) { return success; }
+        *outResults = tsearch_countedset_copy(indexedResults);
+        return (*outResults != NULL) ? success : failure;
+    }
+
+    return _tsearch_ternarytree_copy_prefix_document_ids(foundPtr, outResults);
+}
+
+
+static result _tsearch_ternarytree_copy_partial_matches(const tsearch_ternarytree_ptr ptr, const char *target,
+                                                        const size_t length, tsearch_countedset_ptr *outResults)
+{
+    *outResults = NULL;
+
+    _tsearch_trigramindex *trigramIndex = _tsearch_ternarytree_get_root(ptr)->trigramIndex;
+    if (trigramIndex != NULL && length >= 3) {
+        return _tsearch_ternarytree_copy_trigram_matches(trigramIndex, target, length, outResults);
+    }
+
+    size_t *prefixTable = NULL;
+    if (_tsearch_build_prefix_table(target, length, &prefixTable) == failure) { return failure; }
+
+    _tsearch_ternarytree_document_id_sets results = { NULL, 0, 0 };
+    if (_tsearch_ternarytree_find_partial_match(ptr, target, length, prefixTable, 0, &results) == failure) {
+        free(prefixTable);
+        free(results.sets);
+        return failure;
+    }
+
+    free(prefixTable);
+    return _tsearch_ternarytree_take_document_id_sets(&results, outResults);
+}
+
+
+static result _tsearch_ternarytree_copy_subsequence_matches(const tsearch_ternarytree_ptr ptr, const char *target,
+                                                            const size_t length, tsearch_countedset_ptr *outResults)
+{
+    *outResults = NULL;
+
+    _tsearch_ternarytree_document_id_sets results = { NULL, 0, 0 };
+    if (_tsearch_ternarytree_find_subsequence_match(ptr, target, length, 0, &results) == failure) {
+        free(results.sets);
+        return failure;
+    }
+
+    return _tsearch_ternarytree_take_document_id_sets(&results, outResults);
+}
+
+
+static result _tsearch_ternarytree_copy_suffix_matches(const tsearch_ternarytree_ptr ptr, const char *suffix,
+                                                       const size_t length, tsearch_countedset_ptr *outResults)
+{
+    *outResults = NULL;
+
+    tsearch_ternarytree_ptr reversedTree = _tsearch_ternarytree_get_root(ptr)->reversedTree;
+    if (reversedTree != NULL) {
+        return _tsearch_ternarytree_copy_reversed_prefix_matches(reversedTree, suffix, length, outResults);
+    }
+
+    _tsearch_ternarytree_document_id_sets results = { NULL, 0, 0 };
+    if (_tsearch_ternarytree_find_suffix(ptr, suffix, length, &results) == failure) {
+        free(results.sets);
+        return failure;
+    }
+
+    return _tsearch_ternarytree_take_document_id_sets(&results, outResults);
+}
+
+
+/// Only the words that have every one of the target's grams can contain it, so those are found by
+/// intersecting the grams' words in the trigram index, and then checked for the target itself
+/// unless it's a single gram. Words never contain null characters, so neither do the targets that
+/// match them.
+static result _tsearch_ternarytree_copy_trigram_matches(_tsearch_trigramindex *index, const char *target,
+                                                       const size_t length, tsearch_countedset_ptr *outResults)
+{
+    *outResults = NULL;
+    if (memchr(target, '\0', length) != NULL) { return success; }
+
+    size_t gramCount = length - 2;
+    size_t byteLength = 0;
+    if (_tsearch_size_mul_overflows(gramCount, sizeof(uint32_t), &byteLength)) { return failure; }
+
+    uint32_t *grams = malloc(byteLength);
+    if (grams == NULL) { return failure; }
+    for (size_t i = 0; i < gramCount; i++) {
+        grams[i] = _tsearch_ternarytree_make_gram(target[i], target[i + 1], target[i + 2]);
+    }
+
+    void **nodes = NULL;
+    size_t count = 0;
+    result status = _tsearch_trigramindex_copy_nodes_with_grams(index, grams, gramCount, &nodes, &count);
+    free(grams);
+    if (status == failure) { return failure; }
+    if (count == 0) { return success; }
+
+    // The words are read from their last characters to their first, so they're searched for the
+    // reversed target.
+    char *reversedTarget = malloc(length);
+    size_t *prefixTable = NULL;
+    if (reversedTarget != NULL) {
+        for (size_t i = 0; i < length; i++) { reversedTarget[i] = target[length - 1 - i]; }
+        status = _tsearch_build_prefix_table(reversedTarget, length, &prefixTable);
+    }
+    if (reversedTarget == NULL || status == failure) {
+        free(reversedTarget);
+        free(prefixTable);
+        free(nodes);
+        return failure;
+    }
+
+    _tsearch_ternarytree_document_id_sets results = { NULL, 0, 0 };
+
+    for (size_t i = 0; i < count && status == success; i++) {
+        tsearch_ternarytree_ptr node = nodes[i];
+        if (_tsearch_ternarytree_has_valid_document_ids(node) == false) { continue; }
+        if (gramCount > 1 &&
+            _tsearch_ternarytree_word_contains_reversed(node, reversedTarget, length, prefixTable) == false) {
+            continue;
+        }
+        status = _tsearch_ternarytree_append_document_id_set(node->documentIDs, &results);
+    }
+
+    free(reversedTarget);
+    free(prefixTable);
+    free(nodes);
+    if (status == failure) {
+        free(results.sets);
+        return failure;
+    }
+    return _tsearch_ternarytree_take_document_id_sets(&results, outResults);
+}
+
+
+/// Returns true if the word ending at ptr, read from its last character to its first, contains the
+/// reversed target.
+static bool _tsearch_ternarytree_word_contains_reversed(const tsearch_ternarytree_ptr ptr,
+                                                        const char *reversedTarget, const size_t length,
+                                                        const size_t *prefixTable)
+{
+    size_t matchedLength = 0;
+    bool isOnlyWord = false;
+    tsearch_ternarytree_ptr current = ptr;
+
+    while (current != NULL) {
+        matchedLength = _tsearch_kmp_next_index(reversedTarget, prefixTable, matchedLength, current->character);
+        if (matchedLength == length) { return true; }
+        current = _tsearch_ternarytree_get_shorter_prefix_node(current, &isOnlyWord);
+    }
+
+    return false;
+}
+
+
+/// Suffixes of words are prefixes of the reversed words in the suffix index, so the suffix is
+/// reversed and searched for as a prefix, which only visits the words ending with it. Words never
+/// contain null characters, so neither do the suffixes that match them.
+static result _tsearch_ternarytree_copy_reversed_prefix_matches(const tsearch_ternarytree_ptr reversedTree,
+                                                                const char *suffix, const size_t length,
+                                                                tsearch_countedset_ptr *outResults)
+{
+    *outResults = NULL;
+    if (memchr(suffix, '\0', length) != NULL) { return success; }
+
+    size_t byteLength = 0;
+    if (_tsearch_size_add_overflows(length, 1, &byteLength)) { return failure; }
+
+    char *reversedSuffix = malloc(byteLength);
+    if (reversedSuffix == NULL) { return failure; }
+    for (size_t i = 0; i < length; i++) { reversedSuffix[i] = suffix[length - 1 - i]; }
+    reversedSuffix[length] = '\0';
+
+    tsearch_ternarytree_ptr foundPtr = _tsearch_ternarytree_search(reversedTree, reversedSuffix);
+    free(reversedSuffix);
+    if (foundPtr == NULL) { return success; }
+
+    return _tsearch_ternarytree_copy_prefix_document_ids(foundPtr, outResults);
+}
+
+
+/// Every search gathers the postings of its matching words first, so that they can be merged in
+/// one pass. Frees the sets' array and writes a counted set with their contents, or NULL if there
+/// aren't any sets.
+static result _tsearch_ternarytree_take_document_id_sets(_tsearch_ternarytree_document_id_sets *sets,
+                                                         tsearch_countedset_ptr *outResults)
+{
+    *outResults = NULL;
+    if (sets->count == 1) { *outResults = tsearch_countedset_copy(sets->sets[0]); }
+    else if (sets->count > 1) { *outResults = _tsearch_countedset_init_with_union_of_sets(sets->sets, sets->count); }
+
+    bool didCopy = (sets->count == 0 || *outResults != NULL);
+    free(sets->sets);
+    *sets = (_tsearch_ternarytree_document_id_sets){ NULL, 0, 0 };
+    return (didCopy == true) ? success : failure;
+}
+
+
+result _tsearch_ternarytree_copy_words_from_node(const tsearch_ternarytree_ptr ptr,
+                                                 _tsearch_ternarytree_document_id_sets *results)
+{
+    if (results == NULL) { return failure; }
+    return _tsearch_ternarytree_visit_document_ids_from_node(ptr, _tsearch_ternarytree_append_document_id_set,
+                                                             results);
+}
+
+
+/// Calls func with the document IDs of every word in the subtree rooted at ptr, including the
+/// lower and higher branches of ptr itself. Stops and returns failure as soon as func fails.
+static result _tsearch_ternarytree_visit_document_ids_from_node(const tsearch_ternarytree_ptr ptr,
+                                                                const document_ids_func func, void *context)
+{
+    if (ptr == NULL) { return success; }
+    if (func == NULL) { return failure; }
+
+    tsearch_ternarytree_ptr stopParent = ptr->parent;
+    tsearch_ternarytree_ptr previous = stopParent;
+    tsearch_ternarytree_ptr current = ptr;
+
+    while (current != stopParent) {
+        tsearch_ternarytree_ptr next = NULL;
         bool shouldProcess = false;
 
         if (previous == current->parent) {
@@ -460,7 +2172,7 @@ result _tsearch_ternarytree_copy_words_from_node(const tsearch_ternarytree_ptr p
 
         if (shouldProcess == true) {
             if (_tsearch_ternarytree_has_valid_document_ids(current) == true &&
-                tsearch_countedset_union(results, current->documentIDs) == failure) {
+                func(current->documentIDs, context) == failure) {
                 return failure;
             }
 
@@ -477,62 +2189,41 @@ result _tsearch_ternarytree_copy_words_from_node(const tsearch_ternarytree_ptr p
 }
 
 
-static result _tsearch_build_prefix_table(const char *target, const size_t length, size_t **outTable)
+static result _tsearch_ternarytree_append_document_id_set(const tsearch_countedset_ptr documentIDs, void *context)
 {
-    if (target == NULL || length == 0 || outTable == NULL) { return failure; }
-    *outTable = NULL;
-
-    size_t byteLength = 0;
-    if (_tsearch_size_mul_overflows(length, sizeof(size_t), &byteLength)) {
-        return failure;
-    }
-
-    size_t *table = calloc(1, byteLength);
-    if (table == NULL) { return failure; }
+    _tsearch_ternarytree_document_id_sets *sets = (_tsearch_ternarytree_document_id_sets *)context;
+    if (sets == NULL) { return failure; }
 
-    size_t matched = 0;
-    for (size_t i = 1; i < length; i++) {
-        while (matched > 0 && target[i] != target[matched]) {
-            matched = table[matched - 1];
+    if (sets->count >= sets->capacity) {
+        size_t newCapacity = (sets->capacity == 0) ? 16 : sets->capacity;
+        size_t byteLength = 0;
+        if (sets->capacity == 0) {
+            if (_tsearch_size_mul_overflows(newCapacity, sizeof(tsearch_countedset_ptr), &byteLength)) {
+                return failure;
+            }
+        } else if (_tsearch_next_buf_len(&newCapacity, sizeof(tsearch_countedset_ptr), &byteLength) == failure) {
+            return failure;
         }
 
-        if (target[i] == target[matched]) {
-            matched += 1;
-        }
+        tsearch_countedset_ptr *newSets = realloc(sets->sets, byteLength);
+        if (newSets == NULL) { return failure; }
 
-        table[i] = matched;
+        sets->sets = newSets;
+        sets->capacity = newCapacity;
     }
 
-    *outTable = table;
+    sets->sets[sets->count] = documentIDs;
+    sets->count += 1;
     return success;
 }
 
 
-static size_t _tsearch_kmp_next_index(const char *target,
-                                      const size_t *prefixTable,
-                                      size_t currentIndex,
-                                      const char character)
-{
-    if (target == NULL || prefixTable == NULL) { return 0; }
-
-    while (currentIndex > 0 && character != target[currentIndex]) {
-        currentIndex = prefixTable[currentIndex - 1];
-    }
-
-    if (character == target[currentIndex]) {
-        currentIndex += 1;
-    }
-
-    return currentIndex;
-}
-
-
 result _tsearch_ternarytree_find_partial_match(const tsearch_ternarytree_ptr ptr,
                                                const char *target,
                                                const size_t length,
                                                const size_t *prefixTable,
                                                size_t currentIndex,
-                                               tsearch_countedset_ptr results)
+                                               _tsearch_ternarytree_document_id_sets *results)
 {
     if (ptr == NULL) { return success; }
     if (target == NULL || prefixTable == NULL || length == 0 || results == NULL) { return failure; }
@@ -557,7 +2248,7 @@ result _tsearch_ternarytree_find_partial_match(const tsearch_ternarytree_ptr ptr
         bool shouldSearchSame = true;
         if (nextIndex == length) {
             if (_tsearch_ternarytree_has_valid_document_ids(node) == true &&
-                tsearch_countedset_union(results, node->documentIDs) == failure) {
+                _tsearch_ternarytree_append_document_id_set(node->documentIDs, results) == failure) {
                 free(stack);
                 return failure;
             }
@@ -602,7 +2293,7 @@ result _tsearch_ternarytree_find_subsequence_match(const tsearch_ternarytree_ptr
                                                    const char *target,
                                                    const size_t length,
                                                    size_t currentIndex,
-                                                   tsearch_countedset_ptr results)
+                                                   _tsearch_ternarytree_document_id_sets *results)
 {
     if (ptr == NULL) { return success; }
     if (target == NULL || length == 0 || results == NULL) { return failure; }
@@ -630,7 +2321,7 @@ result _tsearch_ternarytree_find_subsequence_match(const tsearch_ternarytree_ptr
 
         if (nextIndex == length) {
             if (_tsearch_ternarytree_has_valid_document_ids(node) == true &&
-                tsearch_countedset_union(results, node->documentIDs) == failure) {
+                _tsearch_ternarytree_append_document_id_set(node->documentIDs, results) == failure) {
                 free(stack);
                 return failure;
             }
@@ -666,7 +2357,7 @@ result _tsearch_ternarytree_find_subsequence_match(const tsearch_ternarytree_ptr
 
 
 result _tsearch_ternarytree_find_suffix(const tsearch_ternarytree_ptr ptr, const char *suffix,
-                                        const size_t length, tsearch_countedset_ptr results)
+                                        const size_t length, _tsearch_ternarytree_document_id_sets *results)
 {
     if (ptr == NULL) { return success; }
     if (suffix == NULL || length == 0 || results == NULL) { return failure; }
@@ -703,7 +2394,7 @@ result _tsearch_ternarytree_find_suffix(const tsearch_ternarytree_ptr ptr, const
                 }
 
                 if (search.didMatch == true &&
-                    tsearch_countedset_union(results, current->documentIDs) == failure) {
+                    _tsearch_ternarytree_append_document_id_set(current->documentIDs, results) == failure) {
                     return failure;
                 }
             }
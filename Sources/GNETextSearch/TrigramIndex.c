@@ -0,0 +1,183 @@
+//
+//  TrigramIndex.c
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#include "TrigramIndex.h"
+#include "GNETextSearchPrivate.h"
+#include "NodeTable.h"
+#include <string.h>
+
+// ------------------------------------------------------------------------------------------
+
+struct _tsearch_trigramindex
+{
+    _tsearch_hashtable table; // Each slot is a _tsearch_nodetable_slot keyed by gram.
+    size_t nodesByteLength; // The bytes taken by the slots' node lists.
+};
+
+// ------------------------------------------------------------------------------------------
+
+static _tsearch_nodetable_slot * _tsearch_trigramindex_get_slot(const _tsearch_trigramindex *index,
+                                                                 const uint32_t gram);
+static size_t _tsearch_trigramindex_find_node(void *const *nodes, size_t start, const size_t count,
+                                              const void *node);
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Trigram Index
+// ------------------------------------------------------------------------------------------
+_tsearch_trigramindex * _tsearch_trigramindex_init(void)
+{
+    _tsearch_trigramindex *index = calloc(1, sizeof(_tsearch_trigramindex));
+    if (index == NULL) { return NULL; }
+
+    if (_tsearch_nodetable_init(&(index->table)) == failure) { free(index); return NULL; }
+    index->nodesByteLength = 0;
+    return index;
+}
+
+
+void _tsearch_trigramindex_free(_tsearch_trigramindex *index)
+{
+    if (index == NULL) { return; }
+
+    _tsearch_nodetable_free(&(index->table));
+    free(index);
+}
+
+
+size_t _tsearch_trigramindex_get_count(const _tsearch_trigramindex *index)
+{
+    return (index == NULL) ? 0 : index->table.count;
+}
+
+
+size_t _tsearch_trigramindex_get_byte_length(const _tsearch_trigramindex *index)
+{
+    if (index == NULL) { return 0; }
+    return sizeof(_tsearch_trigramindex) + _tsearch_hashtable_get_byte_length(&(index->table)) +
+           index->nodesByteLength;
+}
+
+
+result _tsearch_trigramindex_add(_tsearch_trigramindex *index, const uint32_t gram, void *node)
+{
+    if (index == NULL || node == NULL) { return failure; }
+
+    size_t slotIndex = 0;
+    _tsearch_nodetable_slot *slot = _tsearch_nodetable_find(&(index->table), gram, &slotIndex);
+    if (slot->nodes == NULL) {
+        if (_tsearch_nodetable_add(&(index->table), gram, node) == failure) { return failure; }
+        // Adding the slot may have grown the table, so the slot is looked up again.
+        slot = _tsearch_trigramindex_get_slot(index, gram);
+        index->nodesByteLength += slot->capacity * sizeof(void *);
+        return success;
+    }
+
+    size_t position = _tsearch_trigramindex_find_node(slot->nodes, 0, slot->count, node);
+    if (position < slot->count && slot->nodes[position] == node) { return success; }
+
+    size_t oldCapacity = slot->capacity;
+    if (_tsearch_nodetable_slot_insert(slot, position, node) == failure) { return failure; }
+    index->nodesByteLength += (slot->capacity - oldCapacity) * sizeof(void *);
+    return success;
+}
+
+
+void _tsearch_trigramindex_remove(_tsearch_trigramindex *index, const uint32_t gram, const void *node)
+{
+    if (index == NULL || node == NULL) { return; }
+
+    size_t slotIndex = 0;
+    _tsearch_nodetable_slot *slot = _tsearch_nodetable_find(&(index->table), gram, &slotIndex);
+    if (slot->nodes == NULL) { return; }
+
+    size_t position = _tsearch_trigramindex_find_node(slot->nodes, 0, slot->count, node);
+    if (position >= slot->count || slot->nodes[position] != node) { return; }
+
+    if (slot->count == 1) {
+        index->nodesByteLength -= slot->capacity * sizeof(void *);
+        free(slot->nodes);
+        _tsearch_hashtable_remove(&(index->table), slotIndex);
+        return;
+    }
+
+    memmove(&(slot->nodes[position]), &(slot->nodes[position + 1]), (slot->count - position - 1) * sizeof(void *));
+    slot->count -= 1;
+}
+
+
+result _tsearch_trigramindex_copy_nodes_with_grams(const _tsearch_trigramindex *index,
+                                                   const uint32_t *grams, const size_t gramCount,
+                                                   void ***outNodes, size_t *outCount)
+{
+    if (outNodes == NULL || outCount == NULL) { return failure; }
+    *outNodes = NULL;
+    *outCount = 0;
+    if (index == NULL || grams == NULL || gramCount == 0) { return failure; }
+
+    // The gram with the fewest nodes bounds the intersection, so its nodes are the candidates.
+    const _tsearch_nodetable_slot *smallest = NULL;
+    for (size_t i = 0; i < gramCount; i++) {
+        const _tsearch_nodetable_slot *slot = _tsearch_trigramindex_get_slot(index, grams[i]);
+        if (slot->nodes == NULL) { return success; }
+        if (smallest == NULL || slot->count < smallest->count) { smallest = slot; }
+    }
+
+    size_t byteLength = 0;
+    if (_tsearch_size_mul_overflows(smallest->count, sizeof(void *), &byteLength)) { return failure; }
+    void **nodes = malloc(byteLength);
+    if (nodes == NULL) { return failure; }
+    memcpy(nodes, smallest->nodes, byteLength);
+    size_t count = smallest->count;
+
+    // Both lists are sorted, so each search for a candidate starts where the previous one ended.
+    for (size_t i = 0; i < gramCount && count > 0; i++) {
+        const _tsearch_nodetable_slot *slot = _tsearch_trigramindex_get_slot(index, grams[i]);
+        if (slot == smallest) { continue; }
+
+        size_t keptCount = 0;
+        size_t start = 0;
+        for (size_t j = 0; j < count; j++) {
+            start = _tsearch_trigramindex_find_node(slot->nodes, start, slot->count, nodes[j]);
+            if (start >= slot->count) { break; }
+            if (slot->nodes[start] == nodes[j]) { nodes[keptCount++] = nodes[j]; }
+        }
+        count = keptCount;
+    }
+
+    if (count == 0) { free(nodes); return success; }
+    *outNodes = nodes;
+    *outCount = count;
+    return success;
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Private
+// ------------------------------------------------------------------------------------------
+/// Returns the gram's slot or, if the gram isn't in the index, the empty slot where it belongs.
+static _tsearch_nodetable_slot * _tsearch_trigramindex_get_slot(const _tsearch_trigramindex *index,
+                                                                 const uint32_t gram)
+{
+    size_t slotIndex = 0;
+    return _tsearch_nodetable_find(&(index->table), gram, &slotIndex);
+}
+
+
+/// Returns the position of the first of the sorted nodes from start on whose address isn't lower
+/// than the node's, which is count if there isn't one.
+static size_t _tsearch_trigramindex_find_node(void *const *nodes, size_t start, const size_t count,
+                                              const void *node)
+{
+    size_t end = count;
+    while (start < end) {
+        size_t middle = start + (end - start) / 2;
+        if ((uintptr_t)nodes[middle] < (uintptr_t)node) { start = middle + 1; }
+        else { end = middle; }
+    }
+    return start;
+}
@@ -0,0 +1,49 @@
+//
+//  TrigramIndex.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_trigramindex_h
+#define tsearch_trigramindex_h
+
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A hash table mapping each three-byte gram to the nodes ending the words that contain it. Like the
+/// document index, it stores the nodes as opaque pointers and never dereferences them. Each gram's
+/// nodes are kept sorted by address, so that the nodes of several grams can be intersected.
+typedef struct _tsearch_trigramindex _tsearch_trigramindex;
+
+_tsearch_trigramindex * _tsearch_trigramindex_init(void);
+void _tsearch_trigramindex_free(_tsearch_trigramindex *index);
+
+/// Returns the number of grams in the index.
+size_t _tsearch_trigramindex_get_count(const _tsearch_trigramindex *index);
+
+/// Returns the number of bytes taken by the index's table and node lists.
+size_t _tsearch_trigramindex_get_byte_length(const _tsearch_trigramindex *index);
+
+/// Adds the node to the gram's nodes. Does nothing if the gram already has the node.
+result _tsearch_trigramindex_add(_tsearch_trigramindex *index, const uint32_t gram, void *node);
+
+/// Removes the node from the gram's nodes, and the gram from the index if that was its last node.
+/// Does nothing if the gram doesn't have the node.
+void _tsearch_trigramindex_remove(_tsearch_trigramindex *index, const uint32_t gram, const void *node);
+
+/// Writes a new array, which the caller must free, with the nodes that every one of the grams has.
+/// Writes NULL and 0 if there aren't any. The grams may repeat.
+result _tsearch_trigramindex_copy_nodes_with_grams(const _tsearch_trigramindex *index,
+                                                   const uint32_t *grams, const size_t gramCount,
+                                                   void ***outNodes, size_t *outCount);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_trigramindex_h */
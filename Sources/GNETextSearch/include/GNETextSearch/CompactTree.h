@@ -0,0 +1,81 @@
+//
+//  CompactTree.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_compacttree_h
+#define tsearch_compacttree_h
+
+#include <GNETextSearch/CountedSet.h>
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// A ternary tree that stores its nodes in one contiguous array. Nodes refer to their children by
+/// 32-bit indices and to their document IDs by 32-bit postings IDs, so a node takes 20 bytes instead
+/// of the 48 bytes used by tsearch_ternarytree. The functions mirror the tsearch_ternarytree API.
+typedef struct tsearch_compacttree * tsearch_compacttree_ptr;
+
+tsearch_compacttree_ptr tsearch_compacttree_init(void);
+void tsearch_compacttree_free(const tsearch_compacttree_ptr ptr);
+
+/// Inserts a non-empty null-terminated string. NULL and empty strings are ignored and return ptr.
+/// Passing a NULL tree creates a new one. Failed allocations leave the tree in a valid state and
+/// return the current tree pointer.
+tsearch_compacttree_ptr tsearch_compacttree_insert(tsearch_compacttree_ptr ptr,
+                                                   const char *newCharacter, const GNEInteger documentID);
+
+/// Removes the document ID from every word in the tree. Only the postings are visited, not the nodes.
+result tsearch_compacttree_remove(const tsearch_compacttree_ptr ptr, const GNEInteger documentID);
+
+/// Returns the number of nodes in the tree.
+size_t tsearch_compacttree_get_node_count(const tsearch_compacttree_ptr ptr);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target. The caller is
+/// responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL or empty target strings.
+tsearch_countedset_ptr tsearch_compacttree_copy_search_results(const tsearch_compacttree_ptr ptr, const char *target);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target prefix. The caller
+/// is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL or empty prefixes.
+tsearch_countedset_ptr tsearch_compacttree_copy_prefix_search_results(const tsearch_compacttree_ptr ptr,
+                                                                      const char *prefix);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target string. The caller
+/// is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL targets or a zero length.
+tsearch_countedset_ptr tsearch_compacttree_copy_partial_search_results(const tsearch_compacttree_ptr ptr,
+                                                                       const char *target,
+                                                                       const size_t length);
+
+/// Returns a tsearch_countedset_ptr with the IDs of documents containing a word where the target
+/// appears as an ordered subsequence. The caller is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL targets, a zero length, or no matches.
+tsearch_countedset_ptr tsearch_compacttree_copy_subsequence_search_results(const tsearch_compacttree_ptr ptr,
+                                                                           const char *target,
+                                                                           const size_t length);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target suffix. The caller
+/// is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL suffixes or a zero length.
+tsearch_countedset_ptr tsearch_compacttree_copy_suffix_search_results(const tsearch_compacttree_ptr ptr,
+                                                                      const char *suffix,
+                                                                      const size_t length);
+
+/// Copies all words contained in the tree into outResults (which must be freed by the caller).
+/// On failure, writes NULL and 0.
+result tsearch_compacttree_copy_contents(const tsearch_compacttree_ptr ptr, char **outResults, size_t *outLength);
+
+void tsearch_compacttree_print(const tsearch_compacttree_ptr ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_compacttree_h */
@@ -17,12 +17,44 @@ extern "C" {
 
 typedef struct tsearch_countedset * tsearch_countedset_ptr;
 
+/// AVL trees are at most 1.44 * log2(n) nodes tall, so no counted set that fits in memory is
+/// taller than this.
+#define TSEARCH_COUNTEDSET_MAX_HEIGHT 96
+
+/// Removing an integer frees its node for the next integer added. By default, a counted set rebuilds
+/// itself without its free nodes once they make up this percentage of its nodes.
+#define TSEARCH_COUNTEDSET_DEFAULT_COMPACTION_PERCENT 50
+
+/// Visits a counted set's integers and their counts in ascending order without allocating any
+/// memory, so it can live on the stack. The set must not be modified while it's being iterated.
+/// The members are private.
+typedef struct tsearch_countedset_iterator
+{
+    tsearch_countedset_ptr set;
+    size_t stack[TSEARCH_COUNTEDSET_MAX_HEIGHT];
+    size_t stackCount;
+    size_t nextIndex;
+} tsearch_countedset_iterator;
+
+/// Called for each integer in the counted set. Return true to continue or false to stop.
+typedef bool(*tsearch_countedset_foreach_func)(const GNEInteger integer, const size_t count, void *context);
+
 tsearch_countedset_ptr tsearch_countedset_init(void);
+
+/// Creates a counted set containing each of the count integers, which may be unsorted and may
+/// contain duplicates. This is much faster than adding the integers one at a time: the integers
+/// are radix sorted, duplicates are collapsed into counts, and a balanced tree is built in a
+/// single allocation. Returns NULL on failure.
+tsearch_countedset_ptr tsearch_countedset_init_with_ints(const GNEInteger *integers, const size_t count);
 tsearch_countedset_ptr tsearch_countedset_copy(const tsearch_countedset_ptr ptr);
 void tsearch_countedset_free(const tsearch_countedset_ptr ptr);
 
 size_t tsearch_countedset_get_count(tsearch_countedset_ptr ptr);
 
+/// Returns the number of bytes allocated for the set, including the space its nodes have been given
+/// to grow into and its free nodes.
+size_t tsearch_countedset_get_byte_length(const tsearch_countedset_ptr ptr);
+
 /// Returns 1 if the counted set includes the integer, otherwise 0.
 bool tsearch_countedset_contains_int(const tsearch_countedset_ptr ptr, const GNEInteger integer);
 
@@ -30,23 +62,56 @@ bool tsearch_countedset_contains_int(const tsearch_countedset_ptr ptr, const GNE
 size_t tsearch_countedset_get_count_for_int(const tsearch_countedset_ptr ptr, const GNEInteger integer);
 
 /// Creates an array of all of the integers in the specified counted set in descending order
-/// (the integer with the largest count is returned first).
+/// (the integer with the largest count is returned first). Integers with equal counts are
+/// returned in ascending order.
 /// On success, writes a newly allocated array to outIntegers and its length to outCount.
 /// For an empty set, writes NULL and 0 and returns success.
 /// On failure, writes NULL and 0. The caller must free a non-NULL outIntegers value.
 result tsearch_countedset_copy_ints(const tsearch_countedset_ptr ptr, GNEInteger **outIntegers, size_t *outCount);
 
+/// Like tsearch_countedset_copy_ints(), but only copies the maxCount integers with the largest
+/// counts. Runs in O(n log maxCount) time and only allocates space for maxCount integers, so it's
+/// much faster than copying every integer when only the best few results will be shown.
+/// If maxCount is 0, writes NULL and 0 and returns success.
+result tsearch_countedset_copy_top_ints(const tsearch_countedset_ptr ptr, const size_t maxCount,
+                                        GNEInteger **outIntegers, size_t *outCount);
+
+/// Prepares the iterator to visit the specified counted set. Returns failure if ptr is NULL.
+result tsearch_countedset_iterator_init(tsearch_countedset_iterator *iterator, const tsearch_countedset_ptr ptr);
+
+/// Writes the next integer and its count and returns true, or returns false once every integer
+/// has been visited. Either out pointer may be NULL.
+bool tsearch_countedset_iterator_next(tsearch_countedset_iterator *iterator,
+                                      GNEInteger *outInteger, size_t *outCount);
+
+/// Calls the function with each integer and its count in ascending order until it returns false.
+/// Doesn't allocate any memory. Returns failure if ptr or func is NULL.
+result tsearch_countedset_foreach(const tsearch_countedset_ptr ptr, const tsearch_countedset_foreach_func func,
+                                  void *context);
+
 /// Adds the specified integer to the counted set. Returns 1 if successful, otherwise 0.
 /// If an existing integer count would overflow, returns failure and leaves the count unchanged.
 result tsearch_countedset_add_int(const tsearch_countedset_ptr ptr, const GNEInteger integer);
 
-/// Removes the specified integer from the counted set. Returns 1 if successful, otherwise 0.
+/// Removes the specified integer from the counted set and rebalances it in O(log n), so the tree's
+/// height follows the number of integers left in it. Returns 1 if successful, otherwise 0.
 /// Success is unrelated to whether or not the integer exists in the counted set.
 result tsearch_countedset_remove_int(const tsearch_countedset_ptr ptr, const GNEInteger integer);
 
 /// Removes all of the integers from the counted set.
 result tsearch_countedset_remove_all_ints(const tsearch_countedset_ptr ptr);
 
+/// Rebuilds the counted set as a balanced tree without its free nodes in O(n), which releases the
+/// memory they take. Call this after a batch of removals from a set whose compaction percentage is
+/// 0, or whenever a pause is cheap. Leaves the set unchanged on failure.
+result tsearch_countedset_compact(const tsearch_countedset_ptr ptr);
+
+/// Sets the percentage of free nodes, from 1 to 100, at which the counted set compacts itself
+/// after a removal. Pass 0 to keep removals from ever compacting the set, so that it's only
+/// compacted by tsearch_countedset_compact(). Copies keep the percentage of the set they're copied
+/// from. Returns failure if percent is greater than 100.
+result tsearch_countedset_set_compaction_percent(const tsearch_countedset_ptr ptr, const unsigned int percent);
+
 /// Adds each integer and its count in the other counted set to specified set.
 /// If allocation or count overflow fails, the destination set may have been partially mutated.
 result tsearch_countedset_union(const tsearch_countedset_ptr ptr, const tsearch_countedset_ptr otherPtr);
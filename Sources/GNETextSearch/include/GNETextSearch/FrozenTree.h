@@ -0,0 +1,87 @@
+//
+//  FrozenTree.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_frozentree_h
+#define tsearch_frozentree_h
+
+#include <GNETextSearch/CountedSet.h>
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// An immutable snapshot of a ternary tree created by tsearch_ternarytree_freeze() or opened from a
+/// file. The nodes are laid out in depth-first order in one contiguous buffer, together with each
+/// word's document IDs and counts packed into arrays sorted by document ID. The functions mirror the
+/// tsearch_ternarytree search API.
+typedef struct tsearch_frozentree * tsearch_frozentree_ptr;
+
+void tsearch_frozentree_free(const tsearch_frozentree_ptr ptr);
+
+/// Returns the number of nodes in the tree.
+size_t tsearch_frozentree_get_node_count(const tsearch_frozentree_ptr ptr);
+
+/// Writes the tree to the file at path, replacing the file if it exists. The file starts with a
+/// versioned header holding checksums of itself and of the tree, followed by the tree's buffer
+/// exactly as it is laid out in memory. Files use the byte order of the machine writing them.
+/// Returns failure if the file can't be written completely.
+result tsearch_frozentree_write_file(const tsearch_frozentree_ptr ptr, const char *path);
+
+/// Opens a file written by tsearch_frozentree_write_file() by mapping it into memory. Nothing is
+/// copied out of the file: searches read the mapped pages directly, so opening a file costs about
+/// as much as the mmap() call. The header is always validated. If shouldVerifyChecksum is true,
+/// the whole file is also read once to verify its checksum, which is recommended for files that
+/// may have been corrupted or changed since they were written. The file must not be modified
+/// while the tree is open. The caller is responsible for calling tsearch_frozentree_free().
+/// Returns NULL if the file can't be mapped, is invalid, or was written by an incompatible machine.
+tsearch_frozentree_ptr tsearch_frozentree_init_with_file(const char *path, const bool shouldVerifyChecksum);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target. The caller is
+/// responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL or empty target strings.
+tsearch_countedset_ptr tsearch_frozentree_copy_search_results(const tsearch_frozentree_ptr ptr, const char *target);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target prefix. The caller
+/// is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL or empty prefixes.
+tsearch_countedset_ptr tsearch_frozentree_copy_prefix_search_results(const tsearch_frozentree_ptr ptr,
+                                                                     const char *prefix);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target string. The caller
+/// is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL targets or a zero length.
+tsearch_countedset_ptr tsearch_frozentree_copy_partial_search_results(const tsearch_frozentree_ptr ptr,
+                                                                      const char *target,
+                                                                      const size_t length);
+
+/// Returns a tsearch_countedset_ptr with the IDs of documents containing a word where the target
+/// appears as an ordered subsequence. The caller is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL targets, a zero length, or no matches.
+tsearch_countedset_ptr tsearch_frozentree_copy_subsequence_search_results(const tsearch_frozentree_ptr ptr,
+                                                                          const char *target,
+                                                                          const size_t length);
+
+/// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target suffix. The caller
+/// is responsible for calling tsearch_countedset_free().
+/// Returns NULL for NULL suffixes or a zero length.
+tsearch_countedset_ptr tsearch_frozentree_copy_suffix_search_results(const tsearch_frozentree_ptr ptr,
+                                                                     const char *suffix,
+                                                                     const size_t length);
+
+/// Copies all words contained in the tree into outResults (which must be freed by the caller).
+/// On failure, writes NULL and 0.
+result tsearch_frozentree_copy_contents(const tsearch_frozentree_ptr ptr, char **outResults, size_t *outLength);
+
+void tsearch_frozentree_print(const tsearch_frozentree_ptr ptr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_frozentree_h */
@@ -4,5 +4,8 @@
 #include <GNETextSearch/Types.h>
 #include <GNETextSearch/CountedSet.h>
 #include <GNETextSearch/TernaryTree.h>
+#include <GNETextSearch/CompactTree.h>
+#include <GNETextSearch/FrozenTree.h>
+#include <GNETextSearch/PostingList.h>
 
 #endif /* GNETextSearch_h */
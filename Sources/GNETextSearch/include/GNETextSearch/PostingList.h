@@ -0,0 +1,86 @@
+//
+//  PostingList.h
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#ifndef tsearch_postinglist_h
+#define tsearch_postinglist_h
+
+#include <GNETextSearch/CountedSet.h>
+#include <GNETextSearch/Types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// An immutable list of integers and their counts, sorted by integer. It holds the same contents
+/// as a tsearch_countedset in far less memory, which makes it suited to postings that are built
+/// once and then only read, such as those of frozen or bulk-loaded trees.
+///
+/// Uncompressed lists store the integers and counts in two parallel arrays, taking 16 bytes for
+/// each integer instead of the 40 bytes a counted set takes. Compressed lists store the differences
+/// between consecutive integers and the counts as variable-length integers, which usually takes 2 or
+/// 3 bytes for each integer. Every 64th integer is also stored in a skip table, so lookups in
+/// compressed lists only decode one block of integers.
+typedef struct tsearch_postinglist * tsearch_postinglist_ptr;
+
+/// Creates a posting list with the contents of the counted set. Returns NULL on failure.
+tsearch_postinglist_ptr tsearch_postinglist_init_with_countedset(const tsearch_countedset_ptr set,
+                                                                 const bool shouldCompress);
+
+/// Creates a posting list from count integers, which must be in strictly ascending order, and their
+/// counts. Pass NULL counts to give every integer a count of 1.
+/// Returns NULL on failure or if the integers aren't sorted or a count is 0.
+tsearch_postinglist_ptr tsearch_postinglist_init_with_ints(const GNEInteger *integers, const size_t *counts,
+                                                           const size_t count, const bool shouldCompress);
+void tsearch_postinglist_free(const tsearch_postinglist_ptr ptr);
+
+/// Returns the number of integers in the list.
+size_t tsearch_postinglist_get_count(const tsearch_postinglist_ptr ptr);
+
+/// Returns the number of bytes used to store the integers and counts, not including the list itself.
+size_t tsearch_postinglist_get_byte_length(const tsearch_postinglist_ptr ptr);
+
+bool tsearch_postinglist_is_compressed(const tsearch_postinglist_ptr ptr);
+
+/// Returns true if the list includes the integer.
+bool tsearch_postinglist_contains_int(const tsearch_postinglist_ptr ptr, const GNEInteger integer);
+
+/// Returns the count for the specified integer. Returns 0 if the integer is not in the list.
+size_t tsearch_postinglist_get_count_for_int(const tsearch_postinglist_ptr ptr, const GNEInteger integer);
+
+/// Copies the integers in ascending order and their counts. For an empty list, writes NULL and 0 and
+/// returns success. On failure, writes NULL and 0. The caller must free non-NULL outIntegers and
+/// outCounts values.
+result tsearch_postinglist_copy_ints(const tsearch_postinglist_ptr ptr, GNEInteger **outIntegers,
+                                     size_t **outCounts, size_t *outCount);
+
+/// Returns a tsearch_countedset_ptr with the list's contents. The caller is responsible for calling
+/// tsearch_countedset_free(). Returns NULL on failure.
+tsearch_countedset_ptr tsearch_postinglist_copy_countedset(const tsearch_postinglist_ptr ptr);
+
+/// The set operations below merge the two lists in a single pass and return a new list, which is
+/// compressed if the first list is. They follow the tsearch_countedset operations of the same names.
+/// The caller is responsible for calling tsearch_postinglist_free(). Returns NULL on failure.
+
+/// Returns every integer in either list. Integers in both lists have their counts added together.
+tsearch_postinglist_ptr tsearch_postinglist_copy_union(const tsearch_postinglist_ptr ptr,
+                                                       const tsearch_postinglist_ptr otherPtr);
+
+/// Returns the integers in both lists, with their counts added together.
+tsearch_postinglist_ptr tsearch_postinglist_copy_intersection(const tsearch_postinglist_ptr ptr,
+                                                              const tsearch_postinglist_ptr otherPtr);
+
+/// Returns the list's integers with the other list's counts subtracted from theirs. Integers whose
+/// counts drop to 0 are left out.
+tsearch_postinglist_ptr tsearch_postinglist_copy_minus(const tsearch_postinglist_ptr ptr,
+                                                       const tsearch_postinglist_ptr otherPtr);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* tsearch_postinglist_h */
@@ -10,6 +10,7 @@
 #define GNETernaryTree_h
 
 #include <GNETextSearch/CountedSet.h>
+#include <GNETextSearch/FrozenTree.h>
 #include <GNETextSearch/Types.h>
 
 #ifdef __cplusplus
@@ -18,7 +19,45 @@ extern "C" {
 
 typedef struct tsearch_ternarytree_node *tsearch_ternarytree_ptr;
 
+typedef struct tsearch_ternarytree_entry
+{
+    const char *word;
+    GNEInteger documentID;
+} tsearch_ternarytree_entry;
+
+typedef struct tsearch_ternarytree_prefix_index_stats
+{
+    size_t prefixCount; // The number of prefixes whose document IDs are in the index.
+    size_t byteLength; // The memory taken by the index, including the document IDs.
+    size_t hitCount; // The prefix searches answered by the index.
+    size_t missCount; // The prefix searches short enough to have been answered by the index that weren't.
+} tsearch_ternarytree_prefix_index_stats;
+
+typedef struct tsearch_ternarytree_query_cache_stats
+{
+    size_t entryCount; // The number of searches whose results are in the cache.
+    size_t byteLength; // The memory taken by the cache, including the results.
+    size_t hitCount; // The searches answered by the cache.
+    size_t missCount; // The searches that had to search the tree.
+    size_t evictionCount; // The searches removed from the cache to make room for newer ones.
+} tsearch_ternarytree_query_cache_stats;
+
 tsearch_ternarytree_ptr tsearch_ternarytree_init(void);
+
+/// Creates an empty tree whose nodes are carved out of chunks holding nodesPerChunk nodes each instead
+/// of being allocated one at a time. Freeing the tree releases the chunks wholesale, and nodes released
+/// by tsearch_ternarytree_remove() are reused by later inserts. Pass 0 to use the default chunk size.
+/// Returns NULL on failure.
+tsearch_ternarytree_ptr tsearch_ternarytree_init_with_node_pool(const size_t nodesPerChunk);
+
+/// Creates a tree containing every entry, as if each one had been passed to tsearch_ternarytree_insert().
+/// The entries are sorted, so they may be passed in any order, and repeated entries increase their
+/// document ID's count. Each character's lower and higher branches are built by splitting the sorted
+/// characters at their median, so the tree is balanced regardless of the entries' order. All of the
+/// nodes are allocated at once from a node pool. Entries with NULL or empty words are ignored.
+/// Returns NULL on failure.
+tsearch_ternarytree_ptr tsearch_ternarytree_init_with_entries(const tsearch_ternarytree_entry *entries,
+                                                              const size_t count);
 void tsearch_ternarytree_free(const tsearch_ternarytree_ptr ptr);
 
 /// Inserts a non-empty null-terminated string. NULL and empty strings are ignored and return ptr.
@@ -26,18 +65,121 @@ void tsearch_ternarytree_free(const tsearch_ternarytree_ptr ptr);
 /// a valid state and return the current root pointer.
 tsearch_ternarytree_ptr tsearch_ternarytree_insert(tsearch_ternarytree_ptr ptr,
                                                    const char *newCharacter, const GNEInteger documentID);
+
+/// Tokenizes the null-terminated UTF-8 text and inserts each of its words with the document ID, as if
+/// each word had been passed to tsearch_ternarytree_insert(). The words are sorted and counted first,
+/// so a word appearing several times in the text is inserted once with its count, and each word
+/// continues from the nodes of the prefix it shares with the word before it instead of starting
+/// again at the root.
+/// Returns failure for NULL trees or text, malformed UTF-8, or allocation failure. Malformed text
+/// leaves the tree unchanged, but words inserted before an allocation failed remain in the tree.
+result tsearch_ternarytree_insert_document(const tsearch_ternarytree_ptr ptr,
+                                           const char *utf8Text,
+                                           const GNEInteger documentID);
+
+/// Starts keeping an index from each document ID to the words containing it, which is updated by
+/// every later insert. With the index, tsearch_ternarytree_remove() only visits the words in the
+/// removed document instead of every node in the tree. The index costs a pointer for each distinct
+/// word in each document. Enabling the index again has no effect.
+/// Returns failure if the index can't be allocated, in which case the tree doesn't have an index.
+result tsearch_ternarytree_enable_document_index(const tsearch_ternarytree_ptr ptr);
+
+/// Starts keeping an index from each prefix of up to maxLength bytes to the document IDs of every word
+/// starting with it, which is updated by every later insert and removal. With the index, searching for
+/// a prefix copies or borrows a single set instead of merging the postings of every word under it.
+/// Shorter prefixes are indexed first, and prefixes are only added while the index takes at most
+/// maxByteLength bytes, so the longer prefixes are left out when the limit is reached. Pass 0 for no
+/// limit. A prefix whose document IDs would grow past the limit is removed from the index, and it's
+/// only added back when the index is rebuilt or when a word is inserted that is the only word starting
+/// with the prefix.
+/// Enabling the index again rebuilds it with the new lengths and resets its counters, and a maxLength
+/// of 0 removes it. Returns failure if the index can't be built, in which case the tree doesn't have
+/// a prefix index.
+result tsearch_ternarytree_enable_prefix_index(const tsearch_ternarytree_ptr ptr,
+                                               const size_t maxLength, const size_t maxByteLength);
+
+/// Writes the size of the prefix index and how many prefix searches it answered, or zeros if the
+/// tree doesn't have a prefix index. Prefix searches update the counters, so while the tree has a
+/// prefix index, prefixes must not be searched for on several threads at once.
+/// Returns failure if ptr or outStats is NULL.
+result tsearch_ternarytree_get_prefix_index_stats(const tsearch_ternarytree_ptr ptr,
+                                                  tsearch_ternarytree_prefix_index_stats *outStats);
+
+/// Starts keeping a second tree holding every word with its characters reversed, which is updated by
+/// every later insert and removal. With the index, searching for a suffix searches the reversed tree
+/// for the reversed suffix as a prefix, which only visits the words ending with it instead of every
+/// node in the tree. The index takes about as much memory as the tree itself, and it has its own
+/// document index if the tree has one. Enabling the index again has no effect.
+/// Returns failure if the index can't be built, in which case the tree doesn't have a suffix index.
+/// If the index can't be updated later, it's removed, and suffix searches visit every node again.
+result tsearch_ternarytree_enable_suffix_index(const tsearch_ternarytree_ptr ptr);
+
+/// Starts keeping an index from every three-byte gram to the words containing it, which is updated
+/// by every later insert and removal. With the index, partial searches for targets of three or more
+/// bytes only check the words that have every one of the target's grams instead of visiting every
+/// node in the tree. Shorter targets are still searched for by visiting every node. Enabling the
+/// index again has no effect.
+/// Returns failure if the index can't be built, in which case the tree doesn't have a trigram index.
+/// If the index can't be updated later, it's removed, and partial searches visit every node again.
+result tsearch_ternarytree_enable_trigram_index(const tsearch_ternarytree_ptr ptr);
+
+/// Starts keeping the results of the most recent prefix, partial, subsequence, and suffix searches, so
+/// that searching for the same target again copies the earlier results instead of searching the tree.
+/// Searches without matches are kept too. When adding results would take the cache past maxByteLength
+/// bytes, the least recently used results are removed first. Every result is removed whenever the
+/// tree is changed by tsearch_ternarytree_insert(), tsearch_ternarytree_insert_document(),
+/// tsearch_ternarytree_remove(), or tsearch_ternarytree_remove_many().
+/// Searches change the cache, so while the tree has a query cache, it must not be searched on several
+/// threads at once. Enabling the cache again empties it and resets its counters, and a maxByteLength
+/// of 0 removes it. Returns failure if the cache can't be allocated, in which case the tree doesn't
+/// have a query cache.
+result tsearch_ternarytree_enable_query_cache(const tsearch_ternarytree_ptr ptr, const size_t maxByteLength);
+
+/// Writes the size of the query cache and how many searches it answered, or zeros if the tree doesn't
+/// have a query cache. Returns failure if ptr or outStats is NULL.
+result tsearch_ternarytree_get_query_cache_stats(const tsearch_ternarytree_ptr ptr,
+                                                 tsearch_ternarytree_query_cache_stats *outStats);
+
+/// Removes the document ID from every word in the tree. Nodes that are left without document IDs
+/// or children are released.
 result tsearch_ternarytree_remove(const tsearch_ternarytree_ptr ptr, const GNEInteger documentID);
 
+/// Removes each of the count document IDs from every word in the tree. Without a document index, the
+/// tree is traversed once for all of the document IDs, rather than once for each of them as separate
+/// calls to tsearch_ternarytree_remove() would. Nodes that are left without document IDs or children
+/// are released. Returns failure if documentIDs is NULL and count isn't 0, or if allocation fails.
+result tsearch_ternarytree_remove_many(const tsearch_ternarytree_ptr ptr,
+                                       const GNEInteger *documentIDs,
+                                       const size_t count);
+
 /// Returns a GNEIntegerCountedSet with the IDs of the documents containing the target. The caller is
 /// responsible for calling tsearch_countedset_free().
 /// Returns NULL for NULL or empty target strings.
 tsearch_countedset_ptr tsearch_ternarytree_copy_search_results(const tsearch_ternarytree_ptr ptr, const char *target);
 
+/// Returns the tree's own GNEIntegerCountedSet with the IDs of the documents containing the target
+/// instead of a copy of it, so counting the results or combining them with another set doesn't
+/// allocate. The set must only be read, never changed or freed. It remains valid until the tree
+/// is changed by tsearch_ternarytree_insert(), tsearch_ternarytree_insert_document(),
+/// tsearch_ternarytree_remove(), tsearch_ternarytree_remove_many(), or tsearch_ternarytree_free().
+/// Use tsearch_countedset_copy() to keep the results longer. Any number of threads may read
+/// borrowed sets at once as long as none of them changes the tree.
+/// Returns NULL for NULL or empty target strings or if no documents contain the target.
+tsearch_countedset_ptr tsearch_ternarytree_get_search_results(const tsearch_ternarytree_ptr ptr, const char *target);
+
 /// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target prefix. The caller
 /// is responsible for calling tsearch_countedset_free().
 /// Returns NULL for NULL or empty prefixes.
 tsearch_countedset_ptr tsearch_ternarytree_copy_prefix_search_results(const tsearch_ternarytree_ptr ptr, const char *prefix);
 
+/// Returns the prefix index's GNEIntegerCountedSet with the IDs of the documents containing the target
+/// prefix instead of a copy of it, like tsearch_ternarytree_get_search_results() does for words, and
+/// with the same lifetime. Returns NULL for NULL or empty prefixes, if no documents contain the prefix,
+/// or if the prefix isn't in the prefix index, in which case
+/// tsearch_ternarytree_copy_prefix_search_results() still finds its documents.
+tsearch_countedset_ptr tsearch_ternarytree_get_prefix_search_results(const tsearch_ternarytree_ptr ptr,
+                                                                     const char *prefix);
+
 /// Returns a tsearch_countedset_ptr with the IDs of the documents containing the target string. The caller
 /// is responsible for calling tsearch_countedset_free().
 /// Returns NULL for NULL targets or a zero length.
@@ -61,6 +203,11 @@ tsearch_countedset_ptr tsearch_ternarytree_copy_suffix_search_results(const tsea
                                                                       const char *suffix,
                                                                       const size_t length);
 
+/// Creates an immutable snapshot of the tree that can be searched with the tsearch_frozentree functions.
+/// The snapshot doesn't refer to the tree, so the tree can be changed or freed afterwards. The caller
+/// is responsible for calling tsearch_frozentree_free(). Returns NULL on failure.
+tsearch_frozentree_ptr tsearch_ternarytree_freeze(const tsearch_ternarytree_ptr ptr);
+
 /// Copies all words contained in the tree into outResults (which must be freed by the caller).
 /// On failure, writes NULL and 0.
 result tsearch_ternarytree_copy_contents(const tsearch_ternarytree_ptr ptr, char **outResults, size_t *outLength);
@@ -1,3 +1,6 @@
 #import <Foundation/Foundation.h>
 
 NSBundle *GNETextSearchTestResourcesBundle(void);
+
+/// Returns the Bible fixture as a dictionary mapping verse numbers to arrays of words.
+NSDictionary *GNETextSearchBibleDictionary(void);
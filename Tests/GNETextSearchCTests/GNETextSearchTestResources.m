@@ -50,3 +50,41 @@ NSBundle *GNETextSearchTestResourcesBundle(void)
 
     return bundle;
 }
+
+NSDictionary *GNETextSearchBibleDictionary(void)
+{
+    static NSDictionary *dictionary = nil;
+
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{
+        NSString *path = [GNETextSearchTestResourcesBundle() pathForResource:@"bible" ofType:@"archive"];
+        NSCParameterAssert(path);
+        NSError *error = nil;
+        NSData *data = [NSData dataWithContentsOfFile:path options:0 error:&error];
+        NSCAssert2(error == nil, @"Could not open %@: %@", path, error);
+
+        NSSet *classes = [NSSet setWithObjects:
+                          [NSDictionary class],
+                          [NSArray class],
+                          [NSNumber class],
+                          [NSString class],
+                          nil];
+        if (@available(macOS 10.13, *)) {
+            dictionary = [NSKeyedUnarchiver unarchivedObjectOfClasses:classes
+                                                             fromData:data
+                                                                error:&error];
+        } else {
+            id unarchivedObject = [NSKeyedUnarchiver unarchiveObjectWithData:data];
+            if ([unarchivedObject isKindOfClass:[NSDictionary class]]) {
+                dictionary = (NSDictionary *)unarchivedObject;
+            } else {
+                error = [NSError errorWithDomain:NSCocoaErrorDomain
+                                            code:NSFileReadCorruptFileError
+                                        userInfo:@{ NSLocalizedDescriptionKey : @"Could not unarchive bible archive as NSDictionary" }];
+            }
+        }
+        NSCAssert2(error == nil, @"Could not unarchive %@: %@", path, error);
+    });
+
+    return dictionary;
+}
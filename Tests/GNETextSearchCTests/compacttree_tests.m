@@ -0,0 +1,295 @@
+//
+//  compacttree_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <GNETextSearch/CompactTree.h>
+#import <GNETextSearch/TernaryTree.h>
+#import "CompactNode.h"
+#import "GNETextSearchPrivate.h"
+#import "GNETextSearchTestResources.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+typedef struct tsearch_ternarytree_node
+{
+    char character;
+    tsearch_ternarytree_ptr parent;
+    tsearch_ternarytree_ptr lower, same, higher;
+    tsearch_countedset_ptr documentIDs;
+} tsearch_ternarytree_node;
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNECompactTreeTests : XCTestCase
+{
+    tsearch_compacttree_ptr _treePtr;
+}
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNECompactTreeTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Up / Tear Down
+// ------------------------------------------------------------------------------------------
+- (void)setUp
+{
+    [super setUp];
+    _treePtr = tsearch_compacttree_init();
+}
+
+
+- (void)tearDown
+{
+    tsearch_compacttree_free(_treePtr);
+    _treePtr = NULL;
+    [super tearDown];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Search Tests
+// ------------------------------------------------------------------------------------------
+- (void)testSearch_NullAndEmptyTargets_NoCrashAndNoResults
+{
+    tsearch_compacttree_insert(_treePtr, "alpha", 1);
+
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_search_results(_treePtr, NULL));
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_search_results(_treePtr, ""));
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_prefix_search_results(_treePtr, NULL));
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_prefix_search_results(_treePtr, ""));
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_partial_search_results(_treePtr, "", 0));
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_suffix_search_results(_treePtr, "", 0));
+}
+
+
+- (void)testSearch_EmptyTree_NoResults
+{
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_search_results(_treePtr, "alpha"));
+    XCTAssertEqual(NULL, tsearch_compacttree_copy_prefix_search_results(_treePtr, "a"));
+    XCTAssertEqual(0, [self resultsInTree:_treePtr].count);
+}
+
+
+- (void)testSearch_TwelveWords_CanFindEachWord
+{
+    NSArray *words = @[@"as", @"at", @"be", @"by", @"he", @"in",
+                       @"is", @"it", @"of", @"on", @"or", @"to"];
+    [self insertWords:words intoTree:_treePtr];
+
+    for (NSString *word in words)
+    {
+        tsearch_countedset_ptr resultsPtr = tsearch_compacttree_copy_search_results(_treePtr, word.UTF8String);
+        XCTAssertEqual(1, tsearch_countedset_get_count(resultsPtr));
+        XCTAssertTrue(tsearch_countedset_contains_int(resultsPtr, (GNEInteger)word.hash));
+        tsearch_countedset_free(resultsPtr);
+    }
+    XCTAssertTrue(NULL == tsearch_compacttree_copy_search_results(_treePtr, "a"));
+    XCTAssertTrue(NULL == tsearch_compacttree_copy_search_results(_treePtr, "ax"));
+    XCTAssertEqualObjects([NSSet setWithArray:words], [NSSet setWithArray:[self resultsInTree:_treePtr]]);
+}
+
+
+- (void)testSearch_AllSearchKinds_MatchTernaryTree
+{
+    NSArray *words = @[@"anthony", @"awesome", @"awful", @"dammit", @"it", @"GNETextSearch",
+                       @"男人", @"ant", @"an", @"bang", @"dang", @"axbyc"];
+    tsearch_ternarytree_ptr ternaryTree = tsearch_ternarytree_init();
+    [words enumerateObjectsUsingBlock:^(NSString *word, NSUInteger idx, BOOL *stop) {
+        tsearch_compacttree_insert(_treePtr, word.UTF8String, (GNEInteger)idx % 3);
+        tsearch_ternarytree_insert(ternaryTree, word.UTF8String, (GNEInteger)idx % 3);
+    }];
+
+    for (NSString *target in @[@"a", @"an", @"aw", @"it", @"ETxc", @"男", @"abc", @"ng", @"z"])
+    {
+        const char *cTarget = target.UTF8String;
+        size_t length = strlen(cTarget);
+
+        [self assertCountedSet:tsearch_compacttree_copy_search_results(_treePtr, cTarget)
+                 isEqualToSet:tsearch_ternarytree_copy_search_results(ternaryTree, cTarget)];
+        [self assertCountedSet:tsearch_compacttree_copy_prefix_search_results(_treePtr, cTarget)
+                 isEqualToSet:tsearch_ternarytree_copy_prefix_search_results(ternaryTree, cTarget)];
+        [self assertCountedSet:tsearch_compacttree_copy_partial_search_results(_treePtr, cTarget, length)
+                 isEqualToSet:tsearch_ternarytree_copy_partial_search_results(ternaryTree, cTarget, length)];
+        [self assertCountedSet:tsearch_compacttree_copy_subsequence_search_results(_treePtr, cTarget, length)
+                 isEqualToSet:tsearch_ternarytree_copy_subsequence_search_results(ternaryTree, cTarget, length)];
+        [self assertCountedSet:tsearch_compacttree_copy_suffix_search_results(_treePtr, cTarget, length)
+                 isEqualToSet:tsearch_ternarytree_copy_suffix_search_results(ternaryTree, cTarget, length)];
+    }
+
+    tsearch_ternarytree_free(ternaryTree);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Remove Tests
+// ------------------------------------------------------------------------------------------
+- (void)testRemove_RemoveOneOfTwoDocuments_OtherDocumentRemains
+{
+    tsearch_compacttree_insert(_treePtr, "test", 1);
+    tsearch_compacttree_insert(_treePtr, "test", 2);
+    tsearch_compacttree_insert(_treePtr, "only", 1);
+
+    XCTAssertEqual(success, tsearch_compacttree_remove(_treePtr, 1));
+
+    tsearch_countedset_ptr resultsPtr = tsearch_compacttree_copy_search_results(_treePtr, "test");
+    XCTAssertEqual(1, tsearch_countedset_get_count(resultsPtr));
+    XCTAssertTrue(tsearch_countedset_contains_int(resultsPtr, 2));
+    tsearch_countedset_free(resultsPtr);
+
+    XCTAssertTrue(NULL == tsearch_compacttree_copy_search_results(_treePtr, "only"));
+    XCTAssertEqualObjects(@[@"test"], [self resultsInTree:_treePtr]);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Memory
+// ------------------------------------------------------------------------------------------
+- (void)testMemoryBible_CompactNodesUseLessMemoryPerNode
+{
+    [self insertBibleIntoTree:_treePtr];
+
+    // Both trees create the same nodes for the same insertion order, so the compact tree's node
+    // count is also the ternary tree's node count.
+    size_t nodeCount = tsearch_compacttree_get_node_count(_treePtr);
+    size_t ternaryBytes = nodeCount * sizeof(tsearch_ternarytree_node);
+    size_t compactBytes = nodeCount * sizeof(_tsearch_compact_node);
+
+    NSLog(@"Bible nodes: %zu, ternary tree: %zu bytes (%zu per node), compact tree: %zu bytes (%zu per node)",
+          nodeCount, ternaryBytes, sizeof(tsearch_ternarytree_node), compactBytes, sizeof(_tsearch_compact_node));
+
+    XCTAssertTrue(nodeCount > 0);
+    XCTAssertEqual(20, sizeof(_tsearch_compact_node));
+    XCTAssertTrue(compactBytes * 2 < ternaryBytes);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Performance
+// ------------------------------------------------------------------------------------------
+- (void)testInsertingBible
+{
+    NSDictionary *bible = GNETextSearchBibleDictionary();
+
+    [self measureBlock:^()
+    {
+        tsearch_compacttree_ptr tree = tsearch_compacttree_init();
+        [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
+            for (NSString *word in words) {
+                tsearch_compacttree_insert(tree, word.UTF8String, documentID.longLongValue);
+            }
+        }];
+        tsearch_compacttree_free(tree);
+    }];
+}
+
+
+- (void)testSearchBible_the
+{
+    [self insertBibleIntoTree:_treePtr];
+    __block tsearch_countedset_ptr results = NULL;
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_free(results);
+        results = tsearch_compacttree_copy_search_results(_treePtr, "the");
+    }];
+    XCTAssertTrue(tsearch_countedset_get_count(results) > 0);
+    tsearch_countedset_free(results);
+}
+
+
+- (void)testPrefixSearchBible_a
+{
+    [self insertBibleIntoTree:_treePtr];
+    __block tsearch_countedset_ptr results = NULL;
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_free(results);
+        results = tsearch_compacttree_copy_prefix_search_results(_treePtr, "a");
+    }];
+    XCTAssertTrue(tsearch_countedset_get_count(results) > 0);
+    tsearch_countedset_free(results);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Helpers
+// ------------------------------------------------------------------------------------------
+- (void)insertWords:(NSArray *)words intoTree:(tsearch_compacttree_ptr)treePtr
+{
+    for (NSString *word in words)
+    {
+        XCTAssertTrue(NULL != tsearch_compacttree_insert(treePtr, word.UTF8String, word.hash));
+    }
+}
+
+
+- (void)insertBibleIntoTree:(tsearch_compacttree_ptr)treePtr
+{
+    NSDictionary *bible = GNETextSearchBibleDictionary();
+    [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
+        for (NSString *word in words) {
+            tsearch_compacttree_insert(treePtr, word.UTF8String, documentID.longLongValue);
+        }
+    }];
+}
+
+
+- (void)assertCountedSet:(tsearch_countedset_ptr)countedSet isEqualToSet:(tsearch_countedset_ptr)expectedSet
+{
+    XCTAssertEqual(tsearch_countedset_get_count(expectedSet), tsearch_countedset_get_count(countedSet));
+
+    GNEInteger *integers = NULL;
+    size_t count = 0;
+    if (expectedSet != NULL)
+    {
+        XCTAssertEqual(success, tsearch_countedset_copy_ints(expectedSet, &integers, &count));
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        XCTAssertEqual(tsearch_countedset_get_count_for_int(expectedSet, integers[i]),
+                       tsearch_countedset_get_count_for_int(countedSet, integers[i]));
+    }
+
+    free(integers);
+    tsearch_countedset_free(countedSet);
+    tsearch_countedset_free(expectedSet);
+}
+
+
+- (NSArray *)resultsInTree:(tsearch_compacttree_ptr)ptr
+{
+    char *results = NULL;
+    size_t length = 0;
+    NSString *resultsStr = @"";
+
+    if (tsearch_compacttree_copy_contents(ptr, &results, &length) == success)
+    {
+        NSCharacterSet *characterSet = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+        resultsStr = [[NSString stringWithUTF8String:results] stringByTrimmingCharactersInSet:characterSet];
+    }
+
+    free(results);
+
+    return (resultsStr.length > 0) ? [resultsStr componentsSeparatedByString:@"\n"] : @[];
+}
+
+
+@end
@@ -8,6 +8,7 @@
 
 #import <XCTest/XCTest.h>
 #import <GNETextSearch/CountedSet.h>
+#import "CountedSetPrivate.h"
 #import "GNETextSearchPrivate.h"
 #import "GNETextSearchTestResources.h"
 
@@ -15,6 +16,25 @@
 // ------------------------------------------------------------------------------------------
 
 
+#ifdef TSEARCH_COUNTEDSET_COMPACT_NODES
+
+#define TSEARCH_COUNTEDSET_NO_INDEX ((size_t)UINT32_MAX)
+#define TSEARCH_COUNTEDSET_MAX_COUNT ((size_t)UINT32_MAX)
+
+typedef struct _tsearch_countedset_node
+{
+    GNEInteger integer;
+    uint32_t count;
+    uint32_t left;
+    uint32_t right;
+    int8_t balance;
+} _tsearch_countedset_node;
+
+#else
+
+#define TSEARCH_COUNTEDSET_NO_INDEX SIZE_MAX
+#define TSEARCH_COUNTEDSET_MAX_COUNT SIZE_MAX
+
 typedef struct _tsearch_countedset_node
 {
     GNEInteger integer;
@@ -24,6 +44,8 @@ typedef struct _tsearch_countedset_node
     size_t right;
 } _tsearch_countedset_node;
 
+#endif
+
 
 typedef struct tsearch_countedset
 {
@@ -31,9 +53,30 @@ typedef struct tsearch_countedset
     size_t count; // The number of nodes whose count > 0.
     size_t nodesCapacity;
     size_t insertIndex;
+    size_t freeIndex;
+    unsigned int compactionPercent;
 } tsearch_countedset;
 
 
+typedef struct _countedset_foreach_context
+{
+    GNEInteger integers[16];
+    size_t counts[16];
+    size_t count;
+    size_t maxCount;
+} _countedset_foreach_context;
+
+
+static bool _countedset_foreach_func(const GNEInteger integer, const size_t count, void *context)
+{
+    _countedset_foreach_context *foreachContext = (_countedset_foreach_context *)context;
+    foreachContext->integers[foreachContext->count] = integer;
+    foreachContext->counts[foreachContext->count] = count;
+    foreachContext->count += 1;
+    return foreachContext->count < foreachContext->maxCount;
+}
+
+
 // ------------------------------------------------------------------------------------------
 
 
@@ -81,6 +124,60 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testInitWithIntegers_NullOrEmpty_NullOrEmptySet
+{
+    XCTAssertTrue(NULL == tsearch_countedset_init_with_ints(NULL, 3));
+
+    tsearch_countedset_ptr countedSet = tsearch_countedset_init_with_ints(NULL, 0);
+    XCTAssertTrue(countedSet != NULL);
+    XCTAssertEqual(0, tsearch_countedset_get_count(countedSet));
+    XCTAssertEqual(success, tsearch_countedset_add_int(countedSet, 4));
+    XCTAssertEqual(1, tsearch_countedset_get_count(countedSet));
+    tsearch_countedset_free(countedSet);
+}
+
+
+- (void)testInitWithIntegers_NegativeExtremeAndRepeatedIntegers_CorrectCounts
+{
+    GNEInteger integers[] = { 3, INT64_MIN, -1, 3, INT64_MAX, 0, -1, 3, -256, 256 };
+    tsearch_countedset_ptr countedSet = tsearch_countedset_init_with_ints(integers, 10);
+
+    XCTAssertEqual(7, tsearch_countedset_get_count(countedSet));
+    XCTAssertEqual(3, tsearch_countedset_get_count_for_int(countedSet, 3));
+    XCTAssertEqual(2, tsearch_countedset_get_count_for_int(countedSet, -1));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(countedSet, INT64_MIN));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(countedSet, INT64_MAX));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(countedSet, -256));
+    XCTAssertEqual(0, tsearch_countedset_get_count_for_int(countedSet, 1));
+    [self p_assertIsBalancedCountedSet:countedSet];
+
+    GNEInteger expected[] = { INT64_MIN, -256, -1, 0, 3, 256, INT64_MAX };
+    tsearch_countedset_iterator iterator;
+    tsearch_countedset_iterator_init(&iterator, countedSet);
+    GNEInteger integer = 0;
+    for (size_t i = 0; i < 7; i++) {
+        XCTAssertTrue(tsearch_countedset_iterator_next(&iterator, &integer, NULL));
+        XCTAssertEqual(expected[i], integer);
+    }
+
+    tsearch_countedset_free(countedSet);
+}
+
+
+- (void)testInitWithIntegers_OneHundredThousandRandomIntegers_EqualToNSCountedSet
+{
+    NSArray *numbers = [self p_oneHundredThousandRandomIntegers_1];
+    GNEInteger *integers = [self p_copyIntegersFromNumbers:numbers];
+
+    tsearch_countedset_ptr countedSet = tsearch_countedset_init_with_ints(integers, (size_t)numbers.count);
+    [self p_assertGNECountedSet:countedSet isEqualToNSCountedSet:[self p_countedSetWithNumbers:numbers]];
+    [self p_assertIsBalancedCountedSet:countedSet];
+
+    tsearch_countedset_free(countedSet);
+    free(integers);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Copy
 // ------------------------------------------------------------------------------------------
@@ -307,6 +404,74 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testCopyIntegers_EqualCounts_AscendingIntegers
+{
+    GNEInteger integers[] = { 9, -4, 7, 7, 3, 100, -4, 2 };
+    [self p_addIntegers:integers count:8 toCountedSet:_countedSet];
+
+    GNEInteger *results = NULL;
+    size_t count = 0;
+    XCTAssertEqual(success, tsearch_countedset_copy_ints(_countedSet, &results, &count));
+
+    GNEInteger expected[] = { -4, 7, 2, 3, 9, 100 };
+    XCTAssertEqual(6, count);
+    for (size_t i = 0; i < 6; i++) { XCTAssertEqual(expected[i], results[i]); }
+    free(results);
+}
+
+
+- (void)testCopyTopIntegers_ZeroOrNull_SuccessWithNullArrayAndZeroCountOrFailure
+{
+    tsearch_countedset_add_int(_countedSet, 1);
+
+    GNEInteger *results = (GNEInteger *)1;
+    size_t count = 1;
+    XCTAssertEqual(success, tsearch_countedset_copy_top_ints(_countedSet, 0, &results, &count));
+    XCTAssertTrue(results == NULL);
+    XCTAssertEqual(0, count);
+
+    XCTAssertEqual(failure, tsearch_countedset_copy_top_ints(NULL, 20, &results, &count));
+    XCTAssertEqual(failure, tsearch_countedset_copy_top_ints(_countedSet, 20, NULL, &count));
+}
+
+
+- (void)testCopyTopIntegers_MoreThanCount_AllIntegersInCorrectOrder
+{
+    GNEInteger integers[] = { 5, 5, 5, 1, 1, 8, 2, 2 };
+    [self p_addIntegers:integers count:8 toCountedSet:_countedSet];
+
+    GNEInteger *results = NULL;
+    size_t count = 0;
+    XCTAssertEqual(success, tsearch_countedset_copy_top_ints(_countedSet, 20, &results, &count));
+
+    GNEInteger expected[] = { 5, 1, 2, 8 };
+    XCTAssertEqual(4, count);
+    for (size_t i = 0; i < 4; i++) { XCTAssertEqual(expected[i], results[i]); }
+    free(results);
+}
+
+
+- (void)testCopyTopIntegers_OneHundredThousandRandomIntegers_EqualToFirstIntegersOfCopyIntegers
+{
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+
+    GNEInteger *allResults = NULL;
+    size_t allCount = 0;
+    XCTAssertEqual(success, tsearch_countedset_copy_ints(_countedSet, &allResults, &allCount));
+
+    for (size_t maxCount = 1; maxCount <= 1000; maxCount *= 10) {
+        GNEInteger *results = NULL;
+        size_t count = 0;
+        XCTAssertEqual(success, tsearch_countedset_copy_top_ints(_countedSet, maxCount, &results, &count));
+        XCTAssertEqual(maxCount, count);
+        XCTAssertEqual(0, memcmp(allResults, results, count * sizeof(GNEInteger)));
+        free(results);
+    }
+
+    free(allResults);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Add/Contains/Count Integers
 // ------------------------------------------------------------------------------------------
@@ -393,10 +558,10 @@ typedef struct tsearch_countedset
 - (void)testAddInteger_ExistingIntegerCountOverflow_FailureAndUnchangedCount
 {
     XCTAssertEqual(success, tsearch_countedset_add_int(_countedSet, 10));
-    _countedSet->nodes[0].count = SIZE_MAX;
+    _countedSet->nodes[0].count = TSEARCH_COUNTEDSET_MAX_COUNT;
 
     XCTAssertEqual(failure, tsearch_countedset_add_int(_countedSet, 10));
-    XCTAssertEqual((size_t)SIZE_MAX, _countedSet->nodes[0].count);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_MAX_COUNT, (size_t)_countedSet->nodes[0].count);
     XCTAssertEqual((size_t)1, tsearch_countedset_get_count(_countedSet));
 }
 
@@ -415,12 +580,12 @@ typedef struct tsearch_countedset
     XCTAssertEqual(1, nodes[0].right);
 
     XCTAssertEqual(8, nodes[1].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[1].left);
-    XCTAssertEqual(SIZE_MAX, nodes[1].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].right);
 
     XCTAssertEqual(2, nodes[2].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[2].left);
-    XCTAssertEqual(SIZE_MAX, nodes[2].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].right);
 
     XCTAssertEqual(3, tsearch_countedset_get_count(_countedSet));
 
@@ -447,12 +612,12 @@ typedef struct tsearch_countedset
     XCTAssertEqual(1, nodes[0].right);
 
     XCTAssertEqual(8, nodes[1].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[1].left);
-    XCTAssertEqual(SIZE_MAX, nodes[1].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].right);
 
     XCTAssertEqual(2, nodes[2].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[2].left);
-    XCTAssertEqual(SIZE_MAX, nodes[2].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].right);
 
     XCTAssertEqual(3, tsearch_countedset_get_count(_countedSet));
 
@@ -479,12 +644,12 @@ typedef struct tsearch_countedset
     XCTAssertEqual(2, nodes[0].right);
 
     XCTAssertEqual(2, nodes[1].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[1].left);
-    XCTAssertEqual(SIZE_MAX, nodes[1].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].right);
 
     XCTAssertEqual(8, nodes[2].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[2].left);
-    XCTAssertEqual(SIZE_MAX, nodes[2].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].right);
 
     XCTAssertEqual(3, tsearch_countedset_get_count(_countedSet));
 
@@ -511,12 +676,12 @@ typedef struct tsearch_countedset
     XCTAssertEqual(2, nodes[0].right);
 
     XCTAssertEqual(2, nodes[1].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[1].left);
-    XCTAssertEqual(SIZE_MAX, nodes[1].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[1].right);
 
     XCTAssertEqual(8, nodes[2].integer);
-    XCTAssertEqual(SIZE_MAX, nodes[2].left);
-    XCTAssertEqual(SIZE_MAX, nodes[2].right);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].left);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, (size_t)nodes[2].right);
 
     XCTAssertEqual(3, tsearch_countedset_get_count(_countedSet));
 
@@ -634,6 +799,19 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testAddIntegers_AscendingAndRandomIntegers_Balanced
+{
+    for (GNEInteger integer = 0; integer < 5000; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_add_int(_countedSet, integer));
+    }
+    [self p_assertIsBalancedCountedSet:_countedSet];
+    XCTAssertEqual(13, _countedSet->nodes[0].balance);
+
+    [self p_addNumbers:[self p_randomNumberArrayWithCount:20000] toCountedSet:_countedSet];
+    [self p_assertIsBalancedCountedSet:_countedSet];
+}
+
+
 - (void)testAddIntegers_AddTenHundredThousandRandomIntegers_EqualToNSCountedSet
 {
     size_t count = 10000;
@@ -722,6 +900,110 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testRemove_HalfOfOneHundredIntegers_CompactedAndBalanced
+{
+    for (GNEInteger integer = 0; integer < 100; integer++) {
+        XCTAssertEqual(success, _tsearch_countedset_add_int(_countedSet, integer, (size_t)integer + 1));
+    }
+    for (GNEInteger integer = 0; integer < 50; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_remove_int(_countedSet, integer * 2));
+    }
+
+    XCTAssertEqual(50, _countedSet->count);
+    XCTAssertEqual(50, _countedSet->insertIndex);
+    XCTAssertEqual(50, tsearch_countedset_get_count(_countedSet));
+    XCTAssertEqual(0, tsearch_countedset_get_count_for_int(_countedSet, 98));
+    XCTAssertEqual(100, tsearch_countedset_get_count_for_int(_countedSet, 99));
+    [self p_assertIsBalancedCountedSet:_countedSet];
+}
+
+
+- (void)testRemove_ChurnWithoutCompaction_FreeNodesReusedAndHeightFollowsCount
+{
+    XCTAssertEqual(success, tsearch_countedset_set_compaction_percent(_countedSet, 0));
+    for (GNEInteger integer = 0; integer < 1000; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_add_int(_countedSet, integer));
+    }
+    for (GNEInteger integer = 0; integer < 990; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_remove_int(_countedSet, (integer * 7) % 1000));
+    }
+
+    // No more than 4 levels can hold the 10 integers left.
+    XCTAssertEqual(10, tsearch_countedset_get_count(_countedSet));
+    XCTAssertLessThanOrEqual(_countedSet->nodes[0].balance, 4);
+    [self p_assertIsBalancedCountedSet:_countedSet];
+
+    for (GNEInteger integer = 1000; integer < 1990; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_add_int(_countedSet, integer));
+    }
+    XCTAssertEqual(1000, tsearch_countedset_get_count(_countedSet));
+    XCTAssertEqual(1000, _countedSet->insertIndex);
+    XCTAssertEqual(TSEARCH_COUNTEDSET_NO_INDEX, _countedSet->freeIndex);
+    [self p_assertIsBalancedCountedSet:_countedSet];
+
+    for (GNEInteger integer = 0; integer < 1990; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_remove_int(_countedSet, integer));
+    }
+    XCTAssertEqual(0, tsearch_countedset_get_count(_countedSet));
+    XCTAssertEqual(0, _countedSet->insertIndex);
+}
+
+
+- (void)testCompact_CompactionPercentZero_OnlyCompactedOnRequest
+{
+    XCTAssertEqual(success, tsearch_countedset_set_compaction_percent(_countedSet, 0));
+    for (GNEInteger integer = 0; integer < 1000; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_add_int(_countedSet, integer));
+    }
+    for (GNEInteger integer = 0; integer < 990; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_remove_int(_countedSet, integer));
+    }
+    XCTAssertEqual(1000, _countedSet->insertIndex);
+
+    XCTAssertEqual(success, tsearch_countedset_compact(_countedSet));
+    XCTAssertEqual(10, _countedSet->insertIndex);
+    XCTAssertEqual(10, tsearch_countedset_get_count(_countedSet));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(_countedSet, 995));
+    XCTAssertEqual(0, tsearch_countedset_get_count_for_int(_countedSet, 989));
+    [self p_assertIsBalancedCountedSet:_countedSet];
+
+    // Merging swaps in a new tree, but the set keeps its compaction percentage.
+    GNEInteger integers[2000];
+    for (size_t i = 0; i < 2000; i++) { integers[i] = (GNEInteger)i + 2000; }
+    tsearch_countedset_ptr otherSet = tsearch_countedset_init_with_ints(integers, 2000);
+    XCTAssertEqual(success, tsearch_countedset_union(_countedSet, otherSet));
+    XCTAssertEqual(0, _countedSet->compactionPercent);
+    tsearch_countedset_free(otherSet);
+
+    size_t insertIndex = _countedSet->insertIndex;
+    for (size_t i = 0; i < 2000; i++) {
+        XCTAssertEqual(success, tsearch_countedset_remove_int(_countedSet, integers[i]));
+    }
+    XCTAssertEqual(insertIndex, _countedSet->insertIndex);
+    XCTAssertEqual(10, tsearch_countedset_get_count(_countedSet));
+
+    XCTAssertEqual(failure, tsearch_countedset_set_compaction_percent(_countedSet, 101));
+    XCTAssertEqual(failure, tsearch_countedset_compact(NULL));
+}
+
+
+- (void)testCompact_CompactionPercentTen_CompactedAfterTenthRemoval
+{
+    XCTAssertEqual(success, tsearch_countedset_set_compaction_percent(_countedSet, 10));
+    for (GNEInteger integer = 0; integer < 100; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_add_int(_countedSet, integer));
+    }
+    for (GNEInteger integer = 0; integer < 9; integer++) {
+        XCTAssertEqual(success, tsearch_countedset_remove_int(_countedSet, integer));
+    }
+    XCTAssertEqual(100, _countedSet->insertIndex);
+
+    XCTAssertEqual(success, tsearch_countedset_remove_int(_countedSet, 9));
+    XCTAssertEqual(90, _countedSet->insertIndex);
+    XCTAssertEqual(90, tsearch_countedset_get_count(_countedSet));
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Fuzz Operations
 // ------------------------------------------------------------------------------------------
@@ -1306,6 +1588,43 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testIntersectSet_SkewedSizesInBothOrders_SameIntegersWithSummedCounts
+{
+    NSArray *numbers = [self p_randomNumberArrayWithCount:20000];
+    NSArray *otherNumbers = [self p_randomNumberArrayWithCount:100];
+    NSCountedSet *nsCountedSet = [self p_countedSetWithNumbers:numbers];
+    NSCountedSet *otherNSCountedSet = [self p_countedSetWithNumbers:otherNumbers];
+
+    NSCountedSet *expected = [NSCountedSet set];
+    for (NSNumber *number in otherNSCountedSet) {
+        NSUInteger count = [nsCountedSet countForObject:number];
+        if (count == 0) { continue; }
+        count += [otherNSCountedSet countForObject:number];
+        for (NSUInteger i = 0; i < count; i++) { [expected addObject:number]; }
+    }
+
+    tsearch_countedset_ptr large = tsearch_countedset_init();
+    tsearch_countedset_ptr small = tsearch_countedset_init();
+    [self p_addNumbers:numbers toCountedSet:large];
+    [self p_addNumbers:otherNumbers toCountedSet:small];
+    tsearch_countedset_ptr smallCopy = tsearch_countedset_copy(small);
+
+    XCTAssertEqual(success, tsearch_countedset_intersect(large, small));
+    [self p_assertGNECountedSet:large isEqualToNSCountedSet:expected];
+    [self p_assertIsBalancedCountedSet:large];
+
+    tsearch_countedset_ptr otherLarge = tsearch_countedset_init();
+    [self p_addNumbers:numbers toCountedSet:otherLarge];
+    XCTAssertEqual(success, tsearch_countedset_intersect(smallCopy, otherLarge));
+    [self p_assertGNECountedSet:smallCopy isEqualToNSCountedSet:expected];
+
+    tsearch_countedset_free(large);
+    tsearch_countedset_free(small);
+    tsearch_countedset_free(smallCopy);
+    tsearch_countedset_free(otherLarge);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Minus Set
 // ------------------------------------------------------------------------------------------
@@ -1483,6 +1802,302 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testRemoveIntsInSet_RepeatedIntegers_RemovedRegardlessOfCounts
+{
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+
+    GNEInteger integers[] = { 23, 23, 23, 7834, 1, 24 };
+    GNEInteger otherIntegers[] = { 24, 23, 34780237 };
+    [self p_addIntegers:integers count:6 toCountedSet:_countedSet];
+    [self p_addIntegers:otherIntegers count:3 toCountedSet:otherCountedSet];
+
+    XCTAssertEqual(success, _tsearch_countedset_remove_ints_in_set(_countedSet, otherCountedSet));
+
+    XCTAssertEqual(2, _countedSet->count);
+    XCTAssertEqual(false, tsearch_countedset_contains_int(_countedSet, 23));
+    XCTAssertEqual(false, tsearch_countedset_contains_int(_countedSet, 24));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(_countedSet, 7834));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(_countedSet, 1));
+    XCTAssertEqual(3, otherCountedSet->count);
+
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
+- (void)testRemoveIntsInSet_LargerAndSmallerOtherSets_UniqueIntegersFromFirstSet
+{
+    NSArray *numbers = [self p_randomNumberArrayWithCount:1000];
+    NSArray *otherNumbersArrays = @[[self p_randomNumberArrayWithCount:50], [self p_randomNumberArrayWithCount:5000]];
+
+    for (NSArray *otherNumbers in otherNumbersArrays) {
+        tsearch_countedset_ptr gne1 = tsearch_countedset_init();
+        tsearch_countedset_ptr gne2 = tsearch_countedset_init();
+        [self p_addNumbers:numbers toCountedSet:gne1];
+        [self p_addNumbers:otherNumbers toCountedSet:gne2];
+
+        NSCountedSet *ns1 = [self p_countedSetWithNumbers:numbers];
+        for (NSNumber *number in otherNumbers) {
+            while ([ns1 countForObject:number] > 0) { [ns1 removeObject:number]; }
+        }
+
+        XCTAssertEqual(success, _tsearch_countedset_remove_ints_in_set(gne1, gne2));
+        [self p_assertGNECountedSet:gne1 isEqualToNSCountedSet:ns1];
+
+        tsearch_countedset_free(gne1);
+        tsearch_countedset_free(gne2);
+    }
+}
+
+
+- (void)testIterator_RandomIntegersWithSomeRemoved_AscendingIntegersWithCounts
+{
+    NSArray *numbers = [self p_randomNumberArrayWithCount:2000];
+    [self p_addNumbers:numbers toCountedSet:_countedSet];
+    NSCountedSet *nsCountedSet = [self p_countedSetWithNumbers:numbers];
+    for (NSNumber *number in [numbers subarrayWithRange:NSMakeRange(0, 500)]) {
+        tsearch_countedset_remove_int(_countedSet, number.longLongValue);
+        while ([nsCountedSet countForObject:number] > 0) { [nsCountedSet removeObject:number]; }
+    }
+
+    tsearch_countedset_iterator iterator;
+    XCTAssertEqual(success, tsearch_countedset_iterator_init(&iterator, _countedSet));
+
+    GNEInteger integer = 0;
+    size_t count = 0;
+    size_t visitedCount = 0;
+    GNEInteger previousInteger = -1;
+    while (tsearch_countedset_iterator_next(&iterator, &integer, &count)) {
+        XCTAssertGreaterThan(integer, previousInteger);
+        XCTAssertEqual([nsCountedSet countForObject:@(integer)], count);
+        previousInteger = integer;
+        visitedCount += 1;
+    }
+    XCTAssertEqual((size_t)nsCountedSet.count, visitedCount);
+    XCTAssertFalse(tsearch_countedset_iterator_next(&iterator, &integer, &count));
+}
+
+
+- (void)testIterator_EmptySet_NoIntegers
+{
+    tsearch_countedset_iterator iterator;
+    XCTAssertEqual(success, tsearch_countedset_iterator_init(&iterator, _countedSet));
+    XCTAssertFalse(tsearch_countedset_iterator_next(&iterator, NULL, NULL));
+    XCTAssertEqual(failure, tsearch_countedset_iterator_init(&iterator, NULL));
+}
+
+
+- (void)testForeach_FiveIntegersWithOneRemoved_AscendingIntegersWithCounts
+{
+    GNEInteger integers[] = { 8, -3, 8, 12, 0, 5, 8 };
+    [self p_addIntegers:integers count:7 toCountedSet:_countedSet];
+    tsearch_countedset_remove_int(_countedSet, 5);
+
+    _countedset_foreach_context context = { .maxCount = 16 };
+    XCTAssertEqual(success, tsearch_countedset_foreach(_countedSet, _countedset_foreach_func, &context));
+
+    GNEInteger expectedIntegers[] = { -3, 0, 8, 12 };
+    size_t expectedCounts[] = { 1, 1, 3, 1 };
+    XCTAssertEqual(4, context.count);
+    for (size_t i = 0; i < 4; i++) {
+        XCTAssertEqual(expectedIntegers[i], context.integers[i]);
+        XCTAssertEqual(expectedCounts[i], context.counts[i]);
+    }
+}
+
+
+- (void)testForeach_FunctionReturnsFalse_StopsEarly
+{
+    for (GNEInteger integer = 100; integer > 0; integer--) {
+        tsearch_countedset_add_int(_countedSet, integer);
+    }
+
+    _countedset_foreach_context context = { .maxCount = 3 };
+    XCTAssertEqual(success, tsearch_countedset_foreach(_countedSet, _countedset_foreach_func, &context));
+    XCTAssertEqual(3, context.count);
+    XCTAssertEqual(1, context.integers[0]);
+    XCTAssertEqual(3, context.integers[2]);
+}
+
+
+- (void)testForeach_NullSetOrFunction_Failure
+{
+    _countedset_foreach_context context = { .maxCount = 16 };
+    XCTAssertEqual(failure, tsearch_countedset_foreach(NULL, _countedset_foreach_func, &context));
+    XCTAssertEqual(failure, tsearch_countedset_foreach(_countedSet, NULL, &context));
+    XCTAssertEqual(success, tsearch_countedset_foreach(_countedSet, _countedset_foreach_func, &context));
+    XCTAssertEqual(0, context.count);
+}
+
+
+- (void)testIteratorSeek_EveryThirdInteger_NextIntegerNotLessThanTarget
+{
+    for (GNEInteger integer = 0; integer < 3000; integer += 3) {
+        tsearch_countedset_add_int(_countedSet, integer);
+    }
+    tsearch_countedset_remove_int(_countedSet, 1500);
+
+    tsearch_countedset_iterator iterator;
+    XCTAssertEqual(success, tsearch_countedset_iterator_init(&iterator, _countedSet));
+
+    GNEInteger integer = 0;
+    size_t count = 0;
+    XCTAssertTrue(_tsearch_countedset_iterator_seek(&iterator, -10, &integer, &count));
+    XCTAssertEqual(0, integer);
+    XCTAssertTrue(_tsearch_countedset_iterator_seek(&iterator, 100, &integer, &count));
+    XCTAssertEqual(102, integer);
+    XCTAssertTrue(tsearch_countedset_iterator_next(&iterator, &integer, &count));
+    XCTAssertEqual(105, integer);
+    XCTAssertTrue(_tsearch_countedset_iterator_seek(&iterator, 1499, &integer, &count));
+    XCTAssertEqual(1503, integer);
+    XCTAssertTrue(_tsearch_countedset_iterator_seek(&iterator, 1000, &integer, &count));
+    XCTAssertEqual(1506, integer);
+    XCTAssertTrue(_tsearch_countedset_iterator_seek(&iterator, 2997, &integer, &count));
+    XCTAssertEqual(2997, integer);
+    XCTAssertEqual(1, count);
+    XCTAssertFalse(_tsearch_countedset_iterator_seek(&iterator, 2998, &integer, &count));
+}
+
+
+- (void)testInitWithSortedInts_OneToOneThousand_BalancedAndContainsAll
+{
+    for (size_t count = 0; count <= 1000; count += 37) {
+        GNEInteger *integers = calloc(count + 1, sizeof(GNEInteger));
+        size_t *counts = calloc(count + 1, sizeof(size_t));
+        for (size_t i = 0; i < count; i++) {
+            integers[i] = (GNEInteger)(i * 2);
+            counts[i] = i + 1;
+        }
+
+        tsearch_countedset_ptr countedSet = _tsearch_countedset_init_with_sorted_ints(integers, counts, count);
+        XCTAssertEqual(count, tsearch_countedset_get_count(countedSet));
+        [self p_assertIsBalancedCountedSet:countedSet];
+        for (size_t i = 0; i < count; i++) {
+            XCTAssertEqual(i + 1, tsearch_countedset_get_count_for_int(countedSet, (GNEInteger)(i * 2)));
+            XCTAssertFalse(tsearch_countedset_contains_int(countedSet, (GNEInteger)(i * 2 + 1)));
+        }
+
+        XCTAssertEqual(success, tsearch_countedset_add_int(countedSet, -1));
+        XCTAssertEqual(count + 1, tsearch_countedset_get_count(countedSet));
+        [self p_assertIsBalancedCountedSet:countedSet];
+
+        tsearch_countedset_free(countedSet);
+        free(integers);
+        free(counts);
+    }
+}
+
+
+- (void)testInitWithUnionOfSets_DenseSparseAndNullSets_EqualToRepeatedUnions
+{
+    // The first sets share a small range of integers and the others are spread across all of them,
+    // so that both ways of merging the sets are used.
+    GNEInteger ranges[] = { 500, 0 };
+    for (size_t r = 0; r < sizeof(ranges) / sizeof(GNEInteger); r++) {
+        tsearch_countedset_ptr sets[20];
+        tsearch_countedset_ptr expected = tsearch_countedset_init();
+        for (size_t i = 0; i < 20; i++) {
+            if (i % 7 == 3) { sets[i] = NULL; continue; }
+
+            sets[i] = tsearch_countedset_init();
+            for (size_t j = 0; j < 200; j++) {
+                GNEInteger integer = (ranges[r] > 0) ? (GNEInteger)arc4random_uniform((uint32_t)ranges[r]) :
+                                                       (GNEInteger)(((uint64_t)arc4random() << 32) | arc4random());
+                XCTAssertEqual(success, _tsearch_countedset_add_int(sets[i], integer, 1 + j % 3));
+            }
+            for (GNEInteger integer = 0; integer < 50; integer++) {
+                XCTAssertEqual(success, tsearch_countedset_remove_int(sets[i], integer));
+            }
+            XCTAssertEqual(success, tsearch_countedset_union(expected, sets[i]));
+        }
+
+        tsearch_countedset_ptr unionSet = _tsearch_countedset_init_with_union_of_sets(sets, 20);
+        XCTAssertEqual(tsearch_countedset_get_count(expected), tsearch_countedset_get_count(unionSet));
+        [self p_assertIsBalancedCountedSet:unionSet];
+        tsearch_countedset_iterator iterator;
+        tsearch_countedset_iterator_init(&iterator, expected);
+        GNEInteger integer = 0;
+        size_t count = 0;
+        while (tsearch_countedset_iterator_next(&iterator, &integer, &count)) {
+            XCTAssertEqual(count, tsearch_countedset_get_count_for_int(unionSet, integer));
+        }
+
+        tsearch_countedset_free(unionSet);
+        tsearch_countedset_free(expected);
+        for (size_t i = 0; i < 20; i++) { tsearch_countedset_free(sets[i]); }
+    }
+
+    tsearch_countedset_ptr emptySet = _tsearch_countedset_init_with_union_of_sets(NULL, 0);
+    XCTAssertEqual((size_t)0, tsearch_countedset_get_count(emptySet));
+    tsearch_countedset_free(emptySet);
+    XCTAssertTrue(_tsearch_countedset_init_with_union_of_sets(NULL, 2) == NULL);
+}
+
+
+- (void)testInitWithUnionOfSets_CountOverflow_Null
+{
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+    XCTAssertEqual(success, _tsearch_countedset_add_int(_countedSet, 5, TSEARCH_COUNTEDSET_MAX_COUNT));
+    XCTAssertEqual(success, tsearch_countedset_add_int(otherCountedSet, 5));
+    tsearch_countedset_ptr sets[] = { _countedSet, otherCountedSet };
+    XCTAssertTrue(_tsearch_countedset_init_with_union_of_sets(sets, 2) == NULL);
+
+    // Spreading the integers out merges the sets without counting them in an array.
+    XCTAssertEqual(success, tsearch_countedset_add_int(_countedSet, INT64_MAX));
+    XCTAssertTrue(_tsearch_countedset_init_with_union_of_sets(sets, 2) == NULL);
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
+- (void)testSetOperations_OneHundredThousandRandomIntegers_MergedResultsAreBalancedWithExpectedCounts
+{
+    NSArray *numbers = [self p_oneHundredThousandRandomIntegers_1];
+    NSArray *otherNumbers = [self p_oneHundredThousandRandomIntegers_2];
+    NSCountedSet *nsCountedSet = [self p_countedSetWithNumbers:numbers];
+    NSCountedSet *otherNSCountedSet = [self p_countedSetWithNumbers:otherNumbers];
+
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+    [self p_addNumbers:numbers toCountedSet:_countedSet];
+    [self p_addNumbers:otherNumbers toCountedSet:otherCountedSet];
+
+    tsearch_countedset_ptr unionSet = tsearch_countedset_copy(_countedSet);
+    tsearch_countedset_ptr intersectSet = tsearch_countedset_copy(_countedSet);
+    tsearch_countedset_ptr minusSet = tsearch_countedset_copy(_countedSet);
+    XCTAssertEqual(success, tsearch_countedset_union(unionSet, otherCountedSet));
+    XCTAssertEqual(success, tsearch_countedset_intersect(intersectSet, otherCountedSet));
+    XCTAssertEqual(success, tsearch_countedset_minus(minusSet, otherCountedSet));
+
+    NSMutableSet *allNumbers = [NSMutableSet setWithArray:numbers];
+    [allNumbers addObjectsFromArray:otherNumbers];
+    size_t unionCount = 0, intersectCount = 0, minusCount = 0;
+    for (NSNumber *number in allNumbers) {
+        GNEInteger integer = number.longLongValue;
+        size_t count = [nsCountedSet countForObject:number];
+        size_t otherCount = [otherNSCountedSet countForObject:number];
+        size_t expectedIntersectCount = (count > 0 && otherCount > 0) ? count + otherCount : 0;
+        size_t expectedMinusCount = (count > otherCount) ? count - otherCount : 0;
+
+        XCTAssertEqual(count + otherCount, tsearch_countedset_get_count_for_int(unionSet, integer));
+        XCTAssertEqual(expectedIntersectCount, tsearch_countedset_get_count_for_int(intersectSet, integer));
+        XCTAssertEqual(expectedMinusCount, tsearch_countedset_get_count_for_int(minusSet, integer));
+        unionCount += 1;
+        intersectCount += (expectedIntersectCount > 0) ? 1 : 0;
+        minusCount += (expectedMinusCount > 0) ? 1 : 0;
+    }
+
+    XCTAssertEqual(unionCount, tsearch_countedset_get_count(unionSet));
+    XCTAssertEqual(intersectCount, tsearch_countedset_get_count(intersectSet));
+    XCTAssertEqual(minusCount, tsearch_countedset_get_count(minusSet));
+    [self p_assertIsBalancedCountedSet:unionSet];
+    [self p_assertIsBalancedCountedSet:intersectSet];
+    [self p_assertIsBalancedCountedSet:minusSet];
+
+    tsearch_countedset_free(unionSet);
+    tsearch_countedset_free(intersectSet);
+    tsearch_countedset_free(minusSet);
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Performance
 // ------------------------------------------------------------------------------------------
@@ -1499,6 +2114,26 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testPerformance_RemoveHalfOfOneHundredThousandIntegers
+{
+    NSArray *numbers = [self p_oneHundredThousandRandomIntegers_1];
+    GNEInteger *integers = [self p_copyIntegersFromNumbers:numbers];
+    tsearch_countedset_ptr countedSet = tsearch_countedset_init_with_ints(integers, numbers.count);
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_ptr copy = tsearch_countedset_copy(countedSet);
+        for (size_t i = 0; i < numbers.count; i += 2) {
+            tsearch_countedset_remove_int(copy, integers[i]);
+        }
+        tsearch_countedset_free(copy);
+    }];
+
+    tsearch_countedset_free(countedSet);
+    free(integers);
+}
+
+
 - (void)testNSPerformance_AddTenThousandIntegers__0_004
 {
     NSArray *numbers = [self p_tenThousandRandomIntegers_1];
@@ -1527,6 +2162,21 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testPerformance_InitWithOneHundredThousandIntegers
+{
+    NSArray *numbers = [self p_oneHundredThousandRandomIntegers_1];
+    GNEInteger *integers = [self p_copyIntegersFromNumbers:numbers];
+    size_t count = (size_t)numbers.count;
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_free(tsearch_countedset_init_with_ints(integers, count));
+    }];
+
+    free(integers);
+}
+
+
 - (void)testNSPerformance_AddOneHundredThousandIntegers__0_026
 {
     NSArray *numbers = [self p_oneHundredThousandRandomIntegers_1];
@@ -1589,9 +2239,168 @@ typedef struct tsearch_countedset
 }
 
 
+- (void)testPerformance_CopyTwentyTopIntegersFromOneHundredThousandIntegers
+{
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+
+    [self measureBlock:^()
+    {
+        GNEInteger *results = NULL;
+        size_t count = 0;
+        tsearch_countedset_copy_top_ints(_countedSet, 20, &results, &count);
+        free(results);
+    }];
+}
+
+
+- (void)testPerformance_CopyAllIntegersFromOneHundredThousandIntegers
+{
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+
+    [self measureBlock:^()
+    {
+        GNEInteger *results = NULL;
+        size_t count = 0;
+        tsearch_countedset_copy_ints(_countedSet, &results, &count);
+        free(results);
+    }];
+}
+
+
+- (void)testPerformance_UnionOneHundredThousandIntegers
+{
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_2] toCountedSet:otherCountedSet];
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_ptr countedSet = tsearch_countedset_copy(_countedSet);
+        tsearch_countedset_union(countedSet, otherCountedSet);
+        tsearch_countedset_free(countedSet);
+    }];
+
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
+- (void)testPerformance_UnionOneHundredThousandIntegersByAddingEachInteger
+{
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_2] toCountedSet:otherCountedSet];
+
+    // This is how tsearch_countedset_union() works when the other set is much smaller.
+    [self measureBlock:^()
+    {
+        tsearch_countedset_ptr countedSet = tsearch_countedset_copy(_countedSet);
+        for (size_t i = 0; i < otherCountedSet->insertIndex; i++) {
+            _tsearch_countedset_node node = otherCountedSet->nodes[i];
+            _tsearch_countedset_add_int(countedSet, node.integer, node.count);
+        }
+        tsearch_countedset_free(countedSet);
+    }];
+
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
+- (void)testPerformance_IntersectOneHundredThousandIntegers
+{
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_2] toCountedSet:otherCountedSet];
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_ptr countedSet = tsearch_countedset_copy(_countedSet);
+        tsearch_countedset_intersect(countedSet, otherCountedSet);
+        tsearch_countedset_free(countedSet);
+    }];
+
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
+- (void)testPerformance_IntersectOneHundredThousandIntegersWithOneHundredIntegers
+{
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+    NSArray *otherNumbers = [[self p_oneHundredThousandRandomIntegers_2] subarrayWithRange:NSMakeRange(0, 100)];
+    [self p_addNumbers:otherNumbers toCountedSet:otherCountedSet];
+
+    [self measureBlock:^()
+    {
+        for (NSUInteger i = 0; i < 100; i++) {
+            tsearch_countedset_ptr countedSet = tsearch_countedset_copy(otherCountedSet);
+            tsearch_countedset_intersect(countedSet, _countedSet);
+            tsearch_countedset_free(countedSet);
+        }
+    }];
+
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
+- (void)testPerformance_MinusOneHundredThousandIntegers
+{
+    tsearch_countedset_ptr otherCountedSet = tsearch_countedset_init();
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_1] toCountedSet:_countedSet];
+    [self p_addNumbers:[self p_oneHundredThousandRandomIntegers_2] toCountedSet:otherCountedSet];
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_ptr countedSet = tsearch_countedset_copy(_countedSet);
+        tsearch_countedset_minus(countedSet, otherCountedSet);
+        tsearch_countedset_free(countedSet);
+    }];
+
+    tsearch_countedset_free(otherCountedSet);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Helpers
 // ------------------------------------------------------------------------------------------
+- (void)p_assertIsBalancedCountedSet:(tsearch_countedset_ptr)countedSet
+{
+    if (countedSet->insertIndex == 0) { return; }
+
+    // Checks each node's height and balance after both of its subtrees have been checked.
+    size_t stack[TSEARCH_COUNTEDSET_MAX_HEIGHT * 2];
+    size_t stackCount = 0;
+    size_t nodeCount = 0;
+    int *heights = calloc(countedSet->insertIndex, sizeof(int));
+    bool *isExpanded = calloc(countedSet->insertIndex, sizeof(bool));
+    stack[stackCount++] = 0;
+    while (stackCount > 0) {
+        size_t index = stack[stackCount - 1];
+        _tsearch_countedset_node node = countedSet->nodes[index];
+        if (isExpanded[index] == false) {
+            isExpanded[index] = true;
+            if (node.left != TSEARCH_COUNTEDSET_NO_INDEX) { stack[stackCount++] = node.left; }
+            if (node.right != TSEARCH_COUNTEDSET_NO_INDEX) { stack[stackCount++] = node.right; }
+            continue;
+        }
+        stackCount -= 1;
+        nodeCount += 1;
+        XCTAssertGreaterThan(node.count, 0);
+
+        int leftHeight = (node.left == TSEARCH_COUNTEDSET_NO_INDEX) ? 0 : heights[node.left];
+        int rightHeight = (node.right == TSEARCH_COUNTEDSET_NO_INDEX) ? 0 : heights[node.right];
+        if (node.left != TSEARCH_COUNTEDSET_NO_INDEX) { XCTAssertLessThan(countedSet->nodes[node.left].integer, node.integer); }
+        if (node.right != TSEARCH_COUNTEDSET_NO_INDEX) { XCTAssertGreaterThan(countedSet->nodes[node.right].integer, node.integer); }
+        XCTAssertLessThanOrEqual(abs(leftHeight - rightHeight), 1);
+        heights[index] = MAX(leftHeight, rightHeight) + 1;
+        XCTAssertEqual(heights[index], node.balance);
+    }
+    XCTAssertEqual(countedSet->count, nodeCount);
+
+    free(heights);
+    free(isExpanded);
+}
+
+
 - (void)p_assertCountedSet:(tsearch_countedset_ptr)countedSet
           containsIntegers:(GNEInteger *)integers
                      count:(size_t)count
@@ -1653,6 +2462,18 @@ typedef struct tsearch_countedset
 }
 
 
+- (GNEInteger *)p_copyIntegersFromNumbers:(NSArray *)numberArray
+{
+    GNEInteger *integers = calloc((size_t)numberArray.count + 1, sizeof(GNEInteger));
+    [numberArray enumerateObjectsUsingBlock:^(NSNumber *number, NSUInteger idx, BOOL *stop)
+    {
+        integers[idx] = (GNEInteger)number.longLongValue;
+    }];
+
+    return integers;
+}
+
+
 - (NSCountedSet *)p_countedSetWithNumbers:(NSArray *)numberArray
 {
     NSCountedSet *countedSet = [NSCountedSet set];
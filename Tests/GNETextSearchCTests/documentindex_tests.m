@@ -0,0 +1,122 @@
+//
+//  documentindex_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "DocumentIndex.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNEDocumentIndexTests : XCTestCase
+{
+    _tsearch_documentindex *_index;
+}
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNEDocumentIndexTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Up / Tear Down
+// ------------------------------------------------------------------------------------------
+- (void)setUp
+{
+    [super setUp];
+    _index = _tsearch_documentindex_init();
+}
+
+
+- (void)tearDown
+{
+    _tsearch_documentindex_free(_index);
+    _index = NULL;
+    [super tearDown];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Tests
+// ------------------------------------------------------------------------------------------
+- (void)testInit_Empty
+{
+    XCTAssertTrue(_index != NULL);
+    XCTAssertEqual(0, _tsearch_documentindex_get_count(_index));
+
+    void **nodes = (void **)1;
+    size_t count = 1;
+    _tsearch_documentindex_take(_index, 1, &nodes, &count);
+    XCTAssertTrue(nodes == NULL);
+    XCTAssertEqual(0, count);
+}
+
+
+- (void)testAdd_NodesForTwoDocuments_TakeReturnsEachDocumentsNodesInOrder
+{
+    int values[5] = {0};
+    XCTAssertEqual(success, _tsearch_documentindex_add(_index, 1, &values[0]));
+    XCTAssertEqual(success, _tsearch_documentindex_add(_index, 2, &values[1]));
+    for (size_t i = 2; i < 5; i++) {
+        XCTAssertEqual(success, _tsearch_documentindex_add(_index, 1, &values[i]));
+    }
+    XCTAssertEqual(2, _tsearch_documentindex_get_count(_index));
+
+    void **nodes = NULL;
+    size_t count = 0;
+    _tsearch_documentindex_take(_index, 1, &nodes, &count);
+    XCTAssertEqual(4, count);
+    XCTAssertTrue(nodes[0] == &values[0]);
+    XCTAssertTrue(nodes[1] == &values[2]);
+    XCTAssertTrue(nodes[3] == &values[4]);
+    free(nodes);
+
+    XCTAssertEqual(1, _tsearch_documentindex_get_count(_index));
+    _tsearch_documentindex_take(_index, 1, &nodes, &count);
+    XCTAssertTrue(nodes == NULL);
+
+    _tsearch_documentindex_take(_index, 2, &nodes, &count);
+    XCTAssertEqual(1, count);
+    XCTAssertTrue(nodes[0] == &values[1]);
+    free(nodes);
+    XCTAssertEqual(0, _tsearch_documentindex_get_count(_index));
+}
+
+
+- (void)testAddAndTake_ManyDocuments_EveryRemainingDocumentIsFound
+{
+    int value = 0;
+    const GNEInteger documentCount = 10000;
+    for (GNEInteger documentID = 0; documentID < documentCount; documentID++) {
+        XCTAssertEqual(success, _tsearch_documentindex_add(_index, documentID * 4096 - 77, &value));
+    }
+    XCTAssertEqual((size_t)documentCount, _tsearch_documentindex_get_count(_index));
+
+    // Taking every other document shifts the slots of colliding documents.
+    void **nodes = NULL;
+    size_t count = 0;
+    for (GNEInteger documentID = 0; documentID < documentCount; documentID += 2) {
+        _tsearch_documentindex_take(_index, documentID * 4096 - 77, &nodes, &count);
+        XCTAssertEqual(1, count);
+        free(nodes);
+    }
+
+    for (GNEInteger documentID = 0; documentID < documentCount; documentID++) {
+        _tsearch_documentindex_take(_index, documentID * 4096 - 77, &nodes, &count);
+        XCTAssertEqual((documentID % 2 == 0) ? 0 : 1, count);
+        free(nodes);
+    }
+    XCTAssertEqual(0, _tsearch_documentindex_get_count(_index));
+}
+
+
+@end
@@ -0,0 +1,472 @@
+//
+//  frozentree_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <GNETextSearch/FrozenTree.h>
+#import <GNETextSearch/TernaryTree.h>
+#import "CompactNode.h"
+#import "GNETextSearchPrivate.h"
+#import "GNETextSearchTestResources.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNEFrozenTreeTests : XCTestCase
+{
+    tsearch_ternarytree_ptr _treePtr;
+}
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNEFrozenTreeTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Up / Tear Down
+// ------------------------------------------------------------------------------------------
+- (void)setUp
+{
+    [super setUp];
+    _treePtr = tsearch_ternarytree_init();
+}
+
+
+- (void)tearDown
+{
+    tsearch_ternarytree_free(_treePtr);
+    _treePtr = NULL;
+    [super tearDown];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Freeze Tests
+// ------------------------------------------------------------------------------------------
+- (void)testFreeze_NullTree_ReturnsNull
+{
+    XCTAssertTrue(NULL == tsearch_ternarytree_freeze(NULL));
+}
+
+
+- (void)testFreeze_EmptyTree_NoNodesAndNoResults
+{
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+    XCTAssertTrue(frozenPtr != NULL);
+    XCTAssertEqual(0, tsearch_frozentree_get_node_count(frozenPtr));
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_search_results(frozenPtr, "a"));
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_prefix_search_results(frozenPtr, "a"));
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_suffix_search_results(frozenPtr, "a", 1));
+    XCTAssertEqual(0, [self resultsInFrozenTree:frozenPtr].count);
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+- (void)testFreeze_AllDocumentsRemoved_NoResults
+{
+    tsearch_ternarytree_insert(_treePtr, "test", 1);
+    tsearch_ternarytree_insert(_treePtr, "testing", 1);
+    tsearch_ternarytree_remove(_treePtr, 1);
+
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+    XCTAssertTrue(frozenPtr != NULL);
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_prefix_search_results(frozenPtr, "t"));
+    XCTAssertEqual(0, [self resultsInFrozenTree:frozenPtr].count);
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+- (void)testFreeze_TreeChangesAfterFreezing_SnapshotIsUnchanged
+{
+    tsearch_ternarytree_insert(_treePtr, "snapshot", 1);
+    tsearch_ternarytree_insert(_treePtr, "snapshot", 1);
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+
+    tsearch_ternarytree_insert(_treePtr, "snapshot", 2);
+    tsearch_ternarytree_insert(_treePtr, "later", 2);
+    tsearch_ternarytree_remove(_treePtr, 1);
+
+    tsearch_countedset_ptr resultsPtr = tsearch_frozentree_copy_search_results(frozenPtr, "snapshot");
+    XCTAssertEqual(1, tsearch_countedset_get_count(resultsPtr));
+    XCTAssertEqual(2, tsearch_countedset_get_count_for_int(resultsPtr, 1));
+    XCTAssertFalse(tsearch_countedset_contains_int(resultsPtr, 2));
+    tsearch_countedset_free(resultsPtr);
+
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_search_results(frozenPtr, "later"));
+    XCTAssertEqualObjects(@[@"snapshot"], [self resultsInFrozenTree:frozenPtr]);
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+- (void)testFreeze_NodeCountMatchesTree
+{
+    NSArray *words = @[@"as", @"at", @"be", @"by", @"he", @"in", @"is", @"it", @"of", @"on", @"or", @"to"];
+    for (NSString *word in words) {
+        tsearch_ternarytree_insert(_treePtr, word.UTF8String, 1);
+    }
+
+    // 6 distinct first characters plus 12 second characters.
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+    XCTAssertEqual(18, tsearch_frozentree_get_node_count(frozenPtr));
+    XCTAssertEqualObjects(words, [self resultsInFrozenTree:frozenPtr]);
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Search Tests
+// ------------------------------------------------------------------------------------------
+- (void)testSearch_AllSearchKinds_MatchTernaryTree
+{
+    NSArray *words = @[@"anthony", @"awesome", @"awful", @"dammit", @"it", @"GNETextSearch",
+                       @"男人", @"ant", @"an", @"bang", @"dang", @"axbyc", @"ant", @"an"];
+    [words enumerateObjectsUsingBlock:^(NSString *word, NSUInteger idx, BOOL *stop) {
+        tsearch_ternarytree_insert(_treePtr, word.UTF8String, (GNEInteger)idx % 4 - 1);
+    }];
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+
+    for (NSString *target in @[@"a", @"an", @"ant", @"aw", @"it", @"ETxc", @"男", @"abc", @"ng", @"z"])
+    {
+        const char *cTarget = target.UTF8String;
+        size_t length = strlen(cTarget);
+
+        [self assertCountedSet:tsearch_frozentree_copy_search_results(frozenPtr, cTarget)
+                 isEqualToSet:tsearch_ternarytree_copy_search_results(_treePtr, cTarget)];
+        [self assertCountedSet:tsearch_frozentree_copy_prefix_search_results(frozenPtr, cTarget)
+                 isEqualToSet:tsearch_ternarytree_copy_prefix_search_results(_treePtr, cTarget)];
+        [self assertCountedSet:tsearch_frozentree_copy_partial_search_results(frozenPtr, cTarget, length)
+                 isEqualToSet:tsearch_ternarytree_copy_partial_search_results(_treePtr, cTarget, length)];
+        [self assertCountedSet:tsearch_frozentree_copy_subsequence_search_results(frozenPtr, cTarget, length)
+                 isEqualToSet:tsearch_ternarytree_copy_subsequence_search_results(_treePtr, cTarget, length)];
+        [self assertCountedSet:tsearch_frozentree_copy_suffix_search_results(frozenPtr, cTarget, length)
+                 isEqualToSet:tsearch_ternarytree_copy_suffix_search_results(_treePtr, cTarget, length)];
+    }
+
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+- (void)testSearchBible_FrozenResultsMatchTernaryTree
+{
+    [self insertBibleIntoTree:_treePtr];
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+
+    for (NSString *target in @[@"the", @"god", @"lord", @"jesus", @"abraham"])
+    {
+        const char *cTarget = target.UTF8String;
+        [self assertCountedSet:tsearch_frozentree_copy_search_results(frozenPtr, cTarget)
+                 isEqualToSet:tsearch_ternarytree_copy_search_results(_treePtr, cTarget)];
+        [self assertCountedSet:tsearch_frozentree_copy_prefix_search_results(frozenPtr, cTarget)
+                 isEqualToSet:tsearch_ternarytree_copy_prefix_search_results(_treePtr, cTarget)];
+    }
+
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - File Tests
+// ------------------------------------------------------------------------------------------
+- (void)testFile_WriteAndOpen_SearchResultsMatchTernaryTree
+{
+    NSArray *words = @[@"anthony", @"awesome", @"awful", @"dammit", @"it", @"男人", @"ant", @"an", @"ant"];
+    [words enumerateObjectsUsingBlock:^(NSString *word, NSUInteger idx, BOOL *stop) {
+        tsearch_ternarytree_insert(_treePtr, word.UTF8String, (GNEInteger)idx % 3);
+    }];
+    NSString *path = [self writeFrozenTreeForTree:_treePtr];
+
+    for (NSNumber *shouldVerify in @[@NO, @YES])
+    {
+        tsearch_frozentree_ptr filePtr = tsearch_frozentree_init_with_file(path.fileSystemRepresentation,
+                                                                           shouldVerify.boolValue);
+        XCTAssertTrue(filePtr != NULL);
+
+        for (NSString *target in @[@"a", @"an", @"ant", @"aw", @"it", @"男", @"z"])
+        {
+            const char *cTarget = target.UTF8String;
+            size_t length = strlen(cTarget);
+
+            [self assertCountedSet:tsearch_frozentree_copy_search_results(filePtr, cTarget)
+                     isEqualToSet:tsearch_ternarytree_copy_search_results(_treePtr, cTarget)];
+            [self assertCountedSet:tsearch_frozentree_copy_prefix_search_results(filePtr, cTarget)
+                     isEqualToSet:tsearch_ternarytree_copy_prefix_search_results(_treePtr, cTarget)];
+            [self assertCountedSet:tsearch_frozentree_copy_partial_search_results(filePtr, cTarget, length)
+                     isEqualToSet:tsearch_ternarytree_copy_partial_search_results(_treePtr, cTarget, length)];
+            [self assertCountedSet:tsearch_frozentree_copy_subsequence_search_results(filePtr, cTarget, length)
+                     isEqualToSet:tsearch_ternarytree_copy_subsequence_search_results(_treePtr, cTarget, length)];
+            [self assertCountedSet:tsearch_frozentree_copy_suffix_search_results(filePtr, cTarget, length)
+                     isEqualToSet:tsearch_ternarytree_copy_suffix_search_results(_treePtr, cTarget, length)];
+        }
+
+        tsearch_frozentree_free(filePtr);
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testFile_EmptyTree_CanBeWrittenAndOpened
+{
+    NSString *path = [self writeFrozenTreeForTree:_treePtr];
+
+    tsearch_frozentree_ptr filePtr = tsearch_frozentree_init_with_file(path.fileSystemRepresentation, true);
+    XCTAssertTrue(filePtr != NULL);
+    XCTAssertEqual(0, tsearch_frozentree_get_node_count(filePtr));
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_prefix_search_results(filePtr, "a"));
+    tsearch_frozentree_free(filePtr);
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testFile_MissingFile_ReturnsNull
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    XCTAssertTrue(NULL == tsearch_frozentree_init_with_file(path.fileSystemRepresentation, false));
+    XCTAssertTrue(NULL == tsearch_frozentree_init_with_file(NULL, false));
+}
+
+
+- (void)testFile_TruncatedFile_ReturnsNull
+{
+    tsearch_ternarytree_insert(_treePtr, "truncated", 1);
+    NSString *path = [self writeFrozenTreeForTree:_treePtr];
+    NSData *data = [NSData dataWithContentsOfFile:path];
+
+    for (NSUInteger length = 0; length < data.length; length++)
+    {
+        [[data subdataWithRange:NSMakeRange(0, length)] writeToFile:path atomically:YES];
+        XCTAssertTrue(NULL == tsearch_frozentree_init_with_file(path.fileSystemRepresentation, false));
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testFile_CorruptedFile_ReturnsNullWhenVerifyingChecksum
+{
+    tsearch_ternarytree_insert(_treePtr, "corrupted", 1);
+    tsearch_ternarytree_insert(_treePtr, "corrupt", 2);
+    NSString *path = [self writeFrozenTreeForTree:_treePtr];
+    NSData *data = [NSData dataWithContentsOfFile:path];
+
+    for (NSUInteger i = 0; i < data.length; i++)
+    {
+        NSMutableData *corrupted = [data mutableCopy];
+        ((unsigned char *)corrupted.mutableBytes)[i] ^= 0x5a;
+        [corrupted writeToFile:path atomically:YES];
+        XCTAssertTrue(NULL == tsearch_frozentree_init_with_file(path.fileSystemRepresentation, true));
+    }
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testFile_CyclicLinksWithoutVerifyingChecksum_SearchesIgnoreLinks
+{
+    tsearch_ternarytree_insert(_treePtr, "ab", 1);
+    NSString *path = [self writeFrozenTreeForTree:_treePtr];
+    NSMutableData *data = [[NSData dataWithContentsOfFile:path] mutableCopy];
+
+    // The nodes are at the end of the file. Both links point back up the tree.
+    _tsearch_compact_node *nodes = (_tsearch_compact_node *)((unsigned char *)data.mutableBytes + data.length -
+                                                             2 * sizeof(_tsearch_compact_node));
+    XCTAssertEqual('a', nodes[0].character);
+    XCTAssertEqual('b', nodes[1].character);
+    nodes[0].lower = 0;
+    nodes[1].same = 1;
+    nodes[1].higher = 0;
+    [data writeToFile:path atomically:YES];
+
+    tsearch_frozentree_ptr filePtr = tsearch_frozentree_init_with_file(path.fileSystemRepresentation, false);
+    XCTAssertTrue(filePtr != NULL);
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_search_results(filePtr, "a"));
+    XCTAssertTrue(NULL == tsearch_frozentree_copy_search_results(filePtr, "abb"));
+
+    tsearch_countedset_ptr results[] = {
+        tsearch_frozentree_copy_search_results(filePtr, "ab"),
+        tsearch_frozentree_copy_prefix_search_results(filePtr, "a"),
+        tsearch_frozentree_copy_partial_search_results(filePtr, "b", 1),
+        tsearch_frozentree_copy_subsequence_search_results(filePtr, "ab", 2),
+        tsearch_frozentree_copy_suffix_search_results(filePtr, "b", 1),
+    };
+    for (size_t i = 0; i < sizeof(results) / sizeof(results[0]); i++)
+    {
+        XCTAssertEqual(1, tsearch_countedset_get_count(results[i]));
+        XCTAssertTrue(tsearch_countedset_contains_int(results[i], 1));
+        tsearch_countedset_free(results[i]);
+    }
+
+    char *contents = NULL;
+    size_t length = 0;
+    XCTAssertEqual(success, tsearch_frozentree_copy_contents(filePtr, &contents, &length));
+    XCTAssertEqualObjects(@"ab\n", [NSString stringWithUTF8String:contents]);
+    free(contents);
+
+    tsearch_frozentree_free(filePtr);
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testFile_UnsupportedVersion_ReturnsNull
+{
+    NSString *path = [self writeFrozenTreeForTree:_treePtr];
+    NSMutableData *data = [[NSData dataWithContentsOfFile:path] mutableCopy];
+
+    // The version follows the 8-byte magic number.
+    uint32_t version = 2;
+    [data replaceBytesInRange:NSMakeRange(8, sizeof(version)) withBytes:&version];
+    [data writeToFile:path atomically:YES];
+    XCTAssertTrue(NULL == tsearch_frozentree_init_with_file(path.fileSystemRepresentation, false));
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Performance
+// ------------------------------------------------------------------------------------------
+- (void)testFreezingBible
+{
+    [self insertBibleIntoTree:_treePtr];
+
+    [self measureBlock:^()
+    {
+        tsearch_frozentree_free(tsearch_ternarytree_freeze(_treePtr));
+    }];
+}
+
+
+- (void)testOpeningBibleFile
+{
+    [self insertBibleIntoTree:_treePtr];
+    NSString *path = [self writeFrozenTreeForTree:_treePtr];
+
+    [self measureBlock:^()
+    {
+        tsearch_frozentree_free(tsearch_frozentree_init_with_file(path.fileSystemRepresentation, false));
+    }];
+
+    [[NSFileManager defaultManager] removeItemAtPath:path error:nil];
+}
+
+
+- (void)testSearchBible_the
+{
+    [self insertBibleIntoTree:_treePtr];
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+
+    [self measureBlock:^()
+    {
+        for (size_t i = 0; i < 100; i++) {
+            tsearch_countedset_free(tsearch_frozentree_copy_search_results(frozenPtr, "the"));
+        }
+    }];
+
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+- (void)testPrefixSearchBible_a
+{
+    [self insertBibleIntoTree:_treePtr];
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_free(tsearch_frozentree_copy_prefix_search_results(frozenPtr, "a"));
+    }];
+
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+- (void)testSuffixSearchBible_ing
+{
+    [self insertBibleIntoTree:_treePtr];
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(_treePtr);
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_free(tsearch_frozentree_copy_suffix_search_results(frozenPtr, "ing", 3));
+    }];
+
+    tsearch_frozentree_free(frozenPtr);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Helpers
+// ------------------------------------------------------------------------------------------
+- (void)insertBibleIntoTree:(tsearch_ternarytree_ptr)treePtr
+{
+    NSDictionary *bible = GNETextSearchBibleDictionary();
+    [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
+        for (NSString *word in words) {
+            tsearch_ternarytree_insert(treePtr, word.UTF8String, documentID.longLongValue);
+        }
+    }];
+}
+
+
+- (NSString *)writeFrozenTreeForTree:(tsearch_ternarytree_ptr)treePtr
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    tsearch_frozentree_ptr frozenPtr = tsearch_ternarytree_freeze(treePtr);
+    XCTAssertEqual(success, tsearch_frozentree_write_file(frozenPtr, path.fileSystemRepresentation));
+    tsearch_frozentree_free(frozenPtr);
+    return path;
+}
+
+
+- (void)assertCountedSet:(tsearch_countedset_ptr)countedSet isEqualToSet:(tsearch_countedset_ptr)expectedSet
+{
+    XCTAssertEqual(tsearch_countedset_get_count(expectedSet), tsearch_countedset_get_count(countedSet));
+
+    GNEInteger *integers = NULL;
+    size_t count = 0;
+    if (expectedSet != NULL)
+    {
+        XCTAssertEqual(success, tsearch_countedset_copy_ints(expectedSet, &integers, &count));
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        XCTAssertEqual(tsearch_countedset_get_count_for_int(expectedSet, integers[i]),
+                       tsearch_countedset_get_count_for_int(countedSet, integers[i]));
+    }
+
+    free(integers);
+    tsearch_countedset_free(countedSet);
+    tsearch_countedset_free(expectedSet);
+}
+
+
+- (NSArray *)resultsInFrozenTree:(tsearch_frozentree_ptr)ptr
+{
+    char *results = NULL;
+    size_t length = 0;
+    NSString *resultsStr = @"";
+
+    if (tsearch_frozentree_copy_contents(ptr, &results, &length) == success)
+    {
+        NSCharacterSet *characterSet = [NSCharacterSet whitespaceAndNewlineCharacterSet];
+        resultsStr = [[NSString stringWithUTF8String:results] stringByTrimmingCharactersInSet:characterSet];
+    }
+
+    free(results);
+
+    return (resultsStr.length > 0) ? [resultsStr componentsSeparatedByString:@"\n"] : @[];
+}
+
+
+@end
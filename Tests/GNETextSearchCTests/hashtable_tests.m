@@ -0,0 +1,164 @@
+//
+//  hashtable_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "HashTable.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+typedef struct test_slot
+{
+    uint64_t key;
+    uint64_t value; // 0 for empty slots.
+} test_slot;
+
+
+static size_t test_slot_hash_key(const uint64_t key, const bool shouldCollide)
+{
+    // Colliding keys share their low bits, so they all probe from the same home slot.
+    return (shouldCollide == true) ? (size_t)(key << 20) : _tsearch_hashtable_mix(key);
+}
+
+
+static size_t test_slot_hash(const void *slot)
+{
+    return test_slot_hash_key(((const test_slot *)slot)->key, false);
+}
+
+
+static size_t test_slot_colliding_hash(const void *slot)
+{
+    return test_slot_hash_key(((const test_slot *)slot)->key, true);
+}
+
+
+static bool test_slot_is_empty(const void *slot)
+{
+    return (((const test_slot *)slot)->value == 0) ? true : false;
+}
+
+
+static bool test_slot_has_key(const void *slot, const void *key)
+{
+    return (((const test_slot *)slot)->key == *(const uint64_t *)key) ? true : false;
+}
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNEHashTableTests : XCTestCase
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNEHashTableTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Tests
+// ------------------------------------------------------------------------------------------
+- (void)testInit_Empty
+{
+    _tsearch_hashtable table;
+    XCTAssertEqual(success, _tsearch_hashtable_init(&table, sizeof(test_slot), test_slot_hash,
+                                                    test_slot_is_empty, test_slot_has_key));
+    XCTAssertEqual(0, table.count);
+    XCTAssertEqual(table.capacity * sizeof(test_slot), _tsearch_hashtable_get_byte_length(&table));
+    XCTAssertEqual(0, _tsearch_hashtable_get_growth_byte_length(&table));
+
+    uint64_t key = 7;
+    test_slot *slot = _tsearch_hashtable_get_slot(&table, _tsearch_hashtable_find(&table, &key, 7));
+    XCTAssertTrue(test_slot_is_empty(slot));
+    _tsearch_hashtable_free(&table);
+}
+
+
+- (void)testAddAndRemove_ManyKeys_RemainingKeysFound
+{
+    [self p_addAndRemoveKeysWithHash:test_slot_hash shouldCollide:false];
+}
+
+
+- (void)testAddAndRemove_CollidingKeys_RemainingKeysFound
+{
+    [self p_addAndRemoveKeysWithHash:test_slot_colliding_hash shouldCollide:true];
+}
+
+
+- (void)testRemoveAll_ManyKeys_EmptyWithSameCapacity
+{
+    _tsearch_hashtable table;
+    XCTAssertEqual(success, _tsearch_hashtable_init(&table, sizeof(test_slot), test_slot_hash,
+                                                    test_slot_is_empty, test_slot_has_key));
+    for (uint64_t key = 1; key <= 100; key++) {
+        void *slot = NULL;
+        XCTAssertEqual(success, _tsearch_hashtable_add(&table, test_slot_hash_key(key, false), &slot));
+        *(test_slot *)slot = (test_slot){key, key};
+    }
+
+    size_t capacity = table.capacity;
+    _tsearch_hashtable_remove_all(&table);
+    XCTAssertEqual(0, table.count);
+    XCTAssertEqual(capacity, table.capacity);
+
+    uint64_t key = 50;
+    test_slot *slot = _tsearch_hashtable_get_slot(&table, _tsearch_hashtable_find(&table, &key,
+                                                                                  test_slot_hash_key(key, false)));
+    XCTAssertTrue(test_slot_is_empty(slot));
+    _tsearch_hashtable_free(&table);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Helpers
+// ------------------------------------------------------------------------------------------
+- (void)p_addAndRemoveKeysWithHash:(_tsearch_hashtable_hash_func)hash shouldCollide:(bool)shouldCollide
+{
+    _tsearch_hashtable table;
+    XCTAssertEqual(success, _tsearch_hashtable_init(&table, sizeof(test_slot), hash,
+                                                    test_slot_is_empty, test_slot_has_key));
+
+    const uint64_t keyCount = 1000;
+    for (uint64_t key = 1; key <= keyCount; key++) {
+        void *slot = NULL;
+        XCTAssertEqual(success, _tsearch_hashtable_add(&table, test_slot_hash_key(key, shouldCollide), &slot));
+        *(test_slot *)slot = (test_slot){key, key * 2};
+    }
+    XCTAssertEqual(keyCount, table.count);
+    XCTAssertTrue(table.count <= (table.capacity / 4) * 3);
+
+    // Removing every third key shifts the keys after it back into their probe sequences.
+    for (uint64_t key = 3; key <= keyCount; key += 3) {
+        size_t slotIndex = _tsearch_hashtable_find(&table, &key, test_slot_hash_key(key, shouldCollide));
+        XCTAssertFalse(test_slot_is_empty(_tsearch_hashtable_get_slot(&table, slotIndex)));
+        _tsearch_hashtable_remove(&table, slotIndex);
+    }
+    XCTAssertEqual(keyCount - keyCount / 3, table.count);
+
+    for (uint64_t key = 1; key <= keyCount; key++) {
+        size_t slotIndex = _tsearch_hashtable_find(&table, &key, test_slot_hash_key(key, shouldCollide));
+        test_slot *slot = _tsearch_hashtable_get_slot(&table, slotIndex);
+        if (key % 3 == 0) {
+            XCTAssertTrue(test_slot_is_empty(slot));
+        } else {
+            XCTAssertEqual(key, slot->key);
+            XCTAssertEqual(key * 2, slot->value);
+        }
+    }
+
+    _tsearch_hashtable_free(&table);
+}
+
+
+@end
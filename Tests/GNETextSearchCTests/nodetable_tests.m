@@ -0,0 +1,102 @@
+//
+//  nodetable_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "NodeTable.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNENodeTableTests : XCTestCase
+{
+    _tsearch_hashtable _table;
+}
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNENodeTableTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Up / Tear Down
+// ------------------------------------------------------------------------------------------
+- (void)setUp
+{
+    [super setUp];
+    XCTAssertEqual(success, _tsearch_nodetable_init(&_table));
+}
+
+
+- (void)tearDown
+{
+    _tsearch_nodetable_free(&_table);
+    [super tearDown];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Tests
+// ------------------------------------------------------------------------------------------
+- (void)testFind_EmptyTable_EmptySlot
+{
+    size_t slotIndex = 0;
+    _tsearch_nodetable_slot *slot = _tsearch_nodetable_find(&_table, 7, &slotIndex);
+    XCTAssertTrue(slot->nodes == NULL);
+    XCTAssertEqual(0, _table.count);
+}
+
+
+- (void)testAdd_ManyKeys_EachSlotHoldsItsNode
+{
+    const size_t keyCount = 1000;
+    char *nodes = calloc(keyCount, sizeof(char));
+    for (size_t i = 0; i < keyCount; i++) {
+        XCTAssertEqual(success, _tsearch_nodetable_add(&_table, i, &nodes[i]));
+    }
+    XCTAssertEqual(keyCount, _table.count);
+
+    for (size_t i = 0; i < keyCount; i++) {
+        size_t slotIndex = 0;
+        _tsearch_nodetable_slot *slot = _tsearch_nodetable_find(&_table, i, &slotIndex);
+        XCTAssertEqual(i, slot->key);
+        XCTAssertEqual(1, slot->count);
+        XCTAssertTrue(slot->nodes[0] == &nodes[i]);
+    }
+    free(nodes);
+}
+
+
+- (void)testSlotInsert_NodesAtEachEnd_NodesInPositionOrder
+{
+    int values[10] = {0};
+    XCTAssertEqual(success, _tsearch_nodetable_add(&_table, 3, &values[5]));
+
+    size_t slotIndex = 0;
+    _tsearch_nodetable_slot *slot = _tsearch_nodetable_find(&_table, 3, &slotIndex);
+    for (size_t i = 6; i < 10; i++) {
+        XCTAssertEqual(success, _tsearch_nodetable_slot_insert(slot, slot->count, &values[i]));
+    }
+    for (size_t i = 5; i > 0; i--) {
+        XCTAssertEqual(success, _tsearch_nodetable_slot_insert(slot, 0, &values[i - 1]));
+    }
+    XCTAssertEqual(failure, _tsearch_nodetable_slot_insert(slot, slot->count + 1, &values[0]));
+
+    XCTAssertEqual(10, slot->count);
+    XCTAssertTrue(slot->capacity >= slot->count);
+    for (size_t i = 0; i < 10; i++) {
+        XCTAssertTrue(slot->nodes[i] == &values[i]);
+    }
+}
+
+
+@end
@@ -0,0 +1,267 @@
+//
+//  postinglist_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import <GNETextSearch/PostingList.h>
+#import "GNETextSearchPrivate.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNEPostingListTests : XCTestCase
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNEPostingListTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Initialization
+// ------------------------------------------------------------------------------------------
+- (void)testInitWithInts_EmptyList_NoIntegers
+{
+    for (NSNumber *shouldCompress in @[@NO, @YES]) {
+        tsearch_postinglist_ptr list = tsearch_postinglist_init_with_ints(NULL, NULL, 0, shouldCompress.boolValue);
+        XCTAssertTrue(list != NULL);
+        XCTAssertEqual(0, tsearch_postinglist_get_count(list));
+        XCTAssertEqual(0, tsearch_postinglist_get_byte_length(list));
+        XCTAssertFalse(tsearch_postinglist_contains_int(list, 0));
+        tsearch_postinglist_free(list);
+    }
+}
+
+
+- (void)testInitWithInts_UnsortedOrZeroCounts_ReturnsNULL
+{
+    GNEInteger unsorted[] = { 1, 5, 3 };
+    GNEInteger repeated[] = { 1, 5, 5 };
+    GNEInteger sorted[] = { 1, 5, 7 };
+    size_t zeroCounts[] = { 1, 0, 1 };
+
+    XCTAssertTrue(NULL == tsearch_postinglist_init_with_ints(unsorted, NULL, 3, false));
+    XCTAssertTrue(NULL == tsearch_postinglist_init_with_ints(repeated, NULL, 3, true));
+    XCTAssertTrue(NULL == tsearch_postinglist_init_with_ints(sorted, zeroCounts, 3, false));
+    XCTAssertTrue(NULL == tsearch_postinglist_init_with_ints(NULL, NULL, 3, false));
+}
+
+
+- (void)testInitWithInts_NegativeAndExtremeIntegers_CanFindAll
+{
+    GNEInteger integers[] = { INT64_MIN, -500, -1, 0, 1, 300, INT64_MAX };
+    size_t counts[] = { 1, 2, 3, 4, 5, 6, SIZE_MAX };
+
+    for (NSNumber *shouldCompress in @[@NO, @YES]) {
+        tsearch_postinglist_ptr list = tsearch_postinglist_init_with_ints(integers, counts, 7, shouldCompress.boolValue);
+        XCTAssertEqual(shouldCompress.boolValue, tsearch_postinglist_is_compressed(list));
+        XCTAssertEqual(7, tsearch_postinglist_get_count(list));
+        for (size_t i = 0; i < 7; i++) {
+            XCTAssertTrue(tsearch_postinglist_contains_int(list, integers[i]));
+            XCTAssertEqual(counts[i], tsearch_postinglist_get_count_for_int(list, integers[i]));
+        }
+        XCTAssertFalse(tsearch_postinglist_contains_int(list, 2));
+        XCTAssertEqual(0, tsearch_postinglist_get_count_for_int(list, -2));
+        tsearch_postinglist_free(list);
+    }
+}
+
+
+- (void)testInitWithCountedSet_RandomIntegers_EqualToCountedSet
+{
+    tsearch_countedset_ptr set = tsearch_countedset_init();
+    for (NSNumber *number in [self p_randomNumberArrayWithCount:5000]) {
+        tsearch_countedset_add_int(set, number.longLongValue);
+    }
+
+    for (NSNumber *shouldCompress in @[@NO, @YES]) {
+        tsearch_postinglist_ptr list = tsearch_postinglist_init_with_countedset(set, shouldCompress.boolValue);
+        [self p_assertPostingList:list isEqualToCountedSet:set];
+        tsearch_postinglist_free(list);
+    }
+
+    tsearch_countedset_free(set);
+}
+
+
+- (void)testCopyInts_CompressedList_AscendingIntegersAndCounts
+{
+    GNEInteger integers[200];
+    size_t counts[200];
+    for (size_t i = 0; i < 200; i++) {
+        integers[i] = (GNEInteger)(i * i) - 1000;
+        counts[i] = (i % 3) + 1;
+    }
+
+    tsearch_postinglist_ptr list = tsearch_postinglist_init_with_ints(integers, counts, 200, true);
+    GNEInteger *outIntegers = NULL;
+    size_t *outCounts = NULL;
+    size_t outCount = 0;
+    XCTAssertEqual(success, tsearch_postinglist_copy_ints(list, &outIntegers, &outCounts, &outCount));
+    XCTAssertEqual(200, outCount);
+    XCTAssertEqual(0, memcmp(integers, outIntegers, sizeof(integers)));
+    XCTAssertEqual(0, memcmp(counts, outCounts, sizeof(counts)));
+
+    free(outIntegers);
+    free(outCounts);
+    tsearch_postinglist_free(list);
+}
+
+
+- (void)testByteLength_DenseIntegers_CompressedListIsAtLeastFiveTimesSmaller
+{
+    GNEInteger integers[10000];
+    for (size_t i = 0; i < 10000; i++) { integers[i] = (GNEInteger)(i * 3); }
+
+    tsearch_postinglist_ptr list = tsearch_postinglist_init_with_ints(integers, NULL, 10000, false);
+    tsearch_postinglist_ptr compressedList = tsearch_postinglist_init_with_ints(integers, NULL, 10000, true);
+
+    XCTAssertEqual(10000 * (sizeof(GNEInteger) + sizeof(size_t)), tsearch_postinglist_get_byte_length(list));
+    XCTAssertLessThan(tsearch_postinglist_get_byte_length(compressedList) * 5, tsearch_postinglist_get_byte_length(list));
+
+    tsearch_postinglist_free(list);
+    tsearch_postinglist_free(compressedList);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Operations
+// ------------------------------------------------------------------------------------------
+- (void)testSetOperations_RandomLists_EqualToCountedSetOperations
+{
+    for (NSUInteger i = 0; i < 4; i++) {
+        BOOL shouldCompress = (i & 1) ? YES : NO;
+        BOOL shouldCompressOther = (i & 2) ? YES : NO;
+
+        tsearch_countedset_ptr set = tsearch_countedset_init();
+        tsearch_countedset_ptr otherSet = tsearch_countedset_init();
+        for (NSNumber *number in [self p_randomNumberArrayWithCount:3000]) {
+            tsearch_countedset_add_int(set, number.longLongValue);
+        }
+        for (NSNumber *number in [self p_randomNumberArrayWithCount:2000]) {
+            tsearch_countedset_add_int(otherSet, number.longLongValue);
+        }
+
+        tsearch_postinglist_ptr list = tsearch_postinglist_init_with_countedset(set, shouldCompress);
+        tsearch_postinglist_ptr otherList = tsearch_postinglist_init_with_countedset(otherSet, shouldCompressOther);
+
+        tsearch_countedset_ptr expected = tsearch_countedset_copy(set);
+        tsearch_countedset_union(expected, otherSet);
+        tsearch_postinglist_ptr results = tsearch_postinglist_copy_union(list, otherList);
+        XCTAssertEqual(shouldCompress, tsearch_postinglist_is_compressed(results));
+        [self p_assertPostingList:results isEqualToCountedSet:expected];
+        tsearch_postinglist_free(results);
+        tsearch_countedset_free(expected);
+
+        expected = tsearch_countedset_copy(set);
+        tsearch_countedset_intersect(expected, otherSet);
+        results = tsearch_postinglist_copy_intersection(list, otherList);
+        [self p_assertPostingList:results isEqualToCountedSet:expected];
+        tsearch_postinglist_free(results);
+        tsearch_countedset_free(expected);
+
+        expected = tsearch_countedset_copy(set);
+        tsearch_countedset_minus(expected, otherSet);
+        results = tsearch_postinglist_copy_minus(list, otherList);
+        [self p_assertPostingList:results isEqualToCountedSet:expected];
+        tsearch_postinglist_free(results);
+        tsearch_countedset_free(expected);
+
+        tsearch_postinglist_free(list);
+        tsearch_postinglist_free(otherList);
+        tsearch_countedset_free(set);
+        tsearch_countedset_free(otherSet);
+    }
+}
+
+
+- (void)testSetOperations_EmptyList_UnionEqualsOtherListAndIntersectionIsEmpty
+{
+    GNEInteger integers[] = { 3, 4, 5 };
+    tsearch_postinglist_ptr empty = tsearch_postinglist_init_with_ints(NULL, NULL, 0, true);
+    tsearch_postinglist_ptr list = tsearch_postinglist_init_with_ints(integers, NULL, 3, false);
+
+    tsearch_postinglist_ptr results = tsearch_postinglist_copy_union(empty, list);
+    XCTAssertEqual(3, tsearch_postinglist_get_count(results));
+    XCTAssertTrue(tsearch_postinglist_is_compressed(results));
+    tsearch_postinglist_free(results);
+
+    results = tsearch_postinglist_copy_intersection(list, empty);
+    XCTAssertEqual(0, tsearch_postinglist_get_count(results));
+    tsearch_postinglist_free(results);
+
+    results = tsearch_postinglist_copy_minus(list, empty);
+    XCTAssertEqual(3, tsearch_postinglist_get_count(results));
+    tsearch_postinglist_free(results);
+
+    XCTAssertTrue(NULL == tsearch_postinglist_copy_union(list, NULL));
+
+    tsearch_postinglist_free(empty);
+    tsearch_postinglist_free(list);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Performance
+// ------------------------------------------------------------------------------------------
+- (void)testPerformance_ContainsInCompressedList
+{
+    GNEInteger *integers = calloc(100000, sizeof(GNEInteger));
+    for (size_t i = 0; i < 100000; i++) { integers[i] = (GNEInteger)(i * 7); }
+    tsearch_postinglist_ptr list = tsearch_postinglist_init_with_ints(integers, NULL, 100000, true);
+
+    [self measureBlock:^{
+        for (GNEInteger integer = 0; integer < 100000; integer++) {
+            tsearch_postinglist_contains_int(list, integer * 3);
+        }
+    }];
+
+    tsearch_postinglist_free(list);
+    free(integers);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Helpers
+// ------------------------------------------------------------------------------------------
+- (void)p_assertPostingList:(tsearch_postinglist_ptr)list isEqualToCountedSet:(tsearch_countedset_ptr)set
+{
+    XCTAssertEqual(tsearch_countedset_get_count(set), tsearch_postinglist_get_count(list));
+
+    GNEInteger *integers = NULL;
+    size_t count = 0;
+    XCTAssertEqual(success, tsearch_countedset_copy_ints(set, &integers, &count));
+    for (size_t i = 0; i < count; i++) {
+        XCTAssertEqual(tsearch_countedset_get_count_for_int(set, integers[i]),
+                       tsearch_postinglist_get_count_for_int(list, integers[i]));
+    }
+    free(integers);
+
+    tsearch_countedset_ptr copy = tsearch_postinglist_copy_countedset(list);
+    XCTAssertEqual(tsearch_countedset_get_count(set), tsearch_countedset_get_count(copy));
+    tsearch_countedset_free(copy);
+}
+
+
+- (NSArray *)p_randomNumberArrayWithCount:(size_t)count
+{
+    NSMutableArray *mutableArray = [NSMutableArray array];
+    for (size_t i = 0; i < count; i++)
+    {
+        u_int32_t integer = arc4random_uniform((u_int32_t)count);
+        [mutableArray addObject:@(integer)];
+    }
+
+    return [mutableArray copy];
+}
+
+
+@end
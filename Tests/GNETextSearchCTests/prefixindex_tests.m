@@ -0,0 +1,149 @@
+//
+//  prefixindex_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "PrefixIndex.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNEPrefixIndexTests : XCTestCase
+{
+    _tsearch_prefixindex *_index;
+}
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNEPrefixIndexTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Up / Tear Down
+// ------------------------------------------------------------------------------------------
+- (void)setUp
+{
+    [super setUp];
+    _index = _tsearch_prefixindex_init(0);
+}
+
+
+- (void)tearDown
+{
+    _tsearch_prefixindex_free(_index);
+    _index = NULL;
+    [super tearDown];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Tests
+// ------------------------------------------------------------------------------------------
+- (void)testInit_Empty
+{
+    int value = 0;
+    XCTAssertTrue(_index != NULL);
+    XCTAssertEqual(0, _tsearch_prefixindex_get_count(_index));
+    XCTAssertTrue(_tsearch_prefixindex_get_byte_length(_index) > 0);
+    XCTAssertTrue(_tsearch_prefixindex_get(_index, &value) == NULL);
+
+    _tsearch_prefixindex_add_int(_index, &value, 1, 1);
+    _tsearch_prefixindex_remove(_index, &value);
+    XCTAssertEqual(0, _tsearch_prefixindex_get_count(_index));
+}
+
+
+- (void)testInsertAndAdd_TwoNodes_EachNodeKeepsItsOwnDocumentIDs
+{
+    int values[2] = {0};
+    size_t emptyByteLength = _tsearch_prefixindex_get_byte_length(_index);
+    XCTAssertEqual(success, _tsearch_prefixindex_insert(_index, &values[0], tsearch_countedset_init()));
+    XCTAssertEqual(success, _tsearch_prefixindex_insert(_index, &values[1], tsearch_countedset_init()));
+    XCTAssertEqual(failure, _tsearch_prefixindex_insert(_index, &values[1], NULL));
+    XCTAssertEqual(2, _tsearch_prefixindex_get_count(_index));
+
+    for (GNEInteger documentID = 0; documentID < 100; documentID++) {
+        _tsearch_prefixindex_add_int(_index, &values[0], documentID, 2);
+    }
+    _tsearch_prefixindex_add_int(_index, &values[1], 7, 1);
+    _tsearch_prefixindex_remove_int(_index, &values[0], 50);
+
+    tsearch_countedset_ptr documentIDs = _tsearch_prefixindex_get(_index, &values[0]);
+    XCTAssertEqual(99, tsearch_countedset_get_count(documentIDs));
+    XCTAssertEqual(2, tsearch_countedset_get_count_for_int(documentIDs, 7));
+    XCTAssertEqual(1, tsearch_countedset_get_count(_tsearch_prefixindex_get(_index, &values[1])));
+    size_t byteLength = tsearch_countedset_get_byte_length(documentIDs) +
+                        tsearch_countedset_get_byte_length(_tsearch_prefixindex_get(_index, &values[1]));
+    XCTAssertEqual(emptyByteLength + byteLength, _tsearch_prefixindex_get_byte_length(_index));
+
+    _tsearch_prefixindex_remove(_index, &values[0]);
+    XCTAssertTrue(_tsearch_prefixindex_get(_index, &values[0]) == NULL);
+    XCTAssertEqual(1, _tsearch_prefixindex_get_count(_index));
+}
+
+
+- (void)testByteLimit_GrowingPastLimit_NodeRemoved
+{
+    _tsearch_prefixindex *index = _tsearch_prefixindex_init(4096);
+    int values[2] = {0};
+    XCTAssertEqual(success, _tsearch_prefixindex_insert(index, &values[0], tsearch_countedset_init()));
+    XCTAssertEqual(1, _tsearch_prefixindex_get_count(index));
+
+    for (GNEInteger documentID = 0; documentID < 1000; documentID++) {
+        _tsearch_prefixindex_add_int(index, &values[0], documentID, 1);
+    }
+    XCTAssertTrue(_tsearch_prefixindex_get(index, &values[0]) == NULL);
+    XCTAssertEqual(0, _tsearch_prefixindex_get_count(index));
+    XCTAssertTrue(_tsearch_prefixindex_get_byte_length(index) <= 4096);
+
+    GNEInteger integers[1000];
+    for (GNEInteger i = 0; i < 1000; i++) { integers[i] = i; }
+    XCTAssertEqual(success, _tsearch_prefixindex_insert(index, &values[1], tsearch_countedset_init_with_ints(integers, 1000)));
+    XCTAssertEqual(0, _tsearch_prefixindex_get_count(index));
+    _tsearch_prefixindex_free(index);
+}
+
+
+- (void)testRemoveIntsInSet_ManyNodes_DocumentIDsRemovedFromEveryNode
+{
+    const size_t nodeCount = 1000;
+    char *nodes = calloc(nodeCount, sizeof(char));
+    for (size_t i = 0; i < nodeCount; i++) {
+        tsearch_countedset_ptr documentIDs = tsearch_countedset_init();
+        tsearch_countedset_add_int(documentIDs, (GNEInteger)(i % 10));
+        tsearch_countedset_add_int(documentIDs, 100);
+        XCTAssertEqual(success, _tsearch_prefixindex_insert(_index, &nodes[i], documentIDs));
+    }
+
+    tsearch_countedset_ptr removedIDs = tsearch_countedset_init();
+    tsearch_countedset_add_int(removedIDs, 100);
+    tsearch_countedset_add_int(removedIDs, 3);
+    _tsearch_prefixindex_remove_ints_in_set(_index, removedIDs);
+    tsearch_countedset_free(removedIDs);
+
+    XCTAssertEqual(nodeCount, _tsearch_prefixindex_get_count(_index));
+    for (size_t i = 0; i < nodeCount; i++) {
+        tsearch_countedset_ptr documentIDs = _tsearch_prefixindex_get(_index, &nodes[i]);
+        XCTAssertEqual((i % 10 == 3) ? 0 : 1, tsearch_countedset_get_count(documentIDs));
+        XCTAssertFalse(tsearch_countedset_contains_int(documentIDs, 100));
+    }
+
+    // Removing every other node shifts the slots of colliding nodes.
+    for (size_t i = 0; i < nodeCount; i += 2) { _tsearch_prefixindex_remove(_index, &nodes[i]); }
+    for (size_t i = 0; i < nodeCount; i++) {
+        XCTAssertEqual(i % 2 == 1, _tsearch_prefixindex_get(_index, &nodes[i]) != NULL);
+    }
+    free(nodes);
+}
+
+
+@end
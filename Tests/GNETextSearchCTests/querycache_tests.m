@@ -0,0 +1,152 @@
+//
+//  querycache_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "QueryCache.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNEQueryCacheTests : XCTestCase
+{
+    _tsearch_querycache *_cache;
+}
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNEQueryCacheTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Up / Tear Down
+// ------------------------------------------------------------------------------------------
+- (void)setUp
+{
+    [super setUp];
+    _cache = _tsearch_querycache_init(1 << 20);
+}
+
+
+- (void)tearDown
+{
+    _tsearch_querycache_free(_cache);
+    _cache = NULL;
+    [super tearDown];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Tests
+// ------------------------------------------------------------------------------------------
+- (void)testInit_Empty
+{
+    tsearch_countedset_ptr results = NULL;
+    XCTAssertTrue(_cache != NULL);
+    XCTAssertEqual(0, _tsearch_querycache_get_count(_cache));
+    XCTAssertTrue(_tsearch_querycache_get_byte_length(_cache) > 0);
+    XCTAssertFalse(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_prefix, "a", 1, &results));
+    XCTAssertTrue(results == NULL);
+    XCTAssertEqual(0, _tsearch_querycache_get_hit_count(_cache));
+    XCTAssertEqual(1, _tsearch_querycache_get_miss_count(_cache));
+}
+
+
+- (void)testInsertAndCopy_SameBytesDifferentKinds_EachKindKeepsItsOwnResults
+{
+    GNEInteger integers[] = {3, 1, 2};
+    tsearch_countedset_ptr results = tsearch_countedset_init_with_ints(integers, 3);
+    XCTAssertEqual(success, _tsearch_querycache_insert(_cache, _tsearch_querycache_kind_partial, "abc", 3, results));
+    XCTAssertEqual(success, _tsearch_querycache_insert(_cache, _tsearch_querycache_kind_suffix, "abc", 3, NULL));
+    XCTAssertEqual(success, _tsearch_querycache_insert(_cache, _tsearch_querycache_kind_suffix, "abc", 3, results));
+    XCTAssertEqual(2, _tsearch_querycache_get_count(_cache));
+    tsearch_countedset_free(results);
+
+    tsearch_countedset_ptr copy = NULL;
+    XCTAssertTrue(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_partial, "abc", 3, &copy));
+    XCTAssertEqual(3, tsearch_countedset_get_count(copy));
+    XCTAssertTrue(tsearch_countedset_contains_int(copy, 2));
+    tsearch_countedset_free(copy);
+
+    XCTAssertTrue(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_suffix, "abc", 3, &copy));
+    XCTAssertTrue(copy == NULL);
+    XCTAssertFalse(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_partial, "ab", 2, &copy));
+    XCTAssertFalse(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_prefix, "abc", 3, &copy));
+    XCTAssertEqual(2, _tsearch_querycache_get_hit_count(_cache));
+    XCTAssertEqual(2, _tsearch_querycache_get_miss_count(_cache));
+}
+
+
+- (void)testInsert_PastByteLimit_LeastRecentlyUsedSearchesEvicted
+{
+    _tsearch_querycache *cache = _tsearch_querycache_init(4096);
+    GNEInteger integers[] = {1, 2, 3, 4};
+    tsearch_countedset_ptr results = tsearch_countedset_init_with_ints(integers, 4);
+    XCTAssertEqual(success, _tsearch_querycache_insert(cache, _tsearch_querycache_kind_prefix, "first", 5, results));
+
+    tsearch_countedset_ptr copy = NULL;
+    for (NSUInteger i = 0; i < 500; i++) {
+        const char *key = [NSString stringWithFormat:@"key%lu", (unsigned long)i].UTF8String;
+        XCTAssertEqual(success, _tsearch_querycache_insert(cache, _tsearch_querycache_kind_prefix, key, strlen(key), results));
+        XCTAssertTrue(_tsearch_querycache_get_byte_length(cache) <= 4096);
+
+        // Using the first search keeps it from being the least recently used.
+        XCTAssertTrue(_tsearch_querycache_copy(cache, _tsearch_querycache_kind_prefix, "first", 5, &copy));
+        tsearch_countedset_free(copy);
+    }
+
+    XCTAssertTrue(_tsearch_querycache_get_eviction_count(cache) > 0);
+    XCTAssertEqual(500 + 1, _tsearch_querycache_get_count(cache) + _tsearch_querycache_get_eviction_count(cache));
+    XCTAssertFalse(_tsearch_querycache_copy(cache, _tsearch_querycache_kind_prefix, "key0", 4, &copy));
+    XCTAssertTrue(_tsearch_querycache_copy(cache, _tsearch_querycache_kind_prefix, "key499", 6, &copy));
+    tsearch_countedset_free(copy);
+
+    GNEInteger manyIntegers[1000];
+    for (GNEInteger i = 0; i < 1000; i++) { manyIntegers[i] = i; }
+    tsearch_countedset_ptr largeResults = tsearch_countedset_init_with_ints(manyIntegers, 1000);
+    size_t count = _tsearch_querycache_get_count(cache);
+    XCTAssertEqual(success, _tsearch_querycache_insert(cache, _tsearch_querycache_kind_prefix, "large", 5, largeResults));
+    XCTAssertFalse(_tsearch_querycache_copy(cache, _tsearch_querycache_kind_prefix, "large", 5, &copy));
+    XCTAssertEqual(count, _tsearch_querycache_get_count(cache));
+
+    tsearch_countedset_free(largeResults);
+    tsearch_countedset_free(results);
+    _tsearch_querycache_free(cache);
+}
+
+
+- (void)testRemoveAll_ManySearches_CacheEmptyAndCountersKept
+{
+    size_t emptyByteLength = _tsearch_querycache_get_byte_length(_cache);
+    for (NSUInteger i = 0; i < 1000; i++) {
+        const char *key = [NSString stringWithFormat:@"%lu", (unsigned long)i].UTF8String;
+        XCTAssertEqual(success, _tsearch_querycache_insert(_cache, _tsearch_querycache_kind_partial, key, strlen(key), NULL));
+    }
+    XCTAssertEqual(1000, _tsearch_querycache_get_count(_cache));
+
+    tsearch_countedset_ptr copy = NULL;
+    XCTAssertTrue(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_partial, "999", 3, &copy));
+    _tsearch_querycache_remove_all(_cache);
+    XCTAssertEqual(0, _tsearch_querycache_get_count(_cache));
+    XCTAssertFalse(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_partial, "999", 3, &copy));
+    XCTAssertEqual(1, _tsearch_querycache_get_hit_count(_cache));
+    XCTAssertEqual(1, _tsearch_querycache_get_miss_count(_cache));
+    XCTAssertEqual(0, _tsearch_querycache_get_eviction_count(_cache));
+
+    // The table keeps the capacity it grew to, so only its entries' bytes are released.
+    XCTAssertTrue(_tsearch_querycache_get_byte_length(_cache) > emptyByteLength);
+    XCTAssertEqual(success, _tsearch_querycache_insert(_cache, _tsearch_querycache_kind_partial, "999", 3, NULL));
+    XCTAssertTrue(_tsearch_querycache_copy(_cache, _tsearch_querycache_kind_partial, "999", 3, &copy));
+}
+
+
+@end
@@ -205,6 +205,36 @@
 }
 
 
+- (void)testGetSearchResults_TwoDocuments_BorrowedSetFollowsTree
+{
+    tsearch_ternarytree_insert(_treePtr, "alpha", 1);
+    tsearch_ternarytree_insert(_treePtr, "alpha", 2);
+    tsearch_ternarytree_insert(_treePtr, "beta", 2);
+
+    XCTAssertEqual(NULL, tsearch_ternarytree_get_search_results(_treePtr, NULL));
+    XCTAssertEqual(NULL, tsearch_ternarytree_get_search_results(_treePtr, ""));
+    XCTAssertEqual(NULL, tsearch_ternarytree_get_search_results(_treePtr, "alph"));
+
+    tsearch_countedset_ptr results = tsearch_ternarytree_get_search_results(_treePtr, "alpha");
+    XCTAssertEqual(results, tsearch_ternarytree_get_search_results(_treePtr, "alpha"));
+    XCTAssertEqual(2, tsearch_countedset_get_count(results));
+
+    tsearch_countedset_ptr copy = tsearch_ternarytree_copy_search_results(_treePtr, "alpha");
+    XCTAssertTrue(copy != results);
+    XCTAssertEqual(tsearch_countedset_get_count(results), tsearch_countedset_get_count(copy));
+    XCTAssertTrue(tsearch_countedset_contains_int(copy, 1));
+    XCTAssertTrue(tsearch_countedset_contains_int(copy, 2));
+    tsearch_countedset_free(copy);
+    XCTAssertEqual(2, tsearch_countedset_get_count(results));
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 2));
+    results = tsearch_ternarytree_get_search_results(_treePtr, "alpha");
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    XCTAssertTrue(tsearch_countedset_contains_int(results, 1));
+    XCTAssertEqual(NULL, tsearch_ternarytree_get_search_results(_treePtr, "beta"));
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Prefix Search Tests
 // ------------------------------------------------------------------------------------------
@@ -743,6 +773,680 @@
 }
 
 
+- (void)testRemoveMany_RemoveTwoOfThreeDocuments_OnlyThirdDocumentRemains
+{
+    [self insertWords:@[@"man", @"mango", @"ma"] documentID:1 intoTree:_treePtr];
+    [self insertWords:@[@"mangle", @"m", @"mango"] documentID:2 intoTree:_treePtr];
+    [self insertWords:@[@"man", @"apple"] documentID:3 intoTree:_treePtr];
+    tsearch_ternarytree_insert(_treePtr, "man", 1);
+
+    GNEInteger documentIDs[] = { 2, 1, 2, 4 };
+    XCTAssertEqual(success, tsearch_ternarytree_remove_many(_treePtr, documentIDs, 4));
+    [self assertCanFindWords:@[@"man", @"apple"] documentID:3 inTree:_treePtr];
+    [self assertResultsInTree:_treePtr equalWords:@[@"man", @"apple"]];
+
+    tsearch_countedset_ptr results = tsearch_ternarytree_copy_search_results(_treePtr, "man");
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+}
+
+
+- (void)testRemoveMany_WithDocumentIndex_OnlyThirdDocumentRemains
+{
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(_treePtr));
+    [self insertWords:@[@"man", @"mango", @"ma"] documentID:1 intoTree:_treePtr];
+    [self insertWords:@[@"mangle", @"m", @"mango"] documentID:2 intoTree:_treePtr];
+    [self insertWords:@[@"man", @"apple"] documentID:3 intoTree:_treePtr];
+
+    GNEInteger documentIDs[] = { 1, 2 };
+    XCTAssertEqual(success, tsearch_ternarytree_remove_many(_treePtr, documentIDs, 2));
+    [self assertResultsInTree:_treePtr equalWords:@[@"man", @"apple"]];
+}
+
+
+- (void)testRemoveMany_NullAndEmptyDocumentIDs
+{
+    [self insertWords:@[@"word"] documentID:1 intoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_remove_many(NULL, NULL, 1));
+    XCTAssertEqual(success, tsearch_ternarytree_remove_many(_treePtr, NULL, 0));
+    XCTAssertEqual(failure, tsearch_ternarytree_remove_many(_treePtr, NULL, 1));
+    [self assertCanFindWords:@[@"word"] documentID:1 inTree:_treePtr];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Document Index Tests
+// ------------------------------------------------------------------------------------------
+- (void)testDocumentIndex_RemoveOneOfThreeDocuments_OtherDocumentsRemain
+{
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(_treePtr));
+    [self insertWords:@[@"man", @"mango", @"ma"] documentID:1 intoTree:_treePtr];
+    [self insertWords:@[@"mangle", @"m", @"apple", @"mango"] documentID:2 intoTree:_treePtr];
+    [self insertWords:@[@"man", @"ma"] documentID:3 intoTree:_treePtr];
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 1));
+    [self assertResultsInTree:_treePtr equalWords:@[@"man", @"mango", @"ma", @"mangle", @"m", @"apple"]];
+    tsearch_countedset_ptr results = tsearch_ternarytree_copy_search_results(_treePtr, "mango");
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    XCTAssertTrue(tsearch_countedset_contains_int(results, 2));
+    tsearch_countedset_free(results);
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 3));
+    [self assertResultsInTree:_treePtr equalWords:@[@"mango", @"mangle", @"m", @"apple"]];
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_search_results(_treePtr, "man"));
+}
+
+
+- (void)testDocumentIndex_EnabledAfterInserting_IndexesExistingWords
+{
+    NSArray *words = [self wordsBeginningWithLMN];
+    [self insertWords:words documentID:1 intoTree:_treePtr];
+    [self insertWords:@[@"after", @"enabling"] documentID:2 intoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(_treePtr));
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(_treePtr));
+    [self insertWords:@[@"later", @"words"] documentID:1 intoTree:_treePtr];
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 1));
+    [self assertResultsInTree:_treePtr equalWords:@[@"after", @"enabling"]];
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 2));
+    XCTAssertEqual(0, [self resultsInTree:_treePtr].count);
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 2));
+}
+
+
+- (void)testDocumentIndex_InsertDocumentAndRemoveAllDocuments_PrunesEveryNode
+{
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(tree));
+
+    NSDictionary *bible = [self bibleDictionary];
+    NSArray *documentIDs = [bible.allKeys subarrayWithRange:NSMakeRange(0, MIN((NSUInteger)500, bible.count))];
+    for (NSNumber *documentID in documentIDs) {
+        NSString *text = [bible[documentID] componentsJoinedByString:@" "];
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(tree, text.UTF8String, documentID.longLongValue));
+    }
+
+    for (NSNumber *documentID in documentIDs) {
+        XCTAssertEqual(success, tsearch_ternarytree_remove(tree, documentID.longLongValue));
+    }
+
+    XCTAssertEqual(0, [self resultsInTree:tree].count);
+    tsearch_frozentree_ptr frozen = tsearch_ternarytree_freeze(tree);
+    XCTAssertEqual(0, tsearch_frozentree_get_node_count(frozen));
+    tsearch_frozentree_free(frozen);
+    tsearch_ternarytree_free(tree);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Prefix Index Tests
+// ------------------------------------------------------------------------------------------
+- (void)testPrefixIndex_InsertAndRemoveAroundEnabling_IndexedResultsEqualMergedResults
+{
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init();
+    NSArray *words = [self wordsBeginningWithLMN];
+    for (NSUInteger i = 0; i < words.count; i++) {
+        const char *word = [words[i] UTF8String];
+        tsearch_ternarytree_insert(_treePtr, word, (GNEInteger)(i % 7));
+        tsearch_ternarytree_insert(tree, word, (GNEInteger)(i % 7));
+        if (i == words.count / 2) { XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 3, 0)); }
+    }
+    [self insertWords:@[@"new", @"prefixes", @"qua"] documentID:8 intoTree:_treePtr];
+    [self insertWords:@[@"new", @"prefixes", @"qua"] documentID:8 intoTree:tree];
+    [self assertPrefixSearchResultsForWords:words inTree:_treePtr equalResultsInTree:tree];
+
+    GNEInteger documentIDs[] = {2, 5, 8};
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 3));
+    XCTAssertEqual(success, tsearch_ternarytree_remove_many(_treePtr, documentIDs, 3));
+    XCTAssertEqual(success, tsearch_ternarytree_remove(tree, 3));
+    XCTAssertEqual(success, tsearch_ternarytree_remove_many(tree, documentIDs, 3));
+    [self assertPrefixSearchResultsForWords:words inTree:_treePtr equalResultsInTree:tree];
+    XCTAssertTrue(NULL == tsearch_ternarytree_get_prefix_search_results(_treePtr, "qu"));
+
+    tsearch_ternarytree_prefix_index_stats stats;
+    XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+    XCTAssertTrue(stats.prefixCount > 0);
+    XCTAssertEqual(0, stats.missCount);
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testPrefixIndex_WithDocumentIndex_RemovedDocumentsLeaveIndexedPrefixes
+{
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(_treePtr));
+    XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 2, 0));
+    [self insertWords:@[@"man", @"mango", @"ma"] documentID:1 intoTree:_treePtr];
+    [self insertWords:@[@"mangle", @"m", @"apple", @"mango"] documentID:2 intoTree:_treePtr];
+
+    tsearch_countedset_ptr results = tsearch_ternarytree_get_prefix_search_results(_treePtr, "ma");
+    XCTAssertEqual(2, tsearch_countedset_get_count(results));
+    XCTAssertEqual(3, tsearch_countedset_get_count_for_int(results, 1));
+    XCTAssertEqual(2, tsearch_countedset_get_count_for_int(results, 2));
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 2));
+    results = tsearch_ternarytree_get_prefix_search_results(_treePtr, "m");
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    XCTAssertTrue(tsearch_countedset_contains_int(results, 1));
+    XCTAssertTrue(NULL == tsearch_ternarytree_get_prefix_search_results(_treePtr, "a"));
+    XCTAssertTrue(NULL == tsearch_ternarytree_get_prefix_search_results(_treePtr, "man"));
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 1));
+    tsearch_ternarytree_prefix_index_stats stats;
+    XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+    XCTAssertEqual(0, stats.prefixCount);
+}
+
+
+- (void)testPrefixIndex_ByteLimit_IndexStaysWithinLimitAndSearchesFindEveryWord
+{
+    NSArray *words = [self wordsBeginningWithLMN];
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init();
+    [self insertWords:words intoTree:_treePtr];
+    [self insertWords:words intoTree:tree];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 3, 0));
+
+    tsearch_ternarytree_prefix_index_stats stats;
+    XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+    size_t maxByteLength = stats.byteLength / 4;
+    size_t prefixCount = stats.prefixCount;
+
+    XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 3, maxByteLength));
+    XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+    XCTAssertTrue(stats.prefixCount > 0 && stats.prefixCount < prefixCount);
+    XCTAssertTrue(stats.byteLength <= maxByteLength);
+
+    [self insertWords:@[@"more", @"words", @"make", @"many", @"more", @"prefixes"] documentID:1 intoTree:_treePtr];
+    [self insertWords:@[@"more", @"words", @"make", @"many", @"more", @"prefixes"] documentID:1 intoTree:tree];
+    XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+    XCTAssertTrue(stats.byteLength <= maxByteLength);
+    [self assertPrefixSearchResultsForWords:words inTree:_treePtr equalResultsInTree:tree];
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testPrefixIndex_Stats_CountsHitsAndMissesUntilDisabled
+{
+    tsearch_ternarytree_prefix_index_stats stats;
+    XCTAssertEqual(failure, tsearch_ternarytree_get_prefix_index_stats(_treePtr, NULL));
+    XCTAssertEqual(failure, tsearch_ternarytree_enable_prefix_index(NULL, 2, 0));
+
+    [self insertWords:@[@"man", @"mango", @"apple"] documentID:1 intoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 2, 0));
+    tsearch_countedset_ptr results = tsearch_ternarytree_copy_prefix_search_results(_treePtr, "m");
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+    XCTAssertTrue(NULL != tsearch_ternarytree_get_prefix_search_results(_treePtr, "ap"));
+    XCTAssertTrue(NULL == tsearch_ternarytree_get_prefix_search_results(_treePtr, "man"));
+    XCTAssertTrue(NULL == tsearch_ternarytree_get_prefix_search_results(_treePtr, "b"));
+
+    XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+    XCTAssertEqual(4, stats.prefixCount);
+    XCTAssertTrue(stats.byteLength > 0);
+    XCTAssertEqual(2, stats.hitCount);
+    XCTAssertEqual(0, stats.missCount);
+
+    XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 0, 0));
+    XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+    XCTAssertEqual(0, stats.prefixCount);
+    XCTAssertEqual(0, stats.byteLength);
+    XCTAssertEqual(0, stats.hitCount);
+    XCTAssertTrue(NULL == tsearch_ternarytree_get_prefix_search_results(_treePtr, "m"));
+    [self assertResultsInTree:_treePtr matchingPrefix:@"m" equalWords:@[@"man", @"mango"]];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Suffix Index Tests
+// ------------------------------------------------------------------------------------------
+- (void)testSuffixIndex_InsertAroundEnabling_ResultsEqualTraversedResults
+{
+    NSArray *words = [self wordsBeginningWithLMN];
+    for (NSUInteger i = 0; i < words.count; i++)
+    {
+        XCTAssertTrue(NULL != tsearch_ternarytree_insert(_treePtr, [words[i] UTF8String], (GNEInteger)[words[i] hash]));
+        if (i == words.count / 2) { XCTAssertEqual(success, tsearch_ternarytree_enable_suffix_index(_treePtr)); }
+    }
+    XCTAssertEqual(success, tsearch_ternarytree_enable_suffix_index(_treePtr));
+
+    for (NSString *suffix in @[@"s", @"est", @"ness", @"ing", @"lawmaker", @"xlawmaker", @"q"])
+    {
+        [self assertResultsInTree:_treePtr matchingSuffix:suffix
+                       equalWords:[self wordsInArray:words withSuffix:suffix]];
+    }
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_suffix_search_results(_treePtr, "s\0", 2));
+}
+
+
+- (void)testSuffixIndex_RemoveWithAndWithoutDocumentIndex_RemovedDocumentsNotFound
+{
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+    XCTAssertEqual(success, tsearch_ternarytree_enable_suffix_index(_treePtr));
+    XCTAssertEqual(success, tsearch_ternarytree_enable_suffix_index(tree));
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(tree));
+
+    for (NSUInteger i = 0; i < 2; i++)
+    {
+        tsearch_ternarytree_ptr ptr = (i == 0) ? _treePtr : tree;
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(ptr, "Singing and ringing the bell", 1));
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(ptr, "Ringing, ringing", 2));
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(ptr, "Telling", 3));
+
+        tsearch_countedset_ptr results = tsearch_ternarytree_copy_suffix_search_results(ptr, "inging", 6);
+        XCTAssertEqual(2, tsearch_countedset_get_count(results));
+        XCTAssertTrue(tsearch_countedset_contains_int(results, 1));
+        XCTAssertTrue(tsearch_countedset_contains_int(results, 2));
+        tsearch_countedset_free(results);
+
+        XCTAssertEqual(success, tsearch_ternarytree_remove(ptr, 2));
+        results = tsearch_ternarytree_copy_suffix_search_results(ptr, "ing", 3);
+        XCTAssertEqual(2, tsearch_countedset_get_count(results));
+        XCTAssertFalse(tsearch_countedset_contains_int(results, 2));
+        tsearch_countedset_free(results);
+
+        GNEInteger documentIDs[] = {1, 3};
+        XCTAssertEqual(success, tsearch_ternarytree_remove_many(ptr, documentIDs, 2));
+        XCTAssertTrue(NULL == tsearch_ternarytree_copy_suffix_search_results(ptr, "g", 1));
+        XCTAssertTrue(NULL == tsearch_ternarytree_copy_suffix_search_results(ptr, "ll", 2));
+    }
+    tsearch_ternarytree_free(tree);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Trigram Index Tests
+// ------------------------------------------------------------------------------------------
+- (void)testTrigramIndex_InsertAroundEnabling_ResultsEqualTraversedResults
+{
+    NSArray *words = [self wordsBeginningWithLMN];
+    for (NSUInteger i = 0; i < words.count; i++)
+    {
+        XCTAssertTrue(NULL != tsearch_ternarytree_insert(_treePtr, [words[i] UTF8String], (GNEInteger)[words[i] hash]));
+        if (i == words.count / 2) { XCTAssertEqual(success, tsearch_ternarytree_enable_trigram_index(_treePtr)); }
+    }
+    XCTAssertEqual(success, tsearch_ternarytree_enable_trigram_index(_treePtr));
+
+    for (NSString *target in @[@"a", @"ne", @"nes", @"ness", @"ana", @"lawmaker", @"xlawmaker", @"qqq"])
+    {
+        [self assertResultsInTree:_treePtr matchingPartialTarget:target
+                       equalWords:[self wordsInArray:words withPartialMatch:target]];
+    }
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_partial_search_results(_treePtr, "nes\0", 4));
+}
+
+
+- (void)testTrigramIndex_RemoveAndReinsert_ResultsFollowTree
+{
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+    XCTAssertEqual(success, tsearch_ternarytree_enable_trigram_index(_treePtr));
+    XCTAssertEqual(success, tsearch_ternarytree_enable_trigram_index(tree));
+    XCTAssertEqual(success, tsearch_ternarytree_enable_document_index(tree));
+
+    for (NSUInteger i = 0; i < 2; i++)
+    {
+        tsearch_ternarytree_ptr ptr = (i == 0) ? _treePtr : tree;
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(ptr, "Singing and ringing the bell", 1));
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(ptr, "Ringing, ringing", 2));
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(ptr, "Telling", 3));
+
+        tsearch_countedset_ptr results = tsearch_ternarytree_copy_partial_search_results(ptr, "ingi", 4);
+        XCTAssertEqual(2, tsearch_countedset_get_count(results));
+        XCTAssertTrue(tsearch_countedset_contains_int(results, 1));
+        XCTAssertTrue(tsearch_countedset_contains_int(results, 2));
+        tsearch_countedset_free(results);
+
+        XCTAssertEqual(success, tsearch_ternarytree_remove(ptr, 2));
+        results = tsearch_ternarytree_copy_partial_search_results(ptr, "ing", 3);
+        XCTAssertEqual(2, tsearch_countedset_get_count(results));
+        XCTAssertFalse(tsearch_countedset_contains_int(results, 2));
+        tsearch_countedset_free(results);
+
+        GNEInteger documentIDs[] = {1, 3};
+        XCTAssertEqual(success, tsearch_ternarytree_remove_many(ptr, documentIDs, 2));
+        XCTAssertTrue(NULL == tsearch_ternarytree_copy_partial_search_results(ptr, "ing", 3));
+        XCTAssertTrue(NULL == tsearch_ternarytree_copy_partial_search_results(ptr, "ell", 3));
+
+        XCTAssertEqual(success, tsearch_ternarytree_insert_document(ptr, "ringing", 4));
+        results = tsearch_ternarytree_copy_partial_search_results(ptr, "nging", 5);
+        XCTAssertEqual(1, tsearch_countedset_get_count(results));
+        XCTAssertTrue(tsearch_countedset_contains_int(results, 4));
+        tsearch_countedset_free(results);
+    }
+    tsearch_ternarytree_free(tree);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Query Cache Tests
+// ------------------------------------------------------------------------------------------
+- (void)testQueryCache_RepeatedSearches_HitsReturnCopiesOfSameResults
+{
+    NSArray *words = [self wordsBeginningWithLMN];
+    [self insertWords:words intoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_query_cache(_treePtr, 1 << 20));
+
+    for (NSUInteger i = 0; i < 2; i++)
+    {
+        [self assertResultsInTree:_treePtr matchingPrefix:@"ma"
+                       equalWords:[self wordsInArray:words withPrefix:@"ma"]];
+        [self assertResultsInTree:_treePtr matchingPartialTarget:@"nes"
+                       equalWords:[self wordsInArray:words withPartialMatch:@"nes"]];
+        [self assertResultsInTree:_treePtr matchingSubsequenceTarget:@"mtr"
+                       equalWords:[self wordsInArray:words withSubsequenceMatch:@"mtr"]];
+        [self assertResultsInTree:_treePtr matchingSuffix:@"ness"
+                       equalWords:[self wordsInArray:words withSuffix:@"ness"]];
+        [self assertResultsInTree:_treePtr matchingSuffix:@"zzz" equalWords:@[]];
+    }
+
+    tsearch_ternarytree_query_cache_stats stats;
+    XCTAssertEqual(success, tsearch_ternarytree_get_query_cache_stats(_treePtr, &stats));
+    XCTAssertEqual(5, stats.entryCount);
+    XCTAssertEqual(5, stats.hitCount);
+    XCTAssertEqual(5, stats.missCount);
+    XCTAssertEqual(0, stats.evictionCount);
+    XCTAssertTrue(stats.byteLength > 0 && stats.byteLength <= 1 << 20);
+
+    // The same bytes searched for by a different kind of search aren't answered by the cache.
+    [self assertResultsInTree:_treePtr matchingPartialTarget:@"ma"
+                   equalWords:[self wordsInArray:words withPartialMatch:@"ma"]];
+    XCTAssertEqual(success, tsearch_ternarytree_get_query_cache_stats(_treePtr, &stats));
+    XCTAssertEqual(6, stats.missCount);
+}
+
+
+- (void)testQueryCache_InsertAndRemove_CachedResultsAreRemoved
+{
+    XCTAssertEqual(success, tsearch_ternarytree_enable_query_cache(_treePtr, 1 << 16));
+    [self insertWords:@[@"man", @"mango"] documentID:1 intoTree:_treePtr];
+    tsearch_countedset_ptr results = tsearch_ternarytree_copy_prefix_search_results(_treePtr, "man");
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_suffix_search_results(_treePtr, "le", 2));
+
+    tsearch_ternarytree_insert(_treePtr, "mangle", 2);
+    results = tsearch_ternarytree_copy_prefix_search_results(_treePtr, "man");
+    XCTAssertEqual(2, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+    results = tsearch_ternarytree_copy_suffix_search_results(_treePtr, "le", 2);
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+
+    XCTAssertEqual(success, tsearch_ternarytree_insert_document(_treePtr, "Manly candle", 3));
+    results = tsearch_ternarytree_copy_suffix_search_results(_treePtr, "le", 2);
+    XCTAssertEqual(2, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 2));
+    results = tsearch_ternarytree_copy_suffix_search_results(_treePtr, "le", 2);
+    XCTAssertEqual(1, tsearch_countedset_get_count(results));
+    XCTAssertTrue(tsearch_countedset_contains_int(results, 3));
+    tsearch_countedset_free(results);
+
+    GNEInteger documentIDs[] = {1, 3};
+    XCTAssertEqual(success, tsearch_ternarytree_remove_many(_treePtr, documentIDs, 2));
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_prefix_search_results(_treePtr, "man"));
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_suffix_search_results(_treePtr, "le", 2));
+
+    tsearch_ternarytree_query_cache_stats stats;
+    XCTAssertEqual(success, tsearch_ternarytree_get_query_cache_stats(_treePtr, &stats));
+    XCTAssertEqual(0, stats.hitCount);
+    XCTAssertEqual(8, stats.missCount);
+    XCTAssertEqual(2, stats.entryCount);
+}
+
+
+- (void)testQueryCache_ByteLimit_LeastRecentlyUsedSearchesEvicted
+{
+    NSArray *words = [self wordsBeginningWithLMN];
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init();
+    [self insertWords:words intoTree:_treePtr];
+    [self insertWords:words intoTree:tree];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_query_cache(_treePtr, 8192));
+
+    for (NSUInteger i = 0; i < 3; i++)
+    {
+        [self assertPrefixSearchResultsForWords:words inTree:_treePtr equalResultsInTree:tree];
+    }
+
+    tsearch_ternarytree_query_cache_stats stats;
+    XCTAssertEqual(success, tsearch_ternarytree_get_query_cache_stats(_treePtr, &stats));
+    XCTAssertTrue(stats.byteLength <= 8192);
+    XCTAssertTrue(stats.evictionCount > 0);
+    XCTAssertTrue(stats.hitCount > 0);
+
+    XCTAssertEqual(success, tsearch_ternarytree_enable_query_cache(_treePtr, 0));
+    XCTAssertEqual(success, tsearch_ternarytree_get_query_cache_stats(_treePtr, &stats));
+    XCTAssertEqual(0, stats.entryCount);
+    XCTAssertEqual(0, stats.byteLength);
+    XCTAssertEqual(0, stats.hitCount);
+    XCTAssertEqual(failure, tsearch_ternarytree_get_query_cache_stats(_treePtr, NULL));
+    XCTAssertEqual(failure, tsearch_ternarytree_enable_query_cache(NULL, 8192));
+    [self assertPrefixSearchResultsForWords:words inTree:_treePtr equalResultsInTree:tree];
+    tsearch_ternarytree_free(tree);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Node Pool Tests
+// ------------------------------------------------------------------------------------------
+- (void)testNodePool_LMN_CanFindAllWords
+{
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(16);
+    XCTAssertTrue(tree != NULL);
+
+    NSArray *words = [self wordsBeginningWithLMN];
+    NSArray *randomizedWords = [self randomizeWords:words];
+    XCTAssertNoThrow([self insertWords:randomizedWords intoTree:tree]);
+    [self assertCanFindWords:words inTree:tree];
+    [self assertResultsInTree:tree equalWords:words];
+    [self assertResultsInTree:tree matchingPrefix:@"men" equalWords:[self wordsInArray:words withPrefix:@"men"]];
+
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testNodePool_RemoveAllDocumentsAndReinsert_SuccessAndOnlyReinsertedWordsRemain
+{
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+    NSArray *firstWords = @[@"these", @"words", @"will", @"be", @"removed"];
+    NSArray *secondWords = @[@"these", @"words", @"are", @"reinserted"];
+
+    [self insertWords:firstWords documentID:1 intoTree:tree];
+    [self insertWords:firstWords documentID:2 intoTree:tree];
+    XCTAssertEqual(success, tsearch_ternarytree_remove(tree, 1));
+    XCTAssertEqual(success, tsearch_ternarytree_remove(tree, 2));
+    XCTAssertEqual(0, [self resultsInTree:tree].count);
+
+    [self insertWords:secondWords documentID:3 intoTree:tree];
+    [self assertCanFindWords:secondWords documentID:3 inTree:tree];
+    [self assertResultsInTree:tree equalWords:secondWords];
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_search_results(tree, "removed"));
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_prefix_search_results(tree, "wi"));
+
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testRemove_RemoveDocumentSharingPrefixes_OtherWordsRemainSearchable
+{
+    [self insertWords:@[@"man", @"mango", @"ma"] documentID:1 intoTree:_treePtr];
+    [self insertWords:@[@"mangle", @"m", @"apple"] documentID:2 intoTree:_treePtr];
+
+    XCTAssertEqual(success, tsearch_ternarytree_remove(_treePtr, 1));
+    [self assertCanFindWords:@[@"mangle", @"m", @"apple"] documentID:2 inTree:_treePtr];
+    [self assertResultsInTree:_treePtr equalWords:@[@"mangle", @"m", @"apple"]];
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_search_results(_treePtr, "man"));
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_search_results(_treePtr, "ma"));
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Insert Document Tests
+// ------------------------------------------------------------------------------------------
+- (void)testInsertDocument_RepeatedWords_CountsEachOccurrence
+{
+    const char *text = "the cat saw the other cat\nthen the dog";
+    XCTAssertEqual(success, tsearch_ternarytree_insert_document(_treePtr, text, 1));
+
+    [self assertResultsInTree:_treePtr equalWords:@[@"the", @"cat", @"saw", @"other", @"then", @"dog"]];
+    tsearch_countedset_ptr results = tsearch_ternarytree_copy_search_results(_treePtr, "the");
+    XCTAssertEqual(3, tsearch_countedset_get_count_for_int(results, 1));
+    tsearch_countedset_free(results);
+
+    results = tsearch_ternarytree_copy_search_results(_treePtr, "cat");
+    XCTAssertEqual(2, tsearch_countedset_get_count_for_int(results, 1));
+    tsearch_countedset_free(results);
+
+    results = tsearch_ternarytree_copy_prefix_search_results(_treePtr, "th");
+    XCTAssertEqual(4, tsearch_countedset_get_count_for_int(results, 1));
+    tsearch_countedset_free(results);
+}
+
+
+- (void)testInsertDocument_LMN_MatchesInsertingEachWord
+{
+    NSArray *words = [self randomizeWords:[self wordsBeginningWithLMN]];
+    NSString *text = [words componentsJoinedByString:@" "];
+    XCTAssertEqual(success, tsearch_ternarytree_insert_document(_treePtr, text.UTF8String, 7));
+
+    [self assertCanFindWords:words documentID:7 inTree:_treePtr];
+    [self assertResultsInTree:_treePtr equalWords:words];
+    [self assertResultsInTree:_treePtr matchingPrefix:@"men" equalWords:[self wordsInArray:words withPrefix:@"men"]];
+}
+
+
+- (void)testInsertDocument_TwoDocumentsSharingWords_BothDocumentsFound
+{
+    XCTAssertEqual(success, tsearch_ternarytree_insert_document(_treePtr, "Ångström units  ångström", 1));
+    XCTAssertEqual(success, tsearch_ternarytree_insert_document(_treePtr, "units of ångström", 2));
+    tsearch_ternarytree_insert(_treePtr, "units", 3);
+
+    tsearch_countedset_ptr results = tsearch_ternarytree_copy_search_results(_treePtr, "units");
+    XCTAssertEqual(3, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+
+    results = tsearch_ternarytree_copy_search_results(_treePtr, "ångström");
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(results, 1));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(results, 2));
+    tsearch_countedset_free(results);
+    [self assertResultsInTree:_treePtr equalWords:@[@"Ångström", @"ångström", @"units", @"of"]];
+}
+
+
+- (void)testInsertDocument_MalformedUTF8_FailureAndTreeUnchanged
+{
+    XCTAssertEqual(failure, tsearch_ternarytree_insert_document(_treePtr, "valid \xff invalid", 1));
+    XCTAssertEqual(0, [self resultsInTree:_treePtr].count);
+}
+
+
+- (void)testInsertDocument_NullAndEmptyText
+{
+    XCTAssertEqual(failure, tsearch_ternarytree_insert_document(NULL, "text", 1));
+    XCTAssertEqual(failure, tsearch_ternarytree_insert_document(_treePtr, NULL, 1));
+    XCTAssertEqual(success, tsearch_ternarytree_insert_document(_treePtr, "", 1));
+    XCTAssertEqual(success, tsearch_ternarytree_insert_document(_treePtr, " \t\n ", 1));
+    XCTAssertEqual(0, [self resultsInTree:_treePtr].count);
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Bulk Load Tests
+// ------------------------------------------------------------------------------------------
+- (void)testInitWithEntries_LMN_CanFindAllWords
+{
+    NSArray *words = [self randomizeWords:[self wordsBeginningWithLMN]];
+    NSData *entries = [self entriesForWords:words];
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_entries(entries.bytes, words.count);
+    XCTAssertTrue(tree != NULL);
+
+    [self assertCanFindWords:words inTree:tree];
+    [self assertResultsInTree:tree equalWords:words];
+    [self assertResultsInTree:tree matchingPrefix:@"men" equalWords:[self wordsInArray:words withPrefix:@"men"]];
+    [self assertResultsInTree:tree matchingSuffix:@"ing" equalWords:[self wordsInArray:words withSuffix:@"ing"]];
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_search_results(tree, @"magicia".UTF8String));
+
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testInitWithEntries_SortedWords_CanFindAllWords
+{
+    NSArray *words = [[self wordsBeginningWithA] sortedArrayUsingSelector:@selector(compare:)];
+    NSData *entries = [self entriesForWords:words];
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_entries(entries.bytes, words.count);
+
+    [self assertCanFindWords:[self randomizeWords:words] inTree:tree];
+    [self assertResultsInTree:tree equalWords:words];
+
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testInitWithEntries_RepeatedEntries_IncreaseCounts
+{
+    tsearch_ternarytree_entry entries[] = {
+        {"word", 2}, {"other", 1}, {"word", 1}, {"word", 2}, {"wo", 3}, {"word", 2}
+    };
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_entries(entries, 6);
+
+    tsearch_countedset_ptr results = tsearch_ternarytree_copy_search_results(tree, "word");
+    XCTAssertEqual(2, tsearch_countedset_get_count(results));
+    XCTAssertEqual(1, tsearch_countedset_get_count_for_int(results, 1));
+    XCTAssertEqual(3, tsearch_countedset_get_count_for_int(results, 2));
+    tsearch_countedset_free(results);
+
+    results = tsearch_ternarytree_copy_prefix_search_results(tree, "wo");
+    XCTAssertEqual(3, tsearch_countedset_get_count(results));
+    tsearch_countedset_free(results);
+
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testInitWithEntries_NullAndEmptyWords_AreIgnored
+{
+    tsearch_ternarytree_entry entries[] = { {NULL, 1}, {"", 2}, {"word", 3} };
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_entries(entries, 3);
+
+    [self assertResultsInTree:tree equalWords:@[@"word"]];
+    XCTAssertEqual(success, tsearch_ternarytree_remove(tree, 1));
+    [self assertCanFindWords:@[@"word"] documentID:3 inTree:tree];
+
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testInitWithEntries_NoEntries_EmptyTreeAcceptsInserts
+{
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_entries(NULL, 0);
+    XCTAssertTrue(tree != NULL);
+    XCTAssertEqual(0, [self resultsInTree:tree].count);
+
+    [self insertWords:@[@"after", @"bulk", @"loading"] documentID:1 intoTree:tree];
+    [self assertCanFindWords:@[@"after", @"bulk", @"loading"] documentID:1 inTree:tree];
+
+    tsearch_ternarytree_free(tree);
+}
+
+
+- (void)testInitWithEntries_InsertAndRemoveAfterLoading_Success
+{
+    NSArray *words = @[@"man", @"mango", @"ma", @"mangle", @"m", @"apple"];
+    NSData *entries = [self entriesForWords:words];
+    tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_entries(entries.bytes, words.count);
+
+    [self insertWords:@[@"mangrove", @"apply"] documentID:1 intoTree:tree];
+    XCTAssertEqual(success, tsearch_ternarytree_remove(tree, (GNEInteger)[@"mango" hash]));
+    XCTAssertEqual(success, tsearch_ternarytree_remove(tree, (GNEInteger)[@"ma" hash]));
+
+    NSArray *remainingWords = @[@"man", @"mangle", @"m", @"apple", @"mangrove", @"apply"];
+    [self assertResultsInTree:tree equalWords:remainingWords];
+    XCTAssertTrue(NULL == tsearch_ternarytree_copy_search_results(tree, "mango"));
+
+    tsearch_ternarytree_free(tree);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Fuzz Tests
 // ------------------------------------------------------------------------------------------
@@ -795,6 +1499,145 @@
 }
 
 
+- (void)testInsertingBibleWithNodePool
+{
+    NSDictionary *bible = [self bibleDictionary];
+
+    [self measureBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+        [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
+            for (NSString *word in words) {
+                tsearch_ternarytree_insert(tree, word.UTF8String, documentID.longLongValue);
+            }
+        }];
+        tsearch_ternarytree_free(tree);
+    }];
+}
+
+
+- (void)testInsertingBibleDocuments
+{
+    NSDictionary *bible = [self bibleDictionary];
+    NSMutableDictionary *documents = [NSMutableDictionary dictionaryWithCapacity:bible.count];
+    [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
+        documents[documentID] = [words componentsJoinedByString:@" "];
+    }];
+
+    [self measureBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init();
+        [documents enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSString *text, BOOL *stop) {
+            tsearch_ternarytree_insert_document(tree, text.UTF8String, documentID.longLongValue);
+        }];
+        tsearch_ternarytree_free(tree);
+    }];
+}
+
+
+- (void)testBulkLoadingBible
+{
+    NSDictionary *bible = [self bibleDictionary];
+    NSMutableData *entries = [NSMutableData data];
+    [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
+        for (NSString *word in words) {
+            tsearch_ternarytree_entry entry = { word.UTF8String, documentID.longLongValue };
+            [entries appendBytes:&entry length:sizeof(entry)];
+        }
+    }];
+    size_t count = entries.length / sizeof(tsearch_ternarytree_entry);
+
+    [self measureBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_entries(entries.bytes, count);
+        tsearch_ternarytree_free(tree);
+    }];
+}
+
+
+- (void)testFreeingBible
+{
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init();
+        [self insertBibleIntoTree:tree];
+        [self startMeasuring];
+        tsearch_ternarytree_free(tree);
+        [self stopMeasuring];
+    }];
+}
+
+
+- (void)testFreeingBibleWithNodePool
+{
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+        [self insertBibleIntoTree:tree];
+        [self startMeasuring];
+        tsearch_ternarytree_free(tree);
+        [self stopMeasuring];
+    }];
+}
+
+
+- (void)testRemovingFromBible
+{
+    NSArray *documentIDs = [[self bibleDictionary].allKeys subarrayWithRange:NSMakeRange(0, 100)];
+
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+        [self insertBibleIntoTree:tree];
+        [self startMeasuring];
+        for (NSNumber *documentID in documentIDs) {
+            tsearch_ternarytree_remove(tree, documentID.longLongValue);
+        }
+        [self stopMeasuring];
+        tsearch_ternarytree_free(tree);
+    }];
+}
+
+
+- (void)testRemovingManyFromBible
+{
+    NSArray *documentIDs = [[self bibleDictionary].allKeys subarrayWithRange:NSMakeRange(0, 100)];
+    GNEInteger *integers = calloc(documentIDs.count, sizeof(GNEInteger));
+    for (NSUInteger i = 0; i < documentIDs.count; i++) { integers[i] = [documentIDs[i] longLongValue]; }
+
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+        [self insertBibleIntoTree:tree];
+        [self startMeasuring];
+        tsearch_ternarytree_remove_many(tree, integers, documentIDs.count);
+        [self stopMeasuring];
+        tsearch_ternarytree_free(tree);
+    }];
+
+    free(integers);
+}
+
+
+- (void)testRemovingFromBibleWithDocumentIndex
+{
+    NSArray *documentIDs = [[self bibleDictionary].allKeys subarrayWithRange:NSMakeRange(0, 100)];
+
+    [self measureMetrics:[[self class] defaultPerformanceMetrics] automaticallyStartMeasuring:NO forBlock:^()
+    {
+        tsearch_ternarytree_ptr tree = tsearch_ternarytree_init_with_node_pool(0);
+        tsearch_ternarytree_enable_document_index(tree);
+        [self insertBibleIntoTree:tree];
+        [self startMeasuring];
+        for (NSNumber *documentID in documentIDs) {
+            tsearch_ternarytree_remove(tree, documentID.longLongValue);
+        }
+        [self stopMeasuring];
+        tsearch_ternarytree_free(tree);
+    }];
+}
+
+
 - (void)testSearchBible_god__0_000
 {
     [self insertBibleIntoTree:_treePtr];
@@ -825,6 +1668,34 @@
 }
 
 
+- (void)testBorrowedSearchBible_god
+{
+    [self insertBibleIntoTree:_treePtr];
+    __block size_t count = 0;
+    NSString *word = @"god";
+
+    [self measureBlock:^()
+    {
+        count = tsearch_countedset_get_count(tsearch_ternarytree_get_search_results(_treePtr, word.UTF8String));
+    }];
+    XCTAssertEqual([self numberOfVersesInBibleContainingWord:word], count);
+}
+
+
+- (void)testBorrowedSearchBible_the
+{
+    [self insertBibleIntoTree:_treePtr];
+    __block size_t count = 0;
+    NSString *word = @"the";
+
+    [self measureBlock:^()
+    {
+        count = tsearch_countedset_get_count(tsearch_ternarytree_get_search_results(_treePtr, word.UTF8String));
+    }];
+    XCTAssertEqual([self numberOfVersesInBibleContainingWord:word], count);
+}
+
+
 - (void)testPrefixSearchBible_a__0_035
 {
     [self insertBibleIntoTree:_treePtr];
@@ -841,6 +1712,56 @@
 }
 
 
+- (void)testPrefixSearchBibleWithPrefixIndex_a
+{
+    [self insertBibleIntoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 3, 0));
+    __block size_t count = 0;
+    NSString *prefix = @"a";
+
+    [self measureBlock:^()
+    {
+        count = tsearch_countedset_get_count(tsearch_ternarytree_get_prefix_search_results(_treePtr, prefix.UTF8String));
+    }];
+    XCTAssertEqual([self numberOfVersesInBibleContainingPrefix:prefix], count);
+}
+
+
+- (void)testPrefixIndexBible_ReportHitRateAndMemoryForPrefixesOfEveryWord
+{
+    [self insertBibleIntoTree:_treePtr];
+    NSDictionary *bible = [self bibleDictionary];
+
+    // Each word in the Bible is searched for by its first one, two, and three bytes, like someone
+    // typing it into a search field, first with an unlimited index and then with a quarter of its size.
+    size_t maxByteLength = 0;
+    for (NSUInteger pass = 0; pass < 2; pass++) {
+        XCTAssertEqual(success, tsearch_ternarytree_enable_prefix_index(_treePtr, 3, maxByteLength));
+        [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
+            for (NSString *word in words) {
+                const char *characters = word.UTF8String;
+                size_t length = MIN((size_t)3, strlen(characters));
+                for (size_t prefixLength = 1; prefixLength <= length; prefixLength++) {
+                    char prefix[4] = {0};
+                    memcpy(prefix, characters, prefixLength);
+                    (void)tsearch_ternarytree_get_prefix_search_results(_treePtr, prefix);
+                }
+            }
+        }];
+
+        tsearch_ternarytree_prefix_index_stats stats;
+        XCTAssertEqual(success, tsearch_ternarytree_get_prefix_index_stats(_treePtr, &stats));
+        NSLog(@"Bible prefix index (limit %zu bytes): %zu prefixes, %zu bytes, %zu hits, %zu misses (%.1f%% hit rate)",
+              maxByteLength, stats.prefixCount, stats.byteLength, stats.hitCount, stats.missCount,
+              100.0 * (double)stats.hitCount / (double)MAX((size_t)1, stats.hitCount + stats.missCount));
+
+        if (maxByteLength == 0) { XCTAssertEqual(0, stats.missCount); }
+        else { XCTAssertTrue(stats.byteLength <= maxByteLength); }
+        maxByteLength = stats.byteLength / 4;
+    }
+}
+
+
 - (void)testPartialMatchBible_go__007
 {
     [self insertBibleIntoTree:_treePtr];
@@ -858,6 +1779,46 @@
 }
 
 
+- (void)testPartialMatchBibleWithQueryCache_go
+{
+    [self insertBibleIntoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_query_cache(_treePtr, 1 << 24));
+    __block size_t count = 0;
+    NSString *target = @"go";
+    size_t length = [target lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_ptr results = tsearch_ternarytree_copy_partial_search_results(_treePtr, target.UTF8String,
+                                                                                         length);
+        count = tsearch_countedset_get_count(results);
+        tsearch_countedset_free(results);
+    }];
+
+    XCTAssertEqual([self numberOfVersesInBibleContainingTarget:target], count);
+}
+
+
+- (void)testPartialMatchBibleWithTrigramIndex_god
+{
+    [self insertBibleIntoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_trigram_index(_treePtr));
+    __block size_t count = 0;
+    NSString *target = @"god";
+    size_t length = [target lengthOfBytesUsingEncoding:NSUTF8StringEncoding];
+
+    [self measureBlock:^()
+    {
+        tsearch_countedset_ptr results = tsearch_ternarytree_copy_partial_search_results(_treePtr, target.UTF8String,
+                                                                                         length);
+        count = tsearch_countedset_get_count(results);
+        tsearch_countedset_free(results);
+    }];
+
+    XCTAssertEqual([self numberOfVersesInBibleContainingTarget:target], count);
+}
+
+
 - (void)testSuffixSearchBible_t__0_038
 {
     [self insertBibleIntoTree:_treePtr];
@@ -873,9 +1834,55 @@
 }
 
 
+- (void)testSuffixSearchBibleWithSuffixIndex_t
+{
+    [self insertBibleIntoTree:_treePtr];
+    XCTAssertEqual(success, tsearch_ternarytree_enable_suffix_index(_treePtr));
+    __block size_t count = 0;
+    NSString *suffix = @"t";
+
+    [self measureBlock:^(){
+        tsearch_countedset_ptr results = tsearch_ternarytree_copy_suffix_search_results(_treePtr, suffix.UTF8String,
+                                                                                        suffix.length);
+        count = tsearch_countedset_get_count(results);
+        tsearch_countedset_free(results);
+    }];
+
+    XCTAssertEqual([self numberOfVersesInBibleContainingSuffix:suffix], count);
+}
+
+
 // ------------------------------------------------------------------------------------------
 #pragma mark - Helpers
 // ------------------------------------------------------------------------------------------
+- (void)assertPrefixSearchResultsForWords:(NSArray *)words
+                                   inTree:(tsearch_ternarytree_ptr)ptr
+                       equalResultsInTree:(tsearch_ternarytree_ptr)otherPtr
+{
+    for (NSString *word in words)
+    {
+        for (NSUInteger length = 1; length <= MIN((NSUInteger)4, word.length); length++)
+        {
+            const char *prefix = [word substringToIndex:length].UTF8String;
+            tsearch_countedset_ptr resultsPtr = tsearch_ternarytree_copy_prefix_search_results(ptr, prefix);
+            tsearch_countedset_ptr otherResultsPtr = tsearch_ternarytree_copy_prefix_search_results(otherPtr, prefix);
+            XCTAssertEqual(tsearch_countedset_get_count(otherResultsPtr), tsearch_countedset_get_count(resultsPtr));
+
+            tsearch_countedset_iterator iterator;
+            tsearch_countedset_iterator_init(&iterator, otherResultsPtr);
+            GNEInteger integer = 0;
+            size_t count = 0;
+            while (tsearch_countedset_iterator_next(&iterator, &integer, &count))
+            {
+                XCTAssertEqual(count, tsearch_countedset_get_count_for_int(resultsPtr, integer), @"%s", prefix);
+            }
+            tsearch_countedset_free(resultsPtr);
+            tsearch_countedset_free(otherResultsPtr);
+        }
+    }
+}
+
+
 - (void)insertWords:(NSArray *)words intoTree:(tsearch_ternarytree_ptr)treePtr
 {
     if (treePtr == NULL)
@@ -906,6 +1913,19 @@
 }
 
 
+/// The returned entries point into the words' UTF-8 strings, so they mustn't outlive the words.
+- (NSData *)entriesForWords:(NSArray *)words
+{
+    NSMutableData *entries = [NSMutableData dataWithLength:words.count * sizeof(tsearch_ternarytree_entry)];
+    tsearch_ternarytree_entry *bytes = entries.mutableBytes;
+    [words enumerateObjectsUsingBlock:^(NSString *word, NSUInteger index, BOOL *stop) {
+        bytes[index].word = word.UTF8String;
+        bytes[index].documentID = (GNEInteger)word.hash;
+    }];
+    return entries;
+}
+
+
 - (void)assertCanFindWords:(NSArray *)words inTree:(tsearch_ternarytree_ptr)ptr
 {
     for (NSString *word in words)
@@ -1192,7 +2212,7 @@
     NSDictionary *bible = [self bibleDictionary];
     [bible enumerateKeysAndObjectsUsingBlock:^(NSNumber *documentID, NSArray *words, BOOL *stop) {
         for (NSString *word in words) {
-            tsearch_ternarytree_insert(_treePtr, word.UTF8String, documentID.longLongValue);
+            tsearch_ternarytree_insert(treePtr, word.UTF8String, documentID.longLongValue);
         }
     }];
 }
@@ -1372,40 +2392,7 @@
 
 - (NSDictionary *)bibleDictionary
 {
-    static NSDictionary *dictionary = nil;
-
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^{
-        NSString *path = [GNETextSearchTestResourcesBundle() pathForResource:@"bible" ofType:@"archive"];
-        NSParameterAssert(path);
-        NSError *error = nil;
-        NSData *data = [NSData dataWithContentsOfFile:path options:0 error:&error];
-        NSAssert2(error == nil, @"Could not open %@: %@", path, error);
-
-        NSSet *classes = [NSSet setWithObjects:
-                          [NSDictionary class],
-                          [NSArray class],
-                          [NSNumber class],
-                          [NSString class],
-                          nil];
-        if (@available(macOS 10.13, *)) {
-            dictionary = [NSKeyedUnarchiver unarchivedObjectOfClasses:classes
-                                                             fromData:data
-                                                                error:&error];
-        } else {
-            id unarchivedObject = [NSKeyedUnarchiver unarchiveObjectWithData:data];
-            if ([unarchivedObject isKindOfClass:[NSDictionary class]]) {
-                dictionary = (NSDictionary *)unarchivedObject;
-            } else {
-                error = [NSError errorWithDomain:NSCocoaErrorDomain
-                                            code:NSFileReadCorruptFileError
-                                        userInfo:@{ NSLocalizedDescriptionKey : @"Could not unarchive bible archive as NSDictionary" }];
-            }
-        }
-        NSAssert2(error == nil, @"Could not unarchive %@: %@", path, error);
-    });
-
-    return dictionary;
+    return GNETextSearchBibleDictionary();
 }
 
 
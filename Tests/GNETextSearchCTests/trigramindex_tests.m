@@ -0,0 +1,135 @@
+//
+//  trigramindex_tests.m
+//  GNETextSearch
+//
+//  Created by Anthony Drendel on 10/18/26.
+//  Copyright © 2026 Gone East LLC. All rights reserved.
+//
+
+#import <XCTest/XCTest.h>
+#import "TrigramIndex.h"
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@interface GNETrigramIndexTests : XCTestCase
+{
+    _tsearch_trigramindex *_index;
+}
+
+@end
+
+
+// ------------------------------------------------------------------------------------------
+
+
+@implementation GNETrigramIndexTests
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Set Up / Tear Down
+// ------------------------------------------------------------------------------------------
+- (void)setUp
+{
+    [super setUp];
+    _index = _tsearch_trigramindex_init();
+}
+
+
+- (void)tearDown
+{
+    _tsearch_trigramindex_free(_index);
+    _index = NULL;
+    [super tearDown];
+}
+
+
+// ------------------------------------------------------------------------------------------
+#pragma mark - Tests
+// ------------------------------------------------------------------------------------------
+- (void)testInit_Empty
+{
+    int value = 0;
+    uint32_t gram = 1;
+    XCTAssertTrue(_index != NULL);
+    XCTAssertEqual(0, _tsearch_trigramindex_get_count(_index));
+    XCTAssertTrue(_tsearch_trigramindex_get_byte_length(_index) > 0);
+
+    void **nodes = (void **)1;
+    size_t count = 1;
+    XCTAssertEqual(success, _tsearch_trigramindex_copy_nodes_with_grams(_index, &gram, 1, &nodes, &count));
+    XCTAssertTrue(nodes == NULL);
+    XCTAssertEqual(0, count);
+
+    _tsearch_trigramindex_remove(_index, gram, &value);
+    XCTAssertEqual(0, _tsearch_trigramindex_get_count(_index));
+}
+
+
+- (void)testAddAndRemove_NodeAddedTwice_GramKeepsOneCopy
+{
+    int values[2] = {0};
+    size_t emptyByteLength = _tsearch_trigramindex_get_byte_length(_index);
+    XCTAssertEqual(success, _tsearch_trigramindex_add(_index, 7, &values[0]));
+    XCTAssertEqual(success, _tsearch_trigramindex_add(_index, 7, &values[0]));
+    XCTAssertEqual(success, _tsearch_trigramindex_add(_index, 7, &values[1]));
+    XCTAssertEqual(failure, _tsearch_trigramindex_add(_index, 7, NULL));
+    XCTAssertEqual(1, _tsearch_trigramindex_get_count(_index));
+    XCTAssertTrue(_tsearch_trigramindex_get_byte_length(_index) > emptyByteLength);
+
+    uint32_t gram = 7;
+    void **nodes = NULL;
+    size_t count = 0;
+    XCTAssertEqual(success, _tsearch_trigramindex_copy_nodes_with_grams(_index, &gram, 1, &nodes, &count));
+    XCTAssertEqual(2, count);
+    free(nodes);
+
+    _tsearch_trigramindex_remove(_index, 7, &values[0]);
+    _tsearch_trigramindex_remove(_index, 7, &values[0]);
+    XCTAssertEqual(1, _tsearch_trigramindex_get_count(_index));
+    _tsearch_trigramindex_remove(_index, 7, &values[1]);
+    XCTAssertEqual(0, _tsearch_trigramindex_get_count(_index));
+    XCTAssertEqual(emptyByteLength, _tsearch_trigramindex_get_byte_length(_index));
+}
+
+
+- (void)testCopyNodesWithGrams_ManyNodes_NodesWithEveryGramCopied
+{
+    const size_t nodeCount = 1000;
+    char *nodes = calloc(nodeCount, sizeof(char));
+
+    // Gram 0 has every node, gram 2 every second node, gram 3 every third node, and so on.
+    for (size_t i = 0; i < nodeCount; i++) {
+        XCTAssertEqual(success, _tsearch_trigramindex_add(_index, 0, &nodes[i]));
+        for (uint32_t gram = 2; gram < 6; gram++) {
+            if (i % gram == 0) { XCTAssertEqual(success, _tsearch_trigramindex_add(_index, gram, &nodes[i])); }
+        }
+    }
+    XCTAssertEqual(5, _tsearch_trigramindex_get_count(_index));
+
+    uint32_t grams[] = {0, 2, 3, 2};
+    void **matches = NULL;
+    size_t count = 0;
+    XCTAssertEqual(success, _tsearch_trigramindex_copy_nodes_with_grams(_index, grams, 4, &matches, &count));
+    XCTAssertEqual(167, count);
+    for (size_t i = 0; i < count; i++) {
+        XCTAssertEqual(0, ((char *)matches[i] - nodes) % 6);
+    }
+    free(matches);
+
+    uint32_t missingGrams[] = {0, 9};
+    XCTAssertEqual(success, _tsearch_trigramindex_copy_nodes_with_grams(_index, missingGrams, 2, &matches, &count));
+    XCTAssertTrue(matches == NULL);
+    XCTAssertEqual(0, count);
+
+    // Removing every other node from gram 3 leaves it with the nodes divisible by 6.
+    for (size_t i = 0; i < nodeCount; i += 6) { _tsearch_trigramindex_remove(_index, 3, &nodes[i]); }
+    XCTAssertEqual(success, _tsearch_trigramindex_copy_nodes_with_grams(_index, grams, 4, &matches, &count));
+    XCTAssertTrue(matches == NULL);
+    XCTAssertEqual(0, count);
+    free(nodes);
+}
+
+
+@end